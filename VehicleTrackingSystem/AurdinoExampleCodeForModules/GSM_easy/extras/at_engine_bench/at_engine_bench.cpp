@@ -0,0 +1,185 @@
+/*
+at_engine_bench - the main loop of a tracker uploading by HTTP GET, with the blocking sendHTTPGET() and with
+sendHTTPGET() given a handler and poll() in the loop
+
+The other end of the line is the simulated M95 of extras/host/m95_sim.h at 9600 baud, time is simulated
+too (see extras/host/Arduino.h). Each run of the loop does 1 ms of other work, e.g. reading the GPS, and
+starts an upload every 60 seconds. For both ways the bench reports how long the loop was held up at most,
+how often it was held up for more than 64 ms (when the 64 byte receive buffer of a GPS at 9600 baud has
+overflowed), how many uploads succeeded and, for the queued way, how long poll() takes on this host. Both
+ways must send the module the same characters. Then an upload is queued against a module that refuses
+AT+QIOPEN, which must drop the rest of the upload and report the failure once, and a FTP download against one
+that refuses AT+QFTPPATH, which must fail at once the same way. Last, connectGPRS() is queued
+while the module takes 9 seconds to attach to GPRS, followed by a FTP download, each queued by the handler of
+the one before: the loop must not be held up by the retries of AT+CGATT? nor by the wait for the file.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. at_engine_bench.cpp ../../gsm_easy.cpp -o at_engine_bench
+
+and run as
+
+  ./at_engine_bench [minutes]
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <GSM_easy.h>
+#include <m95_sim.h>
+#include <time.h>
+
+static M95Sim modem;
+
+static char server[] = "www.antrax.de";
+static char parameters[] = "GET /WebServices/responder.php?52.520008,13.404954,48.5 HTTP/1.1";
+
+static int uploading, uploaded, failed, calls;
+
+static void Uploaded(int ok)
+{
+  uploading = 0;
+  calls += 1;
+  if(ok) { uploaded += 1; } else { failed += 1; }
+}
+
+// connectGPRS, FTPopen, FTPdownload and FTPclose, each queued by the handler of the one before
+static int step, stepsOk, file;
+
+static void Step(int ok)
+{
+  stepsOk += ok;
+  switch(step++)
+  {
+    case 0: if(!GSM.FTPopen((char *)"ftp.example.com", 21, (char *)"user", (char *)"pass", Step)) { Step(0); } break;
+    case 1: if(!GSM.FTPdownload((char *)"/", (char *)"config.txt", Step)) { Step(0); } break;
+    case 2:
+      file = strstr(GSM.GSM_string, "interval=60") != 0;
+      if(!GSM.FTPclose(Step)) { Step(0); }
+      break;
+  }
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// the tracker's loop() for "minutes", returns what the module got
+static std::string run(bool queued, unsigned long minutes)
+{
+  unsigned long start = millis(), last = start, next = start;
+  unsigned long loops = 0, held = 0, longest = 0, polls = 0;
+  double polling = 0;
+  size_t from = modem.transcript.size();
+
+  uploading = uploaded = failed = 0;
+  while(millis() - start < minutes * 60000UL)
+  {
+    delay(1);                                                                  // the other work of the loop
+
+    if(!uploading && millis() - next < 0x80000000UL)
+    {
+      next += 60000;
+      uploading = 1;
+      if(queued)
+      {
+        if(!GSM.sendHTTPGET(server, parameters, Uploaded)) { Uploaded(0); }
+      }
+      else
+      {
+        Uploaded(GSM.sendHTTPGET(server, parameters));
+      }
+    }
+    if(queued)
+    {
+      double t = seconds();
+      GSM.poll();
+      polling += seconds() - t;
+      polls += 1;
+    }
+
+    unsigned long now = millis();
+    if(now - last > longest) { longest = now - last; }
+    if(now - last > 64) { held += 1; }
+    last = now;
+    loops += 1;
+  }
+  while(GSM.poll()) {}                                                         // let the last upload finish
+
+  printf("%-9s %8lu loops  longest %6lu ms  %4lu over 64 ms  %3d uploads, %d failed", queued ? "queued" : "blocking",
+         loops, longest, held, uploaded, failed);
+  if(queued) { printf("  %.0f ns per poll()", polling / polls * 1e9); }
+  printf("\n");
+  return modem.transcript.substr(from);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long minutes = argc > 1 ? atoi(argv[1]) : 30;
+  int errors = 0;
+
+  GSM.begin();
+  if(!GSM.initialize((char *)"1234") || !GSM.connectGPRS((char *)"internet.t-mobile.de", (char *)"t-mobile", (char *)"tm"))
+  {
+    printf("no connection: %s\n", GSM.GSM_string);
+    return 1;
+  }
+
+  std::string blocking = run(false, minutes);
+  std::string queued = run(true, minutes);
+  if(blocking != queued)
+  {
+    printf("the module got different characters\n");
+    errors += 1;
+  }
+  if(failed) { errors += 1; }
+
+  //----- a refused connection must drop the rest of the upload
+  modem.failOn("AT+QIOPEN");
+  size_t from = modem.transcript.size();
+  calls = failed = 0;
+  GSM.sendHTTPGET(server, parameters, Uploaded);
+  while(GSM.poll()) {}
+  bool dropped = modem.transcript.find("AT+QISEND", from) == std::string::npos;
+  printf("refused AT+QIOPEN: %d handler call(s), %d failed, rest of the upload %s\n", calls, failed,
+         dropped ? "dropped" : "sent");
+  if(calls != 1 || failed != 1 || !dropped) { errors += 1; }
+  modem.failNothing();
+
+  //----- so must a refused path, failed by the handler of AT+QFTPPATH
+  modem.failOn("AT+QFTPPATH");
+  from = modem.transcript.size();
+  calls = failed = 0;
+  unsigned long refusedAt = millis();
+  if(!GSM.FTPdownload((char *)"/", (char *)"config.txt", Uploaded)) { Uploaded(0); }
+  while(GSM.poll()) {}
+  dropped = modem.transcript.find("AT+QFTPGET", from) == std::string::npos;
+  printf("refused AT+QFTPPATH: %d handler call(s), %d failed after %lu ms, rest of the download %s\n", calls, failed,
+         millis() - refusedAt, dropped ? "dropped" : "sent");
+  if(calls != 1 || failed != 1 || !dropped || millis() - refusedAt > 1000) { errors += 1; }
+  modem.failNothing();
+
+  //----- connectGPRS retrying AT+CGATT?, then a FTP download, all queued
+  modem.detach(9000);
+  from = modem.transcript.size();
+  unsigned long start = millis(), last = start, longest = 0;
+  if(!GSM.connectGPRS((char *)"internet.t-mobile.de", (char *)"t-mobile", (char *)"tm", Step)) { Step(0); }
+  while(step < 4 && millis() - start < 300000UL)
+  {
+    delay(1);
+    GSM.poll();
+    if(millis() - last > longest) { longest = millis() - last; }
+    last = millis();
+  }
+  int asked = 0;
+  for(size_t at = modem.transcript.find("AT+CGATT?", from); at != std::string::npos;
+      at = modem.transcript.find("AT+CGATT?", at + 1)) { asked += 1; }
+  printf("queued connectGPRS and FTP download: AT+CGATT? sent %d times, %d of 4 steps ok in %lu ms, file %s, "
+         "loop held up %lu ms at most\n", asked, stepsOk, millis() - start, file ? "received" : "missing", longest);
+  if(stepsOk != 4 || !file || asked < 5 || longest > 64) { errors += 1; }
+
+  printf("%lu characters lost from the receive buffer\n", Serial.charactersLost());
+  return errors != 0;
+}
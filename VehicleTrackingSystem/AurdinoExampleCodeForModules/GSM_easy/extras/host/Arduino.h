@@ -0,0 +1,208 @@
+/*
+Arduino.h - Host stand-in for the parts of the Arduino core GSM_easy uses, so the library and the tools
+in extras/ can be compiled with a desktop compiler:
+
+  g++ -O2 -I<path to GSM_easy>/extras/host -I<path to GSM_easy> ... <path to GSM_easy>/gsm_easy.cpp
+
+Time is simulated: it only moves on with delay(), by a few microseconds with every millis() and while
+Serial.write() waits for room, so runs are repeatable and take far less than their simulated time.
+"Serial" is a 9600 baud line with the 64 byte buffers of the AVR core; what is sent on it goes to the
+HostModem attached with Serial.attach(), which answers with Serial.answer() and sends its unsolicited messages
+with Serial.unsolicited().
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+
+#define ARDUINO 10606
+
+typedef unsigned char byte;
+typedef bool boolean;
+
+#define LOW         0
+#define HIGH        1
+#define INPUT       0
+#define OUTPUT      1
+
+#define SERIAL_BUFFER_SIZE  64
+#define SERIAL_CHAR_US      1042                                               // 10 bits at 9600 baud
+#define MILLIS_US           4                                                  // time a call of millis() takes
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const unsigned char *)(p))
+
+inline void pinMode(byte, byte) {}
+inline void digitalWrite(byte, byte) {}
+
+inline char *itoa(int value, char *s, int radix)
+{
+  char *p = s, *q;
+  unsigned int u = (value < 0 && radix == 10) ? -(unsigned int)value : (unsigned int)value;
+  do { *p++ = "0123456789abcdefghijklmnopqrstuvwxyz"[u % radix]; u /= radix; } while(u);
+  if(value < 0 && radix == 10) { *p++ = '-'; }
+  *p = 0;
+  for(q = s, p -= 1; q < p; q++, p--) { char c = *q; *q = *p; *p = c; }
+  return s;
+}
+
+//------------------------------------------------------------------------------
+// the other end of the line
+class HostModem
+{
+  public:
+    virtual ~HostModem() {}
+    virtual void received(char c) = 0;                                         // a character sent by the sketch has arrived
+};
+
+class HardwareSerial
+{
+  public:
+    HardwareSerial() : now(0), txFreeAt(0), rxFreeAt(0), modem(0), timeout(1000), sent(0), got(0), lost(0) {}
+
+    //----- simulated time
+    unsigned long long micros() { return now; }
+    void advance(unsigned long long us)
+    {
+      unsigned long long until = now + us;
+      for(;;)
+      {
+        bool txDue = !tx.empty() && txFreeAt <= until;
+        bool rxDue = !line.empty() && line.front().at <= until;
+        if(!txDue && !rxDue) { break; }
+        if(txDue && (!rxDue || txFreeAt <= line.front().at))                   // a character has left
+        {
+          now = txFreeAt;
+          char c = tx.front();
+          tx.pop_front();
+          txFreeAt = now + SERIAL_CHAR_US;
+          sent += 1;
+          if(modem) { modem->received(c); }
+        }
+        else                                                                   // a character has come in
+        {
+          now = line.front().at;
+          if(rx.size() < SERIAL_BUFFER_SIZE - 1) { rx.push_back(line.front().c); } else { lost += 1; }
+          got += 1;
+          line.pop_front();
+        }
+      }
+      now = until;
+    }
+
+    //----- the modem side
+    void attach(HostModem *m) { modem = m; }
+    void answer(unsigned long after_ms, const char *text)                     // "text" starts to arrive "after_ms" from now
+    {
+      unsigned long long at = now + after_ms * 1000ULL;
+      if(at < rxFreeAt) { at = rxFreeAt; }
+      for(; *text; text++)
+      {
+        at += SERIAL_CHAR_US;
+        Pending p = { at, *text };
+        line.push_back(p);
+      }
+      rxFreeAt = at;
+    }
+    void unsolicited(const char *text)                                         // "text" comes now, or after the line coming in
+    {
+      unsigned long long length = strlen(text) * SERIAL_CHAR_US;
+      size_t i = 0;
+      if(!line.empty() && line.front().at <= now + length + SERIAL_CHAR_US)   // an answer is on its way, wait for its line end
+      {
+        while(i < line.size() && line[i].c != '\n') { i++; }
+        if(i == line.size()) { answer(0, text); return; }
+        i += 1;
+      }
+      unsigned long long at = i ? line[i - 1].at : now;
+      std::deque<Pending> rest(line.begin() + i, line.end());
+      line.erase(line.begin() + i, line.end());
+      for(; *text; text++)
+      {
+        at += SERIAL_CHAR_US;
+        Pending p = { at, *text };
+        line.push_back(p);
+      }
+      for(size_t k = 0; k < rest.size(); k++)                                  // the rest of the answers comes later
+      {
+        if(i) { rest[k].at += length; }
+        line.push_back(rest[k]);
+      }
+      if(i) { rxFreeAt += length; } else if(rxFreeAt < at) { rxFreeAt = at; }
+    }
+    unsigned long charactersSent() { return sent; }
+    unsigned long charactersReceived() { return got; }
+    unsigned long charactersLost() { return lost; }                            // receive buffer overflows
+
+    //----- the sketch side
+    void begin(unsigned long) {}
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    int  available() { return (int)rx.size(); }
+    int  availableForWrite() { return SERIAL_BUFFER_SIZE - 1 - (int)tx.size(); }
+    int  read()
+    {
+      if(rx.empty()) { return -1; }
+      int c = (byte)rx.front();
+      rx.pop_front();
+      return c;
+    }
+    size_t readBytes(char *buffer, size_t length)
+    {
+      size_t n = 0;
+      while(n < length)
+      {
+        unsigned long long start = now;
+        while(rx.empty() && now - start < timeout * 1000ULL) { advance(MILLIS_US); }
+        if(rx.empty()) { break; }
+        buffer[n++] = (char)read();
+      }
+      return n;
+    }
+    size_t write(char c)
+    {
+      while(tx.size() >= SERIAL_BUFFER_SIZE - 1) { advance(txFreeAt - now); }
+      if(tx.empty()) { txFreeAt = now + SERIAL_CHAR_US; }
+      tx.push_back(c);
+      return 1;
+    }
+    void flush() { while(!tx.empty()) { advance(txFreeAt - now); } }            // waits until all is sent, as since Arduino 1.0
+    size_t print(const char *s) { size_t n = 0; while(s[n]) { write(s[n++]); } return n; }
+    size_t print(char c) { return write(c); }
+    size_t print(int i) { char s[12]; return print(itoa(i, s, 10)); }
+    size_t println(const char *s) { return print(s) + print("\r\n"); }
+
+  private:
+    struct Pending { unsigned long long at; char c; };
+
+    unsigned long long now;
+    unsigned long long txFreeAt;                                               // when the character being sent has left
+    unsigned long long rxFreeAt;                                               // when the last answer is through
+    std::deque<char> tx, rx;
+    std::deque<Pending> line;                                                  // answer characters on their way
+    HostModem *modem;
+    unsigned long timeout;
+    unsigned long sent, got, lost;
+};
+
+inline HardwareSerial &host_serial()
+{
+  static HardwareSerial serial;
+  return serial;
+}
+#define Serial host_serial()
+
+inline unsigned long millis()
+{
+  Serial.advance(MILLIS_US);
+  return (unsigned long)(Serial.micros() / 1000);
+}
+
+inline void delay(unsigned long ms) { Serial.advance(ms * 1000ULL); }
+
+#endif
@@ -0,0 +1,7 @@
+/*
+GSM_easy.h - Host stand-in: gsm_easy.cpp includes <GSM_easy.h>, the file is called gsm_easy.h
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include "../../gsm_easy.h"
@@ -0,0 +1,214 @@
+/*
+m95_sim.h - Host stand-in for a Quectel M95 on the other end of "Serial", see Arduino.h
+
+Answers the AT commands GSM_easy sends the way the module does, with its usual delays: the commands of
+"initialize" and "connectGPRS", SMS, calls, TCP (AT+QIOPEN, AT+QISTAT, AT+QISEND and the data up to CTRL-Z,
+answered by a HTTP response and, unless the request asked for "Connection: keep-alive", CLOSED; AT+QICLOSE),
+AT+QPING, AT+QIDEACT and the e-mail (with its text up to "+++") and FTP commands, AT+QFTPGET with "file". Anything else is answered with ERROR, and so is every command starting
+with one of the texts given to failOn().
+Everything received is kept in "transcript". incomingSMS() and ring() send the unsolicited messages of a new SMS
+and an incoming call right away, also in the middle of an answer. serverClose() has the server close the TCP
+connection, dropConnection() has the module lose it without a word. detach() has AT+CGATT? answer "+CGATT: 0"
+for a while, as while the module is attaching to GPRS.
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#ifndef m95_sim_h
+#define m95_sim_h
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+class M95Sim : public HostModem
+{
+  public:
+    std::string transcript;                                                    // all the sketch has sent
+    unsigned long commands;                                                    // AT commands answered
+    int stored;                                                                // SMS on the SIM
+    std::string text;                                                          // of each of them
+    std::string file;                                                          // sent for AT+QFTPGET
+    std::string body;                                                          // of the HTTP responses
+    unsigned long connections;                                                 // TCP connections opened
+    unsigned long requests;                                                    // HTTP requests answered
+    unsigned long payload;                                                     // bytes of the requests and responses
+
+    M95Sim() : commands(0), stored(3), text("Hello"), file("interval=60\r\napn=internet\r\n"), body("OK"),
+               connections(0), requests(0), payload(0), echo(true), data(NONE), tcp(false),
+               opened(false), attachedAt(0) { Serial.attach(this); }
+
+    void failOn(const char *prefix) { failing.push_back(prefix); }
+    void failNothing() { failing.clear(); }
+
+    void incomingSMS()
+    {
+      stored += 1;
+      Serial.unsolicited(("\r\n+CMTI: \"SM\"," + std::to_string(stored) + "\r\n").c_str());
+    }
+    void ring() { Serial.unsolicited("\r\nRING\r\n"); }
+    void serverClose()
+    {
+      if(tcp) { Serial.unsolicited("\r\nCLOSED\r\n"); }
+      tcp = false;
+    }
+    void dropConnection() { tcp = false; }
+    void detach(unsigned long ms) { attachedAt = millis() + ms; }
+
+    void received(char c)
+    {
+      transcript += c;
+      if(data == EMAIL)                                                        // text of an e-mail, up to "+++"
+      {
+        line += c;
+        if(line.size() >= 3 && line.compare(line.size() - 3, 3, "+++") == 0)
+        {
+          Serial.answer(20, "\r\n+QSMTPBODY: 10\r\n\r\nOK\r\n");
+          line.clear();
+          data = NONE;
+        }
+        return;
+      }
+      if(data != NONE)                                                         // text after the prompt, up to CTRL-Z
+      {
+        if(c != 0x1a)
+        {
+          if(data == TCP) { request += c; }
+          return;
+        }
+        if(data == TCP)
+        {
+          bool keep = request.find("\r\nConnection: keep-alive\r\n") != std::string::npos;
+          std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " +
+                                 std::to_string(body.size()) + "\r\n";
+          response += (keep ? "Connection: keep-alive\r\n\r\n" : "\r\n") + body;
+          requests += 1;
+          payload += request.size() + response.size();
+          request.clear();
+          Serial.answer(40, "\r\nSEND OK\r\n");
+          Serial.answer(700, ("\r\n" + response + "\r\n").c_str());
+          if(!keep)
+          {
+            Serial.answer(150, "\r\nCLOSED\r\n");
+            tcp = false;
+          }
+        }
+        else
+        {
+          Serial.answer(2500, "\r\n+CMGS: 17\r\n\r\nOK\r\n");
+        }
+        data = NONE;
+        return;
+      }
+      if(c != '\r')
+      {
+        line += c;
+        return;
+      }
+      if(echo) { Serial.answer(0, (line + "\r").c_str()); }
+      Answer(line);
+      line.clear();
+    }
+
+  private:
+    enum { NONE, TCP, SMS, EMAIL };
+
+    bool echo;
+    int data;
+    bool tcp, opened;                                                          // TCP connection up, was ever up
+    unsigned long attachedAt;                                                  // time the module is attached to GPRS
+    std::string request;
+    std::string line;
+    std::vector<std::string> failing;
+
+    static bool is(const std::string &command, const char *prefix) { return command.compare(0, strlen(prefix), prefix) == 0; }
+
+    void Answer(const std::string &command)
+    {
+      commands += 1;
+      for(size_t i = 0; i < failing.size(); i++)
+      {
+        if(is(command, failing[i].c_str())) { Serial.answer(20, "\r\nERROR\r\n"); return; }
+      }
+
+      if(command == "AT")                  { Serial.answer(10, "\r\nOK\r\n"); }
+      else if(command == "ATE0")
+      {
+        echo = false;
+        Serial.answer(10, "\r\nOK\r\n");
+        Serial.answer(800, "\r\n+CPIN: READY\r\n");                            // the SIM is ready a little later
+      }
+      else if(is(command, "AT+CPIN="))     { Serial.answer(300, "\r\nOK\r\n\r\n+CPIN: READY\r\n"); }
+      else if(command == "AT+CREG?")       { Serial.answer(15, "\r\n+CREG: 0,1\r\n\r\nOK\r\n"); }
+      else if(command == "AT+CGREG?")      { Serial.answer(15, "\r\n+CGREG: 0,1\r\n\r\nOK\r\n"); }
+      else if(command == "AT+CSQ")         { Serial.answer(15, "\r\n+CSQ: 19,0\r\n\r\nOK\r\n"); }
+      else if(command == "AT+COPS?")       { Serial.answer(15, "\r\n+COPS: 0,0,\"T-Mobile D\"\r\n\r\nOK\r\n"); }
+      else if(command == "AT+CGATT?")
+      {
+        Serial.answer(15, millis() - attachedAt < 0x80000000UL ? "\r\n+CGATT: 1\r\n\r\nOK\r\n" : "\r\n+CGATT: 0\r\n\r\nOK\r\n");
+      }
+      else if(command == "AT+QISTAT")
+      {
+        Serial.answer(15, tcp ? "\r\nOK\r\n\r\nSTATE: CONNECT OK\r\n" :
+                          opened ? "\r\nOK\r\n\r\nSTATE: IP CLOSE\r\n" : "\r\nOK\r\n\r\nSTATE: IP INITIAL\r\n");
+      }
+      else if(is(command, "AT+QIOPEN=") && tcp) { Serial.answer(40, "\r\nALREADY CONNECT\r\n"); }
+      else if(is(command, "AT+QIOPEN="))
+      {
+        Serial.answer(40, "\r\nOK\r\n");
+        Serial.answer(1800, "\r\nCONNECT OK\r\n");                             // the TCP connection is up
+        tcp = opened = true;
+        connections += 1;
+      }
+      else if(command == "AT+QISEND" && tcp) { Serial.answer(30, "\r\n> "); data = TCP; }
+      else if(command == "AT+QICLOSE" && tcp) { Serial.answer(200, "\r\nCLOSE OK\r\n"); tcp = false; }
+      else if(is(command, "AT+CMGS="))     { Serial.answer(30, "\r\n> "); data = SMS; }
+      else if(is(command, "AT+QPING="))
+      {
+        Serial.answer(20, "\r\nOK\r\n");
+        Serial.answer(600, "\r\n+QPING: 0,\"173.194.69.99\",32,310,255\r\n\r\n+QPING: 0,1,1,0,310,310,310\r\n");
+      }
+      else if(command == "AT+QIDEACT")     { Serial.answer(900, "\r\nDEACT OK\r\n"); tcp = false; }
+      else if(command == "AT+CPMS?")
+      {
+        std::string n = std::to_string(stored);
+        Serial.answer(20, ("\r\n+CPMS: \"SM\"," + n + ",20,\"SM\"," + n + ",20,\"SM\"," + n + ",20\r\n\r\nOK\r\n").c_str());
+      }
+      else if(command == "AT+CMGD=1,4")    { stored = 0; Serial.answer(20, "\r\nOK\r\n"); }
+      else if(is(command, "AT+CMGR="))
+      {
+        Serial.answer(40, ("\r\n+CMGR: \"REC READ\",\"+491701234567\",,\"13/04/24,10:15:00+08\"\r\n" + text + "\r\n\r\nOK\r\n").c_str());
+      }
+      else if(is(command, "AT+CMGL="))
+      {
+        std::string list;
+        for(int i = 1; i <= stored; i++)
+        {
+          list += "\r\n+CMGL: " + std::to_string(i) + ",\"REC READ\",\"+491701234567\",,\"13/04/24,10:15:00+08\"\r\n" + text;
+        }
+        Serial.answer(40, (list + "\r\n\r\nOK\r\n").c_str());
+      }
+      else if(is(command, "ATD"))          { Serial.answer(6000, "\r\nOK\r\n"); }
+      else if(is(command, "AT+QSMTPBODY")) { Serial.answer(30, "\r\nOK\r\n\r\nCONNECT\r\n"); data = EMAIL; }
+      else if(command == "AT+QSMTPPUT")    { Serial.answer(20, "\r\nOK\r\n"); Serial.answer(4000, "\r\n+QSMTPPUT: 0\r\n"); }
+      else if(is(command, "AT+QFTPOPEN="))  { Serial.answer(20, "\r\nOK\r\n"); Serial.answer(2000, "\r\n+QFTPOPEN:0\r\n"); }
+      else if(command == "AT+QFTPCLOSE")   { Serial.answer(20, "\r\nOK\r\n"); Serial.answer(300, "\r\n+QFTPCLOSE:0\r\n"); }
+      else if(is(command, "AT+QFTPPATH=")) { Serial.answer(20, "\r\nOK\r\n"); Serial.answer(500, "\r\n+QFTPPATH:0\r\n"); }
+      else if(is(command, "AT+QFTPGET="))
+      {
+        Serial.answer(20, "\r\nOK\r\n");
+        Serial.answer(1500, ("\r\nCONNECT\r\n" + file + "OK\r\n\r\n+QFTPGET:" + std::to_string(file.size()) + "\r\n").c_str());
+      }
+      else if(is(command, "AT+IPR=") || is(command, "AT+QIURC=") || is(command, "AT+QICSGP=") ||
+              is(command, "AT+QIDNSIP=") || is(command, "AT+CMGF=") ||
+              is(command, "AT+CMGD=") || is(command, "AT+COLP=") || command == "AT+CLCC" ||
+              is(command, "AT+VTS=") || command == "ATA" || command == "ATH" || is(command, "AT+QSMTP") ||
+              is(command, "AT+QFTP"))
+      {
+        Serial.answer(20, "\r\nOK\r\n");
+      }
+      else                                 { Serial.answer(20, "\r\nERROR\r\n"); }
+    }
+};
+
+#endif
@@ -0,0 +1,5 @@
+/*
+pins_arduino.h - Host stand-in, nothing of it is used by GSM_easy
+
+Part of the GSM_easy library, for host builds only.
+*/
@@ -0,0 +1,102 @@
+/*
+keepalive_bench - periodic HTTP GETs with a new TCP connection each (as before) and with HTTPkeepAlive(1)
+
+The other end of the line is the simulated M95 of extras/host/m95_sim.h, which also plays the HTTP server: it
+answers each request, closes the connection after it unless the request asked for "Connection: keep-alive",
+and counts connections, requests and their bytes. A tracker uploads every 60 seconds with the blocking
+sendHTTPGET(). Every 10 minutes the server closes the idle connection (the module reports CLOSED), and 5 minutes
+later the module loses it without a word, so both ways of noticing a lost connection are used. Both runs report
+how long an upload takes, the characters on the serial line and an estimate of the bytes over the air per upload:
+the HTTP bytes and 40 bytes of TCP/IP headers per packet, 7 packets to open and close a connection and 4 per
+request (request, response and their ACKs). Last, the server answers with a line "CLOSED" in its response, which
+must not be taken for the module's message: the next upload must use the same connection.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. keepalive_bench.cpp ../../gsm_easy.cpp -o keepalive_bench
+
+and run as
+
+  ./keepalive_bench [minutes]
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <GSM_easy.h>
+#include <m95_sim.h>
+
+static M95Sim modem;
+
+static char server[] = "www.antrax.de";
+static char parameters[] = "GET /WebServices/responder.php?52.520008,13.404954,48.5 HTTP/1.1";
+
+// uploads for "minutes", returns the number that failed
+static int run(bool keepAlive, unsigned long minutes)
+{
+  unsigned long start = millis(), next = start, closeAt = start + 270000UL, dropAt = start + 570000UL;
+  unsigned long uploads = 0, failed = 0, total = 0, longest = 0, shortest = 0xFFFFFFFFUL;
+  unsigned long connections = modem.connections, requests = modem.requests, payload = modem.payload;
+  unsigned long sent = Serial.charactersSent(), got = Serial.charactersReceived();
+
+  GSM.HTTPkeepAlive(keepAlive);
+  while(millis() - start < minutes * 60000UL)
+  {
+    delay(1);
+    unsigned long now = millis();
+
+    if(now - closeAt < 0x80000000UL) { closeAt += 600000UL; modem.serverClose(); }
+    if(now - dropAt < 0x80000000UL) { dropAt += 600000UL; modem.dropConnection(); }
+    if(now - next < 0x80000000UL)
+    {
+      next += 60000;
+      int ok = GSM.sendHTTPGET(server, parameters);
+      unsigned long took = millis() - now;
+      uploads += 1;
+      total += took;
+      if(took > longest) { longest = took; }
+      if(took < shortest) { shortest = took; }
+      if(!ok) { failed += 1; }
+    }
+    GSM.poll();
+  }
+  if(keepAlive && !GSM.HTTPclose()) { failed += 1; }
+
+  connections = modem.connections - connections;
+  requests = modem.requests - requests;
+  payload = modem.payload - payload;
+  unsigned long line = Serial.charactersSent() - sent + Serial.charactersReceived() - got;
+  unsigned long air = payload + 40 * (7 * connections + 4 * requests);
+  printf("%-10s %3lu uploads, %lu failed  %5lu ms each on average, %5lu - %5lu  %3lu connections  "
+         "%4lu characters on the line, %4lu bytes over the air each\n", keepAlive ? "keep-alive" : "close",
+         uploads, failed, total / uploads, shortest, longest, connections, line / uploads, air / uploads);
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long minutes = argc > 1 ? atoi(argv[1]) : 30;
+
+  GSM.begin();
+  if(!GSM.initialize((char *)"1234") || !GSM.connectGPRS((char *)"internet.t-mobile.de", (char *)"t-mobile", (char *)"tm"))
+  {
+    printf("no connection: %s\n", GSM.GSM_string);
+    return 1;
+  }
+
+  int errors = run(false, minutes);
+  errors += run(true, minutes);
+
+  //----- a response that reads like the module's "CLOSED"
+  modem.body = "status\r\nCLOSED\r\n";
+  GSM.HTTPkeepAlive(1);
+  int sent = GSM.sendHTTPGET(server, parameters);
+  size_t from = modem.transcript.size();
+  sent += GSM.sendHTTPGET(server, parameters);
+  bool reused = modem.transcript.find("AT+QIOPEN", from) == std::string::npos;
+  printf("response with a line CLOSED: %d of 2 uploads, the second %s\n", sent,
+         reused ? "on the same connection" : "opened a new one");
+  if(sent != 2 || !reused) { errors += 1; }
+  GSM.HTTPclose();
+  printf("%lu characters lost from the receive buffer\n", Serial.charactersLost());
+  return errors != 0;
+}
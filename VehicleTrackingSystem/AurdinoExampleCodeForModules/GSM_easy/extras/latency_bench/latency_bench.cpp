@@ -0,0 +1,86 @@
+/*
+latency_bench - how long each operation of GSM_easy takes against the simulated M95 of extras/host/m95_sim.h
+
+Runs the public operations one after the other, as the demo sketches do, and prints the simulated time each
+of them takes and its result. Build it twice, as the library is now and with GSM_IDLE_GAP_ONLY (reactions end
+only after GSM_IDLE_GAP ms of silence, as in version 4.0), and compare. Last, readSMS() reads SMS whose text
+is a line "OK" or "ERROR" and FTPdownload() a file with such lines, which must neither end the reaction early
+nor make it an error:
+
+  g++ -O2 -I../host -I../.. latency_bench.cpp ../../gsm_easy.cpp -o latency_bench
+  g++ -O2 -DGSM_IDLE_GAP_ONLY -I../host -I../.. latency_bench.cpp ../../gsm_easy.cpp -o latency_bench_gap
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <GSM_easy.h>
+#include <m95_sim.h>
+
+static M95Sim modem;
+
+static unsigned long total, before;
+static int errors;
+
+static void measure(const char *name, int result, int ok = 1)
+{
+  unsigned long now = millis();
+  printf("  %-22s %7lu ms  %d%s\n", name, now - before, result, result == ok ? "" : "  failed");
+  total += now - before;
+  if(result != ok) { errors += 1; }
+  before = millis();
+}
+
+int main()
+{
+  GSM.begin();
+  before = millis();
+#ifdef GSM_IDLE_GAP_ONLY
+  printf("reactions end after %d ms of silence\n", GSM_IDLE_GAP);
+#else
+  printf("reactions end with their final result code\n");
+#endif
+
+  measure("initialize", GSM.initialize((char *)"1234"));
+  measure("Status", GSM.Status());
+  measure("connectGPRS", GSM.connectGPRS((char *)"internet.t-mobile.de", (char *)"t-mobile", (char *)"tm"));
+  measure("sendHTTPGET", GSM.sendHTTPGET((char *)"www.antrax.de",
+                                         (char *)"GET /WebServices/responder.php?52.520008,13.404954 HTTP/1.1"));
+  measure("sendPING", GSM.sendPING((char *)"www.google.com", 10));
+  measure("sendSMS", GSM.sendSMS((char *)"+491701234567", (char *)"Position 52.520008,13.404954"));
+  measure("numberofSMS", GSM.numberofSMS(), 3);
+  measure("readSMS", GSM.readSMS(1));
+  measure("deleteSMS", GSM.deleteSMS(1));
+  measure("dialCall", GSM.dialCall((char *)"+491701234567"));
+  measure("sendDTMF", GSM.sendDTMF('5'));
+  measure("exitCall", GSM.exitCall());
+  measure("pickUp", GSM.pickUp());
+  measure("EMAILconfigureSMTP", GSM.EMAILconfigureSMTP((char *)"smtp.example.com", 25, (char *)"user", (char *)"pwd"));
+  measure("EMAILconfigureSender", GSM.EMAILconfigureSender((char *)"Tracker", (char *)"tracker@example.com"));
+  measure("EMAILrecipients", GSM.EMAILrecipients(1, (char *)"fleet@example.com"));
+  measure("EMAILbody", GSM.EMAILbody((char *)"Position", (char *)"52.520008,13.404954"));
+  measure("EMAILsend", GSM.EMAILsend());
+  measure("FTPopen", GSM.FTPopen((char *)"ftp.example.com", 21, (char *)"user", (char *)"pass"));
+  measure("FTPdownload", GSM.FTPdownload((char *)"/", (char *)"config.txt"));
+  measure("FTPclose", GSM.FTPclose());
+  GSM.disconnectGPRS();
+  measure("disconnectGPRS", 1);
+
+  //----- SMS that read like result codes
+  modem.stored = 2;
+  modem.text = "OK";
+  measure("readSMS(0), text OK", GSM.readSMS(0) && strstr(GSM.GSM_string, "+CMGL: 2") && !Serial.available());
+  modem.text = "ERROR";
+  measure("readSMS(0), text ERROR", GSM.readSMS(0) && strstr(GSM.GSM_string, "+CMGL: 2") && !Serial.available());
+  measure("readSMS(1), text ERROR", GSM.readSMS(1));
+  modem.text = "+CMS ERROR: 500";
+  measure("readSMS(1), text +CMS", GSM.readSMS(1));
+  modem.file = "mode=fleet\r\nERROR\r\n+CME ERROR: 3\r\nOK\r\nend\r\n";
+  measure("FTPopen", GSM.FTPopen((char *)"ftp.example.com", 21, (char *)"user", (char *)"pass"));
+  measure("FTPdownload, ERROR", GSM.FTPdownload((char *)"/", (char *)"config.txt") &&
+                                 strstr(GSM.GSM_string, "end\r\nOK\r\n"));
+  measure("FTPclose", GSM.FTPclose());
+
+  printf("  %-22s %7lu ms\n", "all", total);
+  printf("%d failed, %lu characters lost from the receive buffer\n", errors, Serial.charactersLost());
+  return errors != 0;
+}
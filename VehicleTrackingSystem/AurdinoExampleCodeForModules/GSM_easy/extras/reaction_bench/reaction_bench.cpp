@@ -0,0 +1,238 @@
+/*
+reaction_bench - the automaton of gsm_reactions.h against the strstr() chain of GSM_easy 4.0
+
+The reactions are those of the communication protocols recorded with the demo sketches (see examples/Commun.
+Protocal: status, ping, receive and send SMS), followed by the reactions of extras/host/m95_sim.h to the TCP,
+e-mail and FTP commands, which no protocol was recorded for, and four on purpose: "+QFTPGET:0", which the old
+order took for ":0", "ERROR", which it did not know, a SMS with "OK" and "ERROR" inside its text, which must
+not count as result codes as they do not start a line, and a list of SMS longer than GSM_string, whose final
+OK the old way never saw. (A SMS whose text is a line "OK" or "ERROR" is in extras/latency_bench: "poll" ends
+the reaction to AT+CMGR and AT+CMGL only with the silence and takes the last result code of it.) For each the bench prints both numbers, then the time both ways take on this host:
+the old way clears GSM_string, collects the reaction into it and then searches it for each text in turn, the
+automaton takes each character as it comes in. As the host's strstr() compares many bytes at once, the bench
+also counts the character comparisons both ways take, one at a time as on the AVR.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. reaction_bench.cpp -o reaction_bench
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <Arduino.h>
+#include <gsm_reactions.h>
+#include <time.h>
+#include <string>
+
+struct Reaction
+{
+  const char *source;
+  std::string text;
+};
+
+static Reaction reactions[] =
+{
+  { "status", "AT\r\r\nOK\r\n" },
+  { "status", "ATE0\r\r\nOK\r\n" },
+  { "status", "\r\n+CFUN: 1\r\n\r\n+CPIN: SIM PIN\r\n" },
+  { "status", "\r\n+CPIN: READY\r\n\r\nOK\r\n" },
+  { "status", "\r\nOK\r\n" },
+  { "status", "\r\n+CREG: 0,2\r\n\r\nOK\r\n" },
+  { "status", "\r\n+CREG: 0,1\r\n\r\nOK\r\n" },
+  { "status", "\r\n+CGREG: 0,2\r\n\r\nOK\r\n" },
+  { "status", "\r\n+CSQ: 24,0\r\n\r\nOK\r\n" },
+  { "status", "\r\n+COPS: 0,0,\"O2 (Germany)\"\r\n\r\nOK\r\n" },
+  { "ping", "\r\n+CGATT: 0\r\n\r\nOK\r\n" },
+  { "ping", "\r\n+CGATT: 1\r\n\r\nOK\r\n" },
+  { "ping", "\r\nOK\r\n\r\nSTATE: IP INITIAL\r\n" },
+  { "ping", "\r\n+QPING: 0,173.194.69.106,32,1914,45\r\n+QPING: 2,1,1,0,1914,1914,1914\r\n" },
+  { "recvsms", "\r\n+CPMS: \"SM\",1,20,\"SM\",1,20,\"SM\",1,20\r\n\r\nOK\r\n" },
+  { "recvsms", "\r\n+CMGR: \"REC UNREAD\",\"+491717047315\",\"\",\"2013/04/16 12:24:09+08\"\r\nAnruf-Info von Mailbox: "
+               "+491717047315 hat keine Nachricht hinterlassen 16.04.2013 um 12:24 Uhr. * Diese SMS ist fuer Sie "
+               "kostenlos\r\n\r\nOK\r\n" },
+  { "sendsms", "\r\n> " },
+  { "sendsms", "\r\n+CMGS: 99\r\n\r\nOK\r\n" },
+  { "m95_sim", "\r\nCONNECT OK\r\n" },
+  { "m95_sim", "\r\nSEND OK\r\n" },
+  { "m95_sim", "\r\nHTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 2\r\n\r\nOK\r\n\r\nCLOSED\r\n" },
+  { "m95_sim", "\r\nDEACT OK\r\n" },
+  { "m95_sim", "\r\nOK\r\n\r\nCONNECT\r\n" },
+  { "m95_sim", "\r\n+QSMTPBODY: 10\r\n\r\nOK\r\n" },
+  { "m95_sim", "\r\n+QSMTPPUT: 0\r\n" },
+  { "m95_sim", "\r\n+QFTPOPEN:0\r\n" },
+  { "m95_sim", "\r\nOK\r\n\r\n+QFTPPATH:0\r\n" },
+  { "purpose", "\r\n+QFTPGET:0\r\n" },
+  { "purpose", "\r\nERROR\r\n" },
+  { "purpose", "\r\n+CMGR: \"REC READ\",\"+491701234567\",,\"13/04/24,10:15:00+08\"\r\nIgnition OK, GPS ERROR\r\n\r\nOK\r\n" },
+  { "purpose", "" },                                                           // the long list, see main()
+};
+static const int count = sizeof(reactions) / sizeof(reactions[0]);
+
+#define BUFFER_SIZE 250
+
+static char GSM_string[BUFFER_SIZE];
+
+// WaitOfReaction() of GSM_easy 4.0, without the waiting
+static int old_way(const std::string &text)
+{
+  memset(GSM_string, 0, BUFFER_SIZE);
+  size_t n = text.size() < BUFFER_SIZE - 1 ? text.size() : BUFFER_SIZE - 1;
+  for(size_t i = 0; i < n; i++) { GSM_string[i] = text[i]; }
+
+  if(strstr(GSM_string, "SIM PIN\r\n"))               { return 2; }
+  if(strstr(GSM_string, "READY\r\n"))                 { return 3; }
+  if(strstr(GSM_string, "0,1\r\n"))                   { return 4; }
+  if(strstr(GSM_string, "0,5\r\n"))                   { return 4; }
+  if(strstr(GSM_string, "\n>"))                       { return 5; }
+  if(strstr(GSM_string, "NO CARRIER\r\n"))            { return 6; }
+  if(strstr(GSM_string, "+CGATT: 1\r\n"))             { return 7; }
+  if(strstr(GSM_string, "IP INITIAL\r\n"))            { return 8; }
+  if(strstr(GSM_string, "IP STATUS\r\n"))             { return 8; }
+  if(strstr(GSM_string, "IP CLOSE\r\n"))              { return 8; }
+  if(strstr(GSM_string, "CONNECT OK\r\n"))            { return 9; }
+  if(strstr(GSM_string, "ALREADY CONNECT\r\n"))       { return 9; }
+  if(strstr(GSM_string, "SEND OK\r\n"))               { return 10; }
+  if(strstr(GSM_string, "RING\r\n"))                  { return 11; }
+  if(strstr(GSM_string, "+QPING:"))                   { return 12; }
+  if(strstr(GSM_string, "+CPMS:"))                    { return 13; }
+  if(strstr(GSM_string, "OK\r\n\r\nCONNECT\r\n"))     { return 14; }
+  if(strstr(GSM_string, "+QSMTPBODY:"))               { return 15; }
+  if(strstr(GSM_string, "+QSMTPPUT: 0"))              { return 16; }
+  if(strstr(GSM_string, ":0\r\n"))                    { return 17; }
+  if(strstr(GSM_string, "+QFTPGET:"))                 { return 18; }
+  if(strstr(GSM_string, "OK\r\n"))                    { return 1; }
+  return 0;
+}
+
+// what poll() does with each character
+static int automaton(const std::string &text)
+{
+  byte state = GSM_REACTION_START, best = 0;
+  for(size_t i = 0; i < text.size(); i++)
+  {
+    state = GSM_reactionStep(state, text[i]);
+    byte rank = pgm_read_byte(&GSM_reactionRank[state]);
+    if((rank & GSM_REACTION_RANK) > best) { best = rank & GSM_REACTION_RANK; }
+  }
+  return pgm_read_byte(&GSM_reactionNumber[best]);
+}
+
+//----- character comparisons, which is what counts on the AVR: avr-libc's strstr() compares byte by byte
+static unsigned long compared;
+
+static const char *counting_strstr(const char *s, const char *text)
+{
+  for(; *s; s++)
+  {
+    size_t i = 0;
+    while(text[i] && (compared += 1, s[i] == text[i])) { i++; }
+    if(!text[i]) { return s; }
+  }
+  return 0;
+}
+
+static const char *const old_texts[] =
+{
+  "SIM PIN\r\n", "READY\r\n", "0,1\r\n", "0,5\r\n", "\n>", "NO CARRIER\r\n", "+CGATT: 1\r\n", "IP INITIAL\r\n",
+  "IP STATUS\r\n", "IP CLOSE\r\n", "CONNECT OK\r\n", "ALREADY CONNECT\r\n", "SEND OK\r\n", "RING\r\n", "+QPING:",
+  "+CPMS:", "OK\r\n\r\nCONNECT\r\n", "+QSMTPBODY:", "+QSMTPPUT: 0", ":0\r\n", "+QFTPGET:", "OK\r\n"
+};
+
+static void old_comparisons(const std::string &text)
+{
+  old_way(text);
+  for(size_t t = 0; t < sizeof(old_texts) / sizeof(old_texts[0]); t++)
+  {
+    if(counting_strstr(GSM_string, old_texts[t])) { return; }
+  }
+}
+
+static void automaton_comparisons(const std::string &text)
+{
+  for(size_t i = 0, s = GSM_REACTION_START; i < text.size(); i++)
+  {
+    for(;;)
+    {
+      if(s == 0 && (compared += 1, !(pgm_read_byte(&GSM_reactionStart[(byte)text[i] >> 3]) & (1 << (text[i] & 7))))) { break; }
+      byte e = pgm_read_byte(&GSM_reactionFirst[s]), end = pgm_read_byte(&GSM_reactionFirst[s + 1]);
+      while(e < end && (compared += 1, pgm_read_byte(&GSM_reactionChar[e]) != (byte)text[i])) { e++; }
+      if(e < end) { s = pgm_read_byte(&GSM_reactionNext[e]); break; }
+      if(s == 0) { break; }
+      s = pgm_read_byte(&GSM_reactionFail[s]);
+    }
+  }
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// best of five, in ns per run through all reactions
+template <class F>
+static double timed(F f)
+{
+  const int rounds = 20000;
+  double best = 1e9;
+  volatile int sink = 0;
+  for(int r = 0; r < 5; r++)
+  {
+    double start = seconds();
+    for(int i = 0; i < rounds; i++)
+    {
+      for(int k = 0; k < count; k++) { sink = sink + f(reactions[k].text); }
+    }
+    double t = (seconds() - start) / rounds * 1e9;
+    if(t < best) { best = t; }
+  }
+  return best;
+}
+
+static std::string shown(const std::string &text)
+{
+  std::string s;
+  for(size_t i = 0; i < text.size() && s.size() < 48; i++)
+  {
+    if(text[i] == '\r') { s += "\\r"; } else if(text[i] == '\n') { s += "\\n"; } else { s += text[i]; }
+  }
+  return s.size() < 48 ? s : s + "...";
+}
+
+int main()
+{
+  std::string &list = reactions[count - 1].text;                               // AT+CMGL="ALL" with 3 SMS
+  for(int i = 1; i <= 3; i++)
+  {
+    list += "\r\n+CMGL: " + std::to_string(i) + ",\"REC READ\",\"+491701234567\",\"\",\"13/04/24,10:15:00+08\"\r\n";
+    list += "Position 52.520008,13.404954 speed 48.5 km/h, ignition on\r\n";
+  }
+  list += "\r\nOK\r\n";
+
+  int differ = 0;
+  size_t characters = 0;
+  printf("source   old new  reaction\n");
+  for(int k = 0; k < count; k++)
+  {
+    int a = old_way(reactions[k].text), b = automaton(reactions[k].text);
+    printf("%-8s %3d %3d%s %s\n", reactions[k].source, a, b, a != b ? "*" : " ", shown(reactions[k].text).c_str());
+    characters += reactions[k].text.size();
+    if(a != b && strcmp(reactions[k].source, "purpose") != 0) { differ += 1; }
+  }
+
+  compared = 0;
+  for(int k = 0; k < count; k++) { old_comparisons(reactions[k].text); }
+  unsigned long old_compared = compared;
+  compared = 0;
+  for(int k = 0; k < count; k++) { automaton_comparisons(reactions[k].text); }
+  unsigned long new_compared = compared;
+
+  double old_ns = timed(old_way), new_ns = timed(automaton);
+  printf("%d reactions, %u characters\n", count, (unsigned)characters);
+  printf("                 comparisons per character      on this host per reaction\n");
+  printf("  strstr chain   %8.1f                     %7.1f ns\n", (double)old_compared / characters, old_ns / count);
+  printf("  automaton      %8.1f                     %7.1f ns\n", (double)new_compared / characters, new_ns / count);
+  printf("%d unexpected differences\n", differ);
+  return differ != 0;
+}
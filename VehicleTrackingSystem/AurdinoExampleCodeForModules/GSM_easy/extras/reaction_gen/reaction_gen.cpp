@@ -0,0 +1,231 @@
+/*
+reaction_gen - writes gsm_reactions.h, the automaton "poll" uses to recognise the reactions of the mobile module
+
+The texts GSM_easy looks for in a reaction are in the table below, strongest first: when a reaction contains
+several of them, the first one in the table decides its number (see "Classify" in gsm_easy.cpp). From them an
+Aho-Corasick automaton is built (Aho and Corasick, "Efficient string matching", CACM 18(6), 1975). It follows
+a reaction character by character as it comes in and knows after each one which texts have ended there, so
+no text is ever searched for again. States, edges and failure links are written as byte tables for PROGMEM.
+The result codes start with "\n", so "OK" or "ERROR" inside a line, e.g. of a SMS, is not taken for one; the
+automaton starts each reaction in GSM_REACTION_START, the state after a "\n", for the first line.
+
+Build from this directory and write a new gsm_reactions.h with
+
+  g++ -O2 reaction_gen.cpp -o reaction_gen && ./reaction_gen > ../../gsm_reactions.h
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Reaction
+{
+  const char *text;
+  int number;
+  int end;
+};
+
+// strongest first; FINAL: the reaction ends with the text, LINE: it ends with the line of the text
+enum { MORE, FINAL, LINE };
+static const int error = 19;                                                   // number of all error reactions
+
+static const Reaction reactions[] =
+{
+  { "SIM PIN\r\n", 2, MORE },
+  { "READY\r\n", 3, MORE },
+  { "0,1\r\n", 4, MORE },
+  { "0,5\r\n", 4, MORE },
+  { "\n> ", 5, FINAL },                                                        // prompt for text, ends with the blank
+  { "\n>", 5, MORE },
+  { "NO CARRIER\r\n", 6, FINAL },
+  { "+CGATT: 1\r\n", 7, MORE },
+  { "IP INITIAL\r\n", 8, FINAL },
+  { "IP STATUS\r\n", 8, FINAL },
+  { "IP CLOSE\r\n", 8, FINAL },
+  { "CONNECT OK\r\n", 9, FINAL },
+  { "ALREADY CONNECT\r\n", 9, FINAL },
+  { "SEND OK\r\n", 10, FINAL },
+  { "RING\r\n", 11, MORE },
+  { "+QPING:", 12, MORE },
+  { "+CPMS:", 13, MORE },
+  { "\nOK\r\n\r\nCONNECT\r\n", 14, FINAL },
+  { "+QSMTPBODY:", 15, MORE },
+  { "+QSMTPPUT: 0", 16, LINE },
+  { "+QFTPGET:", 18, MORE },                                                   // before ":0\r\n", which would take "+QFTPGET:0"
+  { ":0\r\n", 17, FINAL },
+  { "\n+CME ERROR:", error, LINE },                                             // result codes only at the start of a line,
+  { "\n+CMS ERROR:", error, LINE },                                             // "poll" starts each reaction after a "\n"
+  { "\nERROR\r\n", error, FINAL },
+  { "DEACT OK\r\n", 1, FINAL },                                                  // answers of AT+QIDEACT and AT+QICLOSE,
+  { "CLOSE OK\r\n", 1, FINAL },                                                  // which "OK" at the start of a line misses
+  { "\nOK\r\n", 1, FINAL },
+};
+static const int count = sizeof(reactions) / sizeof(reactions[0]);
+
+struct State
+{
+  std::vector<std::pair<char, int> > edges;
+  int fail;
+  int rank;                                                                    // of the strongest text ending here, 0 = none
+  int end;                                                                     // GSM_REACTION_FINAL and _LINE of all texts ending here
+
+  State() : fail(0), rank(0), end(0) {}
+};
+
+static std::vector<State> states(1);
+
+static int child(int s, char c)
+{
+  for(size_t i = 0; i < states[s].edges.size(); i++)
+  {
+    if(states[s].edges[i].first == c) { return states[s].edges[i].second; }
+  }
+  return -1;
+}
+
+static void table(const char *name, const std::vector<int> &values)
+{
+  printf("static const byte %s[%u] PROGMEM =\n{", name, (unsigned)values.size());
+  for(size_t i = 0; i < values.size(); i++)
+  {
+    printf("%s%3d%s", i % 16 ? " " : "\n  ", values[i], i + 1 < values.size() ? "," : "");
+  }
+  printf("\n};\n\n");
+}
+
+static std::string quoted(const char *text)
+{
+  std::string s;
+  for(; *text; text++)
+  {
+    if(*text == '\r') { s += "\\r"; } else if(*text == '\n') { s += "\\n"; } else { s += *text; }
+  }
+  return s;
+}
+
+int main()
+{
+  //----- trie
+  for(int r = 0; r < count; r++)
+  {
+    int s = 0;
+    for(const char *p = reactions[r].text; *p; p++)
+    {
+      int next = child(s, *p);
+      if(next < 0)
+      {
+        next = (int)states.size();
+        states.push_back(State());
+        states[s].edges.push_back(std::make_pair(*p, next));
+      }
+      s = next;
+    }
+    if(states[s].rank == 0) { states[s].rank = count - r; }
+    states[s].end |= reactions[r].end == FINAL ? 0x80 : reactions[r].end == LINE ? 0x40 : 0;
+  }
+
+  //----- failure links, breadth first so the state a link points to is done; ranks along the links
+  std::vector<int> order(1, 0);
+  for(size_t i = 0; i < order.size(); i++)
+  {
+    int s = order[i];
+    for(size_t e = 0; e < states[s].edges.size(); e++)
+    {
+      char c = states[s].edges[e].first;
+      int next = states[s].edges[e].second;
+      if(s != 0)
+      {
+        int f = states[s].fail;
+        while(f != 0 && child(f, c) < 0) { f = states[f].fail; }
+        states[next].fail = child(f, c) >= 0 ? child(f, c) : 0;
+      }
+      if(states[states[next].fail].rank > states[next].rank) { states[next].rank = states[states[next].fail].rank; }
+      states[next].end |= states[states[next].fail].end;
+      order.push_back(next);
+    }
+  }
+
+  if(states.size() > 255)
+  {
+    fprintf(stderr, "%u states, too many for byte tables\n", (unsigned)states.size());
+    return 1;
+  }
+
+  //----- tables, the edges of each state one after the other
+  std::vector<int> first, chars, next, fail, rank, number(1, 0);
+  for(size_t s = 0; s < states.size(); s++)
+  {
+    first.push_back((int)chars.size());
+    for(size_t e = 0; e < states[s].edges.size(); e++)
+    {
+      chars.push_back((unsigned char)states[s].edges[e].first);
+      next.push_back(states[s].edges[e].second);
+    }
+    fail.push_back(states[s].fail);
+    rank.push_back(states[s].rank | states[s].end);
+  }
+  first.push_back((int)chars.size());
+  std::vector<int> start(32, 0);
+  for(size_t e = 0; e < states[0].edges.size(); e++)
+  {
+    unsigned char c = states[0].edges[e].first;
+    start[c >> 3] |= 1 << (c & 7);
+  }
+  for(int r = count - 1; r >= 0; r--) { number.push_back(reactions[r].number); }
+  if(chars.size() > 255)
+  {
+    fprintf(stderr, "%u edges, too many for byte tables\n", (unsigned)chars.size());
+    return 1;
+  }
+
+  printf("/*\n");
+  printf("gsm_reactions.h - Automaton recognising the reactions of the mobile module, see \"Classify\" in gsm_easy.cpp\n\n");
+  printf("Written by extras/reaction_gen, don't edit: change the table there and run it again.\n\n");
+  printf("Texts, strongest first, their numbers and whether the reaction ends with them or their line:\n");
+  for(int r = 0; r < count; r++)
+  {
+    static const char *const ends[] = { "", "  final", "  line" };
+    printf("  %-25s %2d%s\n", ("\"" + quoted(reactions[r].text) + "\"").c_str(), reactions[r].number, ends[reactions[r].end]);
+  }
+  printf("*/\n\n");
+  printf("#ifndef gsm_reactions_h\n#define gsm_reactions_h\n\n");
+  printf("#define GSM_REACTION_STATES %u\n", (unsigned)states.size());
+  printf("#define GSM_REACTION_RANK   0x3F                                          // of GSM_reactionRank[]\n");
+  printf("#define GSM_REACTION_FINAL  0x80                                          // the reaction ends here\n");
+  printf("#define GSM_REACTION_LINE   0x40                                          // the reaction ends with this line\n");
+  printf("#define GSM_REACTION_ERROR  %d                                            // number of the errors\n", error);
+  printf("#define GSM_REACTION_START  %d                                            // state at the start of a line\n\n", child(0, '\n'));
+  printf("// characters a text starts with, one bit each\n");
+  table("GSM_reactionStart", start);
+  printf("// edges of state s: GSM_reactionFirst[s] ... GSM_reactionFirst[s + 1] - 1\n");
+  table("GSM_reactionFirst", first);
+  printf("// character and state of each edge\n");
+  table("GSM_reactionChar", chars);
+  table("GSM_reactionNext", next);
+  printf("// state of the longest end of the text so far that is the start of a text\n");
+  table("GSM_reactionFail", fail);
+  printf("// strongest text ending in the state, 0 = none, and whether the reaction ends; numbers of the texts\n");
+  table("GSM_reactionRank", rank);
+  table("GSM_reactionNumber", number);
+  printf("// state after character \"c\" in state \"s\", 0 is the state at the start\n");
+  printf("static inline byte GSM_reactionStep(byte s, char c)\n");
+  printf("{\n");
+  printf("  for(;;)\n");
+  printf("  {\n");
+  printf("    if(s == 0 && !(pgm_read_byte(&GSM_reactionStart[(byte)c >> 3]) & (1 << (c & 7)))) { return 0; }\n");
+  printf("    byte e = pgm_read_byte(&GSM_reactionFirst[s]);\n");
+  printf("    byte end = pgm_read_byte(&GSM_reactionFirst[s + 1]);\n");
+  printf("    for(; e < end; e++)\n");
+  printf("    {\n");
+  printf("      if(pgm_read_byte(&GSM_reactionChar[e]) == (byte)c) { return pgm_read_byte(&GSM_reactionNext[e]); }\n");
+  printf("    }\n");
+  printf("    if(s == 0) { return 0; }\n");
+  printf("    s = pgm_read_byte(&GSM_reactionFail[s]);\n");
+  printf("  }\n");
+  printf("}\n\n");
+  printf("#endif\n");
+  return 0;
+}
@@ -0,0 +1,175 @@
+/*
+urc_bench - unsolicited messages of the module ("RING", "+CMTI:") while a tracker uploads by HTTP GET
+
+The other end of the line is the simulated M95 of extras/host/m95_sim.h. As in at_engine_bench the loop does
+1 ms of other work and queues an upload every 60 seconds, calling poll() in every run. Meanwhile a SMS comes
+in every 97 seconds and a call, three RINGs 3 seconds apart, every 7 minutes, whether a command is in flight
+or not; the module sends them right away or after the line it is sending. The bench reports how many of them
+reached their handler (GSM_easy 4.0 threw away all that came between two commands), how long after they were
+sent, and that the uploads did not suffer from them. Then it compares the time numberofSMS() and RingStatus()
+take when they have to ask the module or wait for it with the time they take answering from what poll() saw.
+Last, handlers that call the blocking readSMS() themselves, one for a new SMS and one for a queued command,
+run during a blocking sendHTTPGET(): each must get its own SMS, and sendHTTPGET() its own result. And SMS whose
+text reads "RING" or "+CMTI:" must not be reported, but stay in GSM_string and make numberofSMS() ask the module.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. urc_bench.cpp ../../gsm_easy.cpp -o urc_bench
+
+and run as
+
+  ./urc_bench [minutes]
+
+Part of the GSM_easy library, for host builds only.
+*/
+
+#include <GSM_easy.h>
+#include <m95_sim.h>
+
+static M95Sim modem;
+
+static char server[] = "www.antrax.de";
+static char parameters[] = "GET /WebServices/responder.php?52.520008,13.404954,48.5 HTTP/1.1";
+
+static int uploading, uploaded, failed;
+static int sms, rings, lastIndex;
+static unsigned long sentAt, latency, longest;
+
+static void Uploaded(int ok)
+{
+  uploading = 0;
+  if(ok) { uploaded += 1; } else { failed += 1; }
+}
+
+static void Received(unsigned long now)
+{
+  latency += now - sentAt;
+  if(now - sentAt > longest) { longest = now - sentAt; }
+}
+
+static void NewSMS(int index) { sms += 1; lastIndex = index; Received(millis()); }
+static void Ring(int) { rings += 1; Received(millis()); }
+
+// blocking calls from handlers
+static int nested, nestedRead;
+
+static void ReadNow(int index)
+{
+  nested += 1;
+  if(GSM.readSMS(index) && strstr(GSM.GSM_string, "+CMGR:")) { nestedRead += 1; }
+}
+static void Queued(int) { ReadNow(1); }
+
+int main(int argc, char **argv)
+{
+  unsigned long minutes = argc > 1 ? atoi(argv[1]) : 30;
+  int errors = 0;
+
+  GSM.begin();
+  if(!GSM.initialize((char *)"1234") || !GSM.connectGPRS((char *)"internet.t-mobile.de", (char *)"t-mobile", (char *)"tm"))
+  {
+    printf("no connection: %s\n", GSM.GSM_string);
+    return 1;
+  }
+  GSM.onEvent(GSM_EVENT_SMS, NewSMS);
+  GSM.onEvent(GSM_EVENT_RING, Ring);
+
+  //----- the tracker's loop()
+  unsigned long start = millis(), next = start, nextSMS = start + 97000UL, nextCall = start + 420000UL;
+  int sentSMS = 0, sentRings = 0, inFlight = 0, ringsLeft = 0;
+  while(millis() - start < minutes * 60000UL)
+  {
+    delay(1);
+    unsigned long now = millis();
+
+    if(!uploading && now - next < 0x80000000UL)
+    {
+      next += 60000;
+      uploading = 1;
+      if(!GSM.sendHTTPGET(server, parameters, Uploaded)) { Uploaded(0); }
+    }
+    if(now - nextSMS < 0x80000000UL)
+    {
+      nextSMS += 97000UL;
+      sentAt = now;
+      modem.incomingSMS();
+      sentSMS += 1;
+      inFlight += uploading;
+    }
+    if(now - nextCall < 0x80000000UL)
+    {
+      if(ringsLeft == 0) { ringsLeft = 3; }
+      nextCall += --ringsLeft ? 3000UL : 420000UL - 6000UL;
+      sentAt = now;
+      modem.ring();
+      sentRings += 1;
+      inFlight += uploading;
+    }
+    GSM.poll();
+  }
+  while(GSM.poll()) {}
+
+  printf("%d SMS and %d RINGs sent, %d of them while an upload was in flight\n", sentSMS, sentRings, inFlight);
+  printf("handlers got %d SMS and %d RINGs, %lu ms after they were sent at most, %.1f ms on average\n", sms, rings,
+         longest, sms + rings ? (double)latency / (sms + rings) : 0.0);
+  printf("%d uploads, %d failed\n", uploaded, failed);
+  if(sms != sentSMS || rings != sentRings || failed || lastIndex != modem.stored) { errors += 1; }
+
+  //----- asking the module against answering from what poll() saw
+  GSM.onEvent(GSM_EVENT_SMS, 0);
+  GSM.onEvent(GSM_EVENT_RING, 0);
+  GSM.deleteSMS(1);                                                            // the count is not known then
+  unsigned long t = millis();
+  int asked = GSM.numberofSMS();
+  unsigned long askedTime = millis() - t;
+  modem.incomingSMS();
+  delay(200);
+  t = millis();
+  int counted = GSM.numberofSMS();
+  unsigned long countedTime = millis() - t;
+  printf("numberofSMS  asking the module %4lu ms (%d SMS), counting \"+CMTI:\" %4lu ms (%d SMS, module %d)\n",
+         askedTime, asked, countedTime, counted, modem.stored);
+  if(asked + 1 != counted || counted != modem.stored) { errors += 1; }
+
+  t = millis();
+  int waited = GSM.RingStatus();
+  unsigned long waitedTime = millis() - t;
+  modem.ring();
+  delay(100);
+  t = millis();
+  int rang = GSM.RingStatus();
+  unsigned long rangTime = millis() - t;
+  printf("RingStatus   no call, waiting   %4lu ms (%d),     after a RING     %4lu ms (%d)\n", waitedTime, waited,
+         rangTime, rang);
+  if(waited != 0 || rang != 1) { errors += 1; }
+
+  //----- blocking calls from handlers during a blocking call
+  GSM.onEvent(GSM_EVENT_SMS, ReadNow);
+  GSM.queueCommand("AT+CSQ", 1, 1000, Queued);
+  modem.incomingSMS();
+  unsigned long requests = modem.requests;
+  int got = GSM.sendHTTPGET(server, parameters);
+  int left = GSM.poll();
+  printf("sendHTTPGET  with %d handlers calling readSMS: %d of them read their SMS, upload %s (%lu sent), "
+         "%d commands left\n", nested, nestedRead, got ? "ok" : "failed", modem.requests - requests, left);
+  if(nested != 2 || nestedRead != 2 || !got || modem.requests != requests + 1 || left) { errors += 1; }
+
+  //----- SMS that read like unsolicited messages
+  GSM.onEvent(GSM_EVENT_SMS, NewSMS);
+  GSM.onEvent(GSM_EVENT_RING, Ring);
+  sms = rings = 0;
+  modem.text = "RING";
+  int read = GSM.readSMS(1) && strstr(GSM.GSM_string, "\r\nRING\r\n");
+  modem.text = "+CMTI: \"SM\",20";
+  read += GSM.readSMS(1) && strstr(GSM.GSM_string, "+CMTI:");
+  while(GSM.poll()) {}
+  t = millis();
+  counted = GSM.numberofSMS();
+  countedTime = millis() - t;
+  printf("SMS reading RING and +CMTI: %d of 2 kept in GSM_string, %d RINGs and %d SMS reported, "
+         "numberofSMS then %lu ms (%d SMS, module %d)\n", read, rings, sms, countedTime, counted, modem.stored);
+  if(read != 2 || rings || sms || countedTime == 0 || counted != modem.stored) { errors += 1; }
+
+  printf("%lu characters lost from the receive buffer\n", Serial.charactersLost());
+  return errors != 0;
+}
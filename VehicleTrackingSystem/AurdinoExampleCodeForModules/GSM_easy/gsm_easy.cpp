@@ -16,11 +16,26 @@ WARNING: Incorrect or inappropriate programming of the mobile module can lead to
 
 #include "pins_arduino.h"
 #include <GSM_easy.h>
+#include "gsm_reactions.h"
 
 GSM_easyClass GSM;
 
 int state = 0;
 
+// phases of the command in flight
+#define GSM_IDLE        0                                                       // none in flight
+#define GSM_PAUSING     1                                                       // before sending it again, see "retries"
+#define GSM_SENDING     2
+#define GSM_WAITING     3                                                       // for the first character of the reaction
+#define GSM_READING     4                                                       // the reaction, until GSM_IDLE_GAP ms without a character
+
+// free space in the transmit buffer of the serial line; older cores can't tell, Serial.write waits there
+#if ARDUINO >= 10606
+#define SERIAL_ROOM()   Serial.availableForWrite()
+#else
+#define SERIAL_ROOM()   0x7FFF
+#endif
+
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
 Setting of the used signals / Contacts between Arduino mainboard and the GSM-easy! - Shield
 */
@@ -30,6 +45,18 @@ void GSM_easyClass::begin()
   pinMode(EMERG, OUTPUT);                                                       // pin EMERG_OFF on the M95 (ATTENTION: signal inverted!)
   pinMode(GSM_ON, OUTPUT);                                                      // enable GSM-easy! - Shield (activ high)
   // pinMode(TESTPIN, OUTPUT);                                                  // only if you want to test something
+
+  first = 0;                                                                    // empty AT command queue
+  pending = 0;
+  phase = GSM_IDLE;
+
+  urcLength = 0;                                                                // nothing known of the module yet
+  eventCount = 0;
+  ringing = 0;
+  smsCount = -1;
+  registration = 255;
+  keepAlive = 0;
+  connected = 0;
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -75,14 +102,12 @@ int GSM_easyClass::initialize(char simpin[4])
   {
     if(state == 0)
     {
-      Serial.print("AT\r");                                                     // send the first "AT"      
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
+      if(Command(1, 1000, "AT\r") == 1) { state += 1; } else { state = 1000; }  // send the first "AT", need OK
     }
 
     if(state == 1)
     {
-		Serial.print("ATE0\r");                                                   // disable Echo   
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
+      if(Command(1, 1000, "ATE0\r") == 1) { state += 1; } else { state = 1000; }  // disable Echo
     }
 
     if(state == 2)
@@ -113,30 +138,24 @@ int GSM_easyClass::initialize(char simpin[4])
 
     if(state == 4)
     {
-		Serial.print("AT+CPIN=");                                                 // enter pin (SIM)     
-      Serial.print(simpin);
-      Serial.print("\r");
-	   if(WaitOfReaction(1000) == 3) { state += 1; } else { state = 1000; } 
+	   if(Command(3, 1000, "AT+CPIN=", simpin, "\r") == 3) { state += 1; } else { state = 1000; }  // enter pin (SIM)
     }
 
     if(state == 5)
     {
-      Serial.print("AT+IPR=9600\r");                                            // set Baudrate
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
+      if(Command(1, 1000, "AT+IPR=9600\r") == 1) { state += 1; } else { state = 1000; }  // set Baudrate
     }
 
     if(state == 6)
     {
-		Serial.print("AT+QIURC=0\r");                                             // disable initial URC presentation   
   		time = 0;  
-		if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
+      if(Command(1, 1000, "AT+QIURC=0\r") == 1) { state += 1; } else { state = 1000; }  // disable initial URC presentation
     }
 
     if(state == 7)
     {
       delay(2000);                                                                                              
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report      
-      if(WaitOfReaction(1000) == 4) 																		
+      if(Command(4, 1000, "AT+CREG?\r") == 4)                                   // Network Registration Report
 	   { 
 	     state += 1; 																			     // get: Registered in home network or roaming
 	   } 
@@ -186,32 +205,28 @@ int GSM_easyClass::Status()
   {            
     if(state == 0)
     {
-      Serial.print("AT+CREG?\r");                                               // Query register state of GSM network
-      WaitOfReaction(1000);
+      Command(GSM_ANY, 1000, "AT+CREG?\r");                                     // Query register state of GSM network
 		strcpy(Status_string, GSM_string);
 		state += 1; 
 	 }
     
     if(state == 1)
     {
-      Serial.print("AT+CGREG?\r");                                              // Query register state of GPRS network
-      WaitOfReaction(1000);
+      Command(GSM_ANY, 1000, "AT+CGREG?\r");                                    // Query register state of GPRS network
 		strcat(Status_string, GSM_string);
 		state += 1; 
 	 }
 
     if(state == 2)
     {
-      Serial.print("AT+CSQ\r");                                                 // Query the RF signal strength
-      WaitOfReaction(1000);
+      Command(GSM_ANY, 1000, "AT+CSQ\r");                                       // Query the RF signal strength
 		strcat(Status_string, GSM_string);
 		state += 1; 
 	 }
 	 
     if(state == 3)
     {
-      Serial.print("AT+COPS?\r");                                               // Query the current selected operator
-      WaitOfReaction(1000);
+      Command(GSM_ANY, 1000, "AT+COPS?\r");                                     // Query the current selected operator
 		strcat(Status_string, GSM_string);
 		state += 1; 
 	 }
@@ -230,6 +245,9 @@ int GSM_easyClass::Status()
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
 Detect if there is an incoming call
 
+A "RING" that came in the last GSM_RING_TIME (5) seconds, e.g. during another function or while "poll" ran in 
+"loop()", is reported at once; without one wait 5 seconds for it. Each "RING" is reported once.
+
 Return value = 0 ---> there was no incoming call in the last 5 seconds 
 Return value = 1 ---> there is a RING currently
 The public variable "GSM_string" contains the last response from the mobile module
@@ -241,8 +259,15 @@ int GSM_easyClass::RingStatus()
   {            
     if(state == 0)
     {
-      if(WaitOfReaction(5000) == 11)                                            // 11 = "RING" detected
-		{ return 1; }                                                             // Congratulations ... ME rings
+      poll();                                                                   // take in what came meanwhile
+      if(!ringing || millis() - ringAt >= GSM_RING_TIME)
+      {
+        unsigned long start = millis();
+        ringing = 0;
+        while(!ringing && millis() - start < 5000) { poll(); }                  // "Unsolicited" looks for "RING"
+      }
+      if(ringing)
+		{ ringing = 0; return 1; }                                                // Congratulations ... ME rings
 		else 
 		{ return 0; }                                                             // "no one ever calls!" 
     } 
@@ -255,28 +280,17 @@ int GSM_easyClass::RingStatus()
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
 "Pick-up the phone" = Accept Voicecall 
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::pickUp()
+int GSM_easyClass::pickUp(GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("ATA\r");                                                    // Answers an incoming call
-      if(WaitOfReaction(1000) == 1) 
-		{ return 1; }                                                             // Congratulations ... you are through
-		else 
-		{ return 0; }                                                             // ERROR
-    
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR
+  if(!Chain(1, done)) { return 0; }
+  Queue(1, 1000, "ATA\r");                                                      // Answers an incoming call, need OK
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -286,48 +300,20 @@ Parameter:
 char number[50] = Call number of the addressee (national or international format)
 char text[180] = Text of the SMS (ASCII-Text)
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::sendSMS(char number[50], char text[180])
+int GSM_easyClass::sendSMS(char number[50], char text[180], GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report
-      if(WaitOfReaction(1000) == 4) { state += 1; } else { state = 1000; } 
-	 }
-    
-    if(state == 1)
-    {	
-      Serial.print("AT+CMGF=1\r");                                              // use text-format for SMS        
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
-    }
-    
-    if(state == 2)
-    {
-      Serial.print("AT+CMGS=\"");                                               // send Message
-      Serial.print(number);
-		Serial.print("\"\r");
-      if(WaitOfReaction(5000) == 5) { state += 1; } else { state = 1000; } 	  // get the prompt ">"
-    }
-      
-    if(state == 3)
-    {
-      Serial.print(text);                                                       // Message-Text
-      Serial.write(26);                                                         // CTRL-Z 
-      if(WaitOfReaction(5000) == 1) 
-		{ return 1; }                                                             // Congratulations ... the SMS is gone
-		else 
-		{ return 0; }                                                             // ERROR while sending a SMS 
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while sending a SMS
+  if(!Chain(4, done)) { return 0; }
+  Queue(4, 1000, "AT+CREG?\r");                                                 // Network Registration Report
+  Queue(1, 1000, "AT+CMGF=1\r");                                                // use text-format for SMS
+  Queue(5, 5000, "AT+CMGS=\"", number, "\"\r");                                 // send Message, get the prompt ">"
+  Queue(1, 5000, text, "\x1a");                                                 // Message-Text and CTRL-Z, need OK when the SMS is gone
+  return Run(done);
 }
  
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -336,6 +322,9 @@ Determine number of SMS stored on the SIM card
 ATTENTION: The return value contains the "total number" of stored SMS! The index of the most recent SMS 
 			  is possibly higher, if SMS in the "lower" part from the list have already been deleted!
 
+Only the first call asks the mobile module, after that the number is counted on with each "+CMTI:" (new SMS) 
+until "deleteSMS" is called. If SMS are deleted another way, e.g. with "queueCommand", call "deleteSMS" too.
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module			
@@ -349,8 +338,9 @@ int GSM_easyClass::numberofSMS()
   {            
     if(state == 0)
     {
-      Serial.print("AT+CPMS?\r");                                               // Preferred SMS message storage
-      if(WaitOfReaction(1000) == 13) { state += 1; } else { state = 1000; } 
+      poll();                                                                   // take in the "+CMTI:" that came meanwhile
+      if(smsCount >= 0) { return smsCount; }                                    // known already
+      if(Command(13, 1000, "AT+CPMS?\r") == 13) { state += 1; } else { state = 1000; }  // Preferred SMS message storage
 	 }
     
     if(state == 1)
@@ -361,6 +351,7 @@ int GSM_easyClass::numberofSMS()
       char* s = strtok(GSM_string, ",");
       s = strtok(NULL, ",");
 		numberofSMS = atoi(s);
+		smsCount = numberofSMS;
 
 		return numberofSMS;
     } 
@@ -377,49 +368,28 @@ Parameter "index" = 1 .. n  --->  write SMS with the indicated index in the stri
 
 ATTENTION: Please note length of "GSM_string" - adjust if necessary
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured  
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::readSMS(int index)
+int GSM_easyClass::readSMS(int index, GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report
-      if(WaitOfReaction(1000) == 4) { state += 1; } else { state = 1000; } 
-	 }
-    
-    if(state == 1)
-    {	
-      Serial.print("AT+CMGF=1\r");                                              // use text-format for SMS        
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
-    }
- 
-    if(state == 2)
-    {	
-		if (index == 0)
-		{
-		  Serial.print("AT+CMGL=\"ALL\"\r");                                      // read *all* SMS messages      
-		}
-		else
-		{
-        Serial.print("AT+CMGR=");                                               // read SMS message (page 88)      
-        Serial.print(index);														    		  // index range = 1 ... x
-        Serial.print("\r");
-		}  
-      if(WaitOfReaction(1000) == 1) 
-      // the SMS message is in "GSM_string" now
-		{ return 1; }                                                             // Congratulations ... the SMS with the given index is read
-		else 
-		{ return 0; }                                                             // ERROR while reading a SMS 
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while reading a SMS
+  if(!Chain(3, done)) { return 0; }
+  Queue(4, 1000, "AT+CREG?\r");                                                 // Network Registration Report
+  Queue(1, 1000, "AT+CMGF=1\r");                                                // use text-format for SMS
+  if (index == 0)
+  {
+    Queue(1, 1000, "AT+CMGL=\"ALL\"\r")->quotes = 1;                            // read *all* SMS messages, their text ends with the silence
+  }
+  else
+  {
+    GSM_command *command = Queue(1, 1000, "AT+CMGR=", GSM_NUMBER, "\r");       // read SMS message (page 88), index range = 1 ... x
+    itoa(index, command->number, 10);
+    command->quotes = 1;                                                        // its text ends with the silence
+  }
+  return Run(done);                                                             // the SMS message is in "GSM_string" then
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -431,48 +401,27 @@ ATTENTION: Potential risk!
            If single SMS are deleted, the highest index (= index of the latest SMS) possibly does not correspond anymore 
 	        with the number of the in total stored SMS
 			
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::deleteSMS(int index)
+int GSM_easyClass::deleteSMS(int index, GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report
-      if(WaitOfReaction(1000) == 4) { state += 1; } else { state = 1000; } 
-	 }
-    
-    if(state == 1)
-    {	
-      Serial.print("AT+CMGF=1\r");                                              // use text-format for SMS        
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
-    }
- 
-    if(state == 2)
-    {	
-		if (index == 0)
-		{
-		  Serial.print("AT+CMGD=1,4\r");                                          // Ignore the value of index and delete *all* SMS messages      
-		}
-		else
-		{
-        Serial.print("AT+CMGD=");                                               // delete the SMS with the given index (page 84)      
-        Serial.print(index);														    		  // index range = 1 ... x
-        Serial.print("\r");
-		}  
-      if(WaitOfReaction(1000) == 1) 
-		{ return 1; }                                                             // Congratulations ... the SMS is/are deleted
-		else 
-		{ return 0; }                                                             // ERROR while deleting a SMS 
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while deleting a SMS
+  if(!Chain(3, done)) { return 0; }
+  smsCount = -1;                                                                // "numberofSMS" must ask again
+  Queue(4, 1000, "AT+CREG?\r");                                                 // Network Registration Report
+  Queue(1, 1000, "AT+CMGF=1\r");                                                // use text-format for SMS
+  if (index == 0)
+  {
+    Queue(1, 1000, "AT+CMGD=1,4\r");                                            // Ignore the value of index and delete *all* SMS messages
+  }
+  else
+  {
+    itoa(index, Queue(1, 1000, "AT+CMGD=", GSM_NUMBER, "\r")->number, 10);      // delete the SMS with the given index (page 84)
+  }
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -484,48 +433,20 @@ char number[50] = Call number of the recipient (national or international format
 ATTENTION: The SIM card must be suited or enabled for "Voice". Not all SIM cards 
 		     (for example M2M "machine-to-machine" SIM cards) are automatically enabled!!!        
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::dialCall(char number[50])
+int GSM_easyClass::dialCall(char number[50], GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report
-      if(WaitOfReaction(1000) == 4) { state += 1; } else { state = 1000; } 
-	 }
-    
-    if(state == 1)
-    {
-      Serial.print("AT+COLP=1\r");                                              // Connected line identification presentation
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; } 
-	 }
-	 
-    if(state == 2)
-    {	
-      Serial.print("ATD ");                                                     // dial number
-      Serial.print(number);
-      Serial.print(";\r");
-      WaitOfReaction(30000);
-		state += 1; 
-    } 
-
-    if(state == 3)
-    {	
-      Serial.print("AT+CLCC\r");                                                // List current calls of ME
-      if(WaitOfReaction(1000) == 1)       
-		{ return 1; }                                                             // Congratulations ... 
-		else 
-		{ return 0; }                                                             // ERROR
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while dialing
+  if(!Chain(4, done)) { return 0; }
+  Queue(4, 1000, "AT+CREG?\r");                                                 // Network Registration Report
+  Queue(1, 1000, "AT+COLP=1\r");                                                // Connected line identification presentation
+  Queue(GSM_ANY, 30000, "ATD ", number, ";\r");                                 // dial number
+  Queue(1, 1000, "AT+CLCC\r");                                                  // List current calls of ME
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -533,55 +454,35 @@ Send a DTMF-tone
 Parameter:
 char dtmf = ASCII characters 0-9, #, *, A-D
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::sendDTMF(char dtmf)										              // See "M95_AT_Commands_V1.0.pdf", page 71 ff., Chapter 3.2.39
+int GSM_easyClass::sendDTMF(char dtmf, GSM_handler done)                                     // See "M95_AT_Commands_V1.0.pdf", page 71 ff., Chapter 3.2.39
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("AT+VTS=");                                                  // send a DTMF tone/string
-      Serial.print(dtmf);
-      Serial.print("\r");
-      if(WaitOfReaction(2000) == 1) 
-		{ return 1; }                                                             // OK
-		else 
-		{ return 0; }                                                             // ERROR while sending a DTMF tone
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while sending a DTMF tone
+  if(!Chain(1, done)) { return 0; }
+  GSM_command *command = Queue(1, 2000, "AT+VTS=", GSM_NUMBER, "\r");           // send a DTMF tone/string
+  command->number[0] = dtmf;
+  command->number[1] = 0;
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
 End Voicecall 
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::exitCall()
+int GSM_easyClass::exitCall(GSM_handler done)
 {
-  state = 0;
-  do    
-  {            
-    if(state == 0)
-    {
-      Serial.print("ATH\r");                                               	  // Hang up!
-      if(WaitOfReaction(2000) == 1) 
-		{ return 1; }                                                             // OK
-		else 
-		{ return 0; }                                                             // ERROR while sending a ATH 
-    } 
-  }  
-  while(state <= 999);
-  
-  return 0;                                                                     // ERROR while sending a ATH
+  if(!Chain(1, done)) { return 0; }
+  Queue(1, 2000, "ATH\r");                                                      // Hang up!
+  return Run(done);
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -603,83 +504,22 @@ ATTENTION: This SIM card data is provider-dependent and can be obtained from the
 ATTENTION: The SIM card must be suitable or enabled for GPRS data transmission. Not all SIM cards
 			  (as for example very inexpensive SIM cards) are automatically enabled!!!        
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value  = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::connectGPRS(char APN[50], char USER[30], char PWD[50])
+int GSM_easyClass::connectGPRS(char APN[50], char USER[30], char PWD[50], GSM_handler done)
 {
-  int time = 0;
-  
-  state = 0;
-  do
-  {
-    if(state == 0)
-	 {
-      Serial.print("AT+CREG?\r");                                               // Network Registration Report
-      if(WaitOfReaction(1000) == 4) { state += 1; } else { state = 1000; }      // need 0,1 or 0,5
-	 }
-
-    if(state == 1)                                                              // Judge network?
-    {
-      Serial.print("AT+CGATT?\r");                                              // attach to GPRS service?      
-      if(WaitOfReaction(1000) == 7) 														  // need +CGATT: 1			
-	   { 
-	     state += 1; 																			     // get: attach
-	   } 
-	   else 
-	   { 
-	     delay(2000);
-		  if(time++ < 30)																		  	   
-		  {
-		    state = state;																	     // stay in this state until timeout
-		  }
-		  else
-		  {
-		    state = 1000;																		     // after 60 sek. (30 x 2000 ms) not attach	
-		  } 
-      }
-	 } 
-
-    if(state == 2)
-    {
-      Serial.print("AT+QISTAT\r");                                              // Query current connection status
-      if(WaitOfReaction(1000) == 8) { state += 1; } else { state = 1000; }      // need STATE: IP INITIAL 
-    }
-    
-    if(state == 3)
-    {
-      Serial.print("AT+QICSGP=1,\"");				    								     // Select GPRS as the bearer
-      Serial.print(APN);
-		Serial.print("\",\"");
-		Serial.print(USER);
-		Serial.print("\",\"");
-		Serial.print(PWD);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 4)
-    {
-      Serial.print("AT+QIDNSIP=1\r");                                           // Connect via domain name (not via IP address!)
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 5)
-    {
-      Serial.print("AT+QISTAT\r");                                              // Query current connection status
-      if(WaitOfReaction(1000) == 8) { state += 1; } else { state = 1000; }      // need STATE: IP INITIAL, IP STATUS or IP CLOSE
-    }
-
-    if(state == 6)
-    {
-      return 1;																					  // GPRS connect successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... no GPRS connect
+  if(!Chain(6, done)) { return 0; }
+  Queue(4, 1000, "AT+CREG?\r");                                                 // Network Registration Report, need 0,1 or 0,5
+  Queue(7, 1000, "AT+CGATT?\r")->retries = 30;                                  // attach to GPRS service?, need +CGATT: 1, asked again every 2 s for 60 s
+  Queue(8, 1000, "AT+QISTAT\r");                                                // Query current connection status, need STATE: IP INITIAL
+  Queue(1, 1000, "AT+QICSGP=1,\"", APN, "\",\"", USER, "\",\"", PWD, "\"\r");      // Select GPRS as the bearer, need OK
+  Queue(1, 1000, "AT+QIDNSIP=1\r");                                             // Connect via domain name (not via IP address!), need OK
+  Queue(8, 1000, "AT+QISTAT\r");                                                // Query current connection status, need STATE: IP INITIAL, IP STATUS or IP CLOSE
+  return Run(done);                                                             // GPRS connect successfully ... let's go ahead!
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -706,67 +546,87 @@ On the server the URL of the PHP script "responder.php" is accepted and analysed
 The part after the "?" corresponds to the transmitted parameters. ATTENTION: The parameters must not 
 contain spaces. The source code of the PHP script "responder.php" is located in the documentation. 
 
+After "HTTPkeepAlive(1)" the TCP connection is kept for the next HTTP GET, see there.
+
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::sendHTTPGET(char server[50], char parameter_string[200])
+int GSM_easyClass::sendHTTPGET(char server[50], char parameter_string[200], GSM_handler done)
 {
-  int time = 0;
-  
-  state = 0;
-  do
+  if(!Chain(keepAlive && connected ? 6 : 5, done)) { return 0; }
+  if(keepAlive && connected)
   {
-    if(state == 0)
-    {
-      Serial.print("AT+QIOPEN=\"TCP\",\"");		    								     // Start up TCP connection
-      Serial.print(server);
-		Serial.print("\",80\r");
-      if(WaitOfReaction(2000) == 1) { state += 1; } else { state = 1000; }      // need OK
-    }
-	 
-    if(state == 1)
-    {
-      if(WaitOfReaction(20000) == 9) { state += 1; } else { state = 1000; }     // need CONNECT OK or ALREADY CONNECT
-    }
+    Queue(9, 1000, "AT+QISTAT\r")->done = Reuse;                                // still STATE: CONNECT OK? then the next two are skipped
+    chaining = 0;
+  }
+  Queue(1, 2000, "AT+QIOPEN=\"TCP\",\"", server, "\",80\r");                    // Start up TCP connection, need OK
+  Queue(9, 20000)->done = Connected;                                            // need CONNECT OK or ALREADY CONNECT
+  Queue(5, 5000, "AT+QISEND\r");                                                // Send data to the remote server, get the prompt ">"
+
+  // for HTTP GET must include: "GET /subdirectory/name.php?test=parameter_to_transmit HTTP/1.1"
+  // for example to use with "www.antrax.de/WebServices/responderlist.html":
+  // "GET /WebServices/responder.php?test=HelloWorld HTTP/1.1"
+  // Header Field Definitions in http://www.w3.org/Protocols/rfc2616/rfc2616-sec14.html
+  // Header Field "User-Agent" MUST be "antrax" when use with portal "WebServices"
+  Queue(10, 20000, parameter_string,                                            // need SEND OK
+        "\r\nHost: ", server,
+        keepAlive ? "\r\nUser-Agent: antrax\r\nConnection: keep-alive\r\n\r\n\x1a"
+                  : "\r\nUser-Agent: antrax\r\nConnection: close\r\n\r\n\x1a");
+  Queue(GSM_ANY, 5000)->quotes = 1;                                             // wait of ack from remote server, its text ends with the silence
+  return Run(done);
+}
 
-    if(state == 2)
-    {
-      Serial.print("AT+QISEND\r");                                              // Send data to the remote server
-      if(WaitOfReaction(5000) == 5) { state += 1; } else { state = 1000; } 	  // get the prompt ">"
-    }
-      
-    if(state == 3)
-    {
-      // for HTTP GET must include: "GET /subdirectory/name.php?test=parameter_to_transmit HTTP/1.1"
-      // for example to use with "www.antrax.de/WebServices/responderlist.html":
-      // "GET /WebServices/responder.php?test=HelloWorld HTTP/1.1"
-		Serial.print(parameter_string);                                           // Message-Text
-      
-      // Header Field Definitions in http://www.w3.org/Protocols/rfc2616/rfc2616-sec14.html
-      Serial.print("\r\nHost: ");                                               // Header Field "Host"
-      Serial.print(server);                                                     
-      Serial.print("\r\nUser-Agent: antrax");                                   // Header Field "User-Agent" (MUST be "antrax" when use with portal "WebServices")
-      Serial.print("\r\nConnection: close\r\n\r\n");                            // Header Field "Connection"
-      Serial.write(26);                                                         // CTRL-Z 
-      if(WaitOfReaction(20000) == 10) { state += 1; } else { state = 1000; }    // Congratulations ... the parameter_string was send to the server
-    } 
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Keep the TCP connection of "sendHTTPGET" for the next one (on = 1) or close it after each (on = 0, as before)
 
-    if(state == 4)
-    {
-      WaitOfReaction(5000);                                                     // wait of ack from remote server
-		state += 1;
-    }
-	 
-    if(state == 5)
-    {
-      return 1;																					  // GPRS connect successfully ... let's go ahead!
-    }
+With "on" the HTTP GETs ask the server with "Connection: keep-alive" to keep the connection open. The next 
+"sendHTTPGET" only checks it with "AT+QISTAT" and sends its request right away, without "AT+QIOPEN" and waiting 
+for "CONNECT OK", which takes a few seconds each time. If the server closed the connection meanwhile ("CLOSED", 
+see "onEvent") or the module has lost it, it is opened again then.
 
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... no GPRS connect
+ATTENTION: The connection is kept for the server it was opened to, so use "HTTPclose" before sending to another 
+           one. Servers close idle connections after their own timeout, which the next HTTP GET will notice.
+*/
+void GSM_easyClass::HTTPkeepAlive(int on)
+{
+  keepAlive = on;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Close the TCP connection kept by "HTTPkeepAlive"
+
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
+Return value = 0 ---> Error occured (also if there was no connection)
+Return value = 1 ---> OK
+The public variable "GSM_string" contains the last response from the mobile module
+*/
+int GSM_easyClass::HTTPclose(GSM_handler done)
+{
+  if(!Chain(1, done)) { return 0; }
+  connected = 0;
+  Queue(1, 2000, "AT+QICLOSE\r");                                               // close the TCP connection, need CLOSE OK
+  return Run(done);
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Handlers of the commands of "sendHTTPGET": the TCP connection is up ("CONNECT OK"), and "AT+QISTAT" found it still 
+up, so "AT+QIOPEN" and the wait for "CONNECT OK" queued behind it are not needed
+*/
+void GSM_easyClass::Connected(int ok)
+{
+  GSM.connected = ok;
+}
+
+void GSM_easyClass::Reuse(int ok)
+{
+  GSM.connected = ok;
+  if(!ok) { return; }                                                           // open it again
+  GSM.first = (GSM.first + 2) % GSM_QUEUE_SIZE;
+  GSM.pending -= 2;
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -782,38 +642,18 @@ ATTENTION: Before using this function a GPRS connection must be set up.
 
 For testing, a well-to-reach server can be specified, e.g. "www.google.com"
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::sendPING(char server[50], int timeout)
+int GSM_easyClass::sendPING(char server[50], int timeout, GSM_handler done)
 {
-  int time = 0;
-  
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QPING=\"");		    			          					     // send a Ping
-      Serial.print(server);
-		Serial.print("\",");
-		Serial.print(timeout);
-		Serial.print(",1\r");
-      if(WaitOfReaction(2000) == 1) { state += 1; } else { state = 1000; }      // need OK
-	 }                                                                            
-
-    if(state == 1)
-    {
-      if(WaitOfReaction(20000) == 12) 														  // wait of "+QPING:"
-		{ return 1; }                                                             // OK
-		else 
-		{ return 0; }
-	 }                                                                            
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... 
+  if(!Chain(2, done)) { return 0; }
+  itoa(timeout, Queue(1, 2000, "AT+QPING=\"", server, "\",", GSM_NUMBER, ",1\r")->number, 10);  // send a Ping, need OK
+  Queue(12, 20000);                                                             // wait of "+QPING:"
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -823,21 +663,17 @@ ATTENTION: The frequent disconnection and rebuilding of GPRS connections can lea
 		 	  (e.g. due to "rounding up costs"). It is necessary to consider whether a GPRS connection for a longer time period 
 			  (without data transmission) shall remain active! 
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 No return value 
 The public variable "GSM_string" contains the last response from the mobile module
 */
-void GSM_easyClass::disconnectGPRS()
+void GSM_easyClass::disconnectGPRS(GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QIDEACT\r");                                             // Deactivate GPRS context
-      if(WaitOfReaction(10000) == 1) { state += 1; } else { state = 1000; }     // ein OK wre schn ...
-    }
-  }
-  while(state <= 999);  
+  if(!Chain(1, done)) { return; }
+  connected = 0;
+  Queue(1, 10000, "AT+QIDEACT\r");                                              // Deactivate GPRS context, ein OK wre schn ...
+  Run(done);
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -858,56 +694,20 @@ All figures above are identic to the figures used for installation of an e-mail
 With this function the listed parameters are transferred to the mobile module, but do not activate any further action,
 such as plausibility or access control, radio transmission, etc.
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::EMAILconfigureSMTP(char SMTP[50], int PORT, char USER[30], char PWD[30])
+int GSM_easyClass::EMAILconfigureSMTP(char SMTP[50], int PORT, char USER[30], char PWD[30], GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-	 {
-      Serial.print("AT+QSMTPCLR\r");                                            // Clear all configurations and contents of the email
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK
-	 }
-
-    if(state == 1)
-    {
-      Serial.print("AT+QSMTPSRV=\"");			    	    								  // Configure SMTP server
-      Serial.print(SMTP);
-		Serial.print("\",");
-		Serial.print(PORT);
-		Serial.print("\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 2)
-    {
-      Serial.print("AT+QSMTPUSER=\"");			    	    								  // Configure USER NAME
-      Serial.print(USER);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 3)
-    {
-      Serial.print("AT+QSMTPPWD=\"");			    	    								  // Configure PASSWORD
-      Serial.print(PWD);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-
-    if(state == 4)
-    {
-      return 1;																					  // Configure SMTP server successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during configure SMTP server
+  if(!Chain(4, done)) { return 0; }
+  Queue(1, 1000, "AT+QSMTPCLR\r");                                              // Clear all configurations and contents of the email
+  itoa(PORT, Queue(1, 1000, "AT+QSMTPSRV=\"", SMTP, "\",", GSM_NUMBER, "\r")->number, 10);  // Configure SMTP server
+  Queue(1, 1000, "AT+QSMTPUSER=\"", USER, "\"\r");                              // Configure USER NAME
+  Queue(1, 1000, "AT+QSMTPPWD=\"", PWD, "\"\r");                                // Configure PASSWORD
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -920,40 +720,18 @@ char SENDEREMAIL[30] = E-mail address of the sender
 With this function the listed parameters are transferred to the mobile module, but do not activate any further action,
 such as plausibility or access control, radio transmission, etc.
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response of the mobile module
 */
-int GSM_easyClass::EMAILconfigureSender(char SENDERNAME[30], char SENDEREMAIL[30])
+int GSM_easyClass::EMAILconfigureSender(char SENDERNAME[30], char SENDEREMAIL[30], GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QSMTPNAME=\"");			    	    								  // Configure senders NAME
-      Serial.print(SENDERNAME);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 1)
-    {
-      Serial.print("AT+QSMTPADDR=\"");			    	    								  // Configure senders EMAIL ADDRESS
-      Serial.print(SENDEREMAIL);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-
-    if(state == 2)
-    {
-      return 1;																					  // Configure sender information successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during configure sender information
+  if(!Chain(2, done)) { return 0; }
+  Queue(1, 1000, "AT+QSMTPNAME=\"", SENDERNAME, "\"\r");                        // Configure senders NAME
+  Queue(1, 1000, "AT+QSMTPADDR=\"", SENDEREMAIL, "\"\r");                       // Configure senders EMAIL ADDRESS
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -966,34 +744,17 @@ char RECIPIENT[30] = E-mail address of the recipient
 With this function the listed parameters are transferred to the mobile module, but do not activate any further action,
 such as plausibility or access control, radio transmission, etc.
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::EMAILrecipients(int TYPE, char RECIPIENT[30])
+int GSM_easyClass::EMAILrecipients(int TYPE, char RECIPIENT[30], GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QSMTPDST=1,");			    	       						     // Add a recipient
-		Serial.print(TYPE);
-		Serial.print(",\"");
-      Serial.print(RECIPIENT);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 1)
-    {
-      return 1;																					  // Configure sender information successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during configure sender information
+  if(!Chain(1, done)) { return 0; }
+  itoa(TYPE, Queue(1, 1000, "AT+QSMTPDST=1,", GSM_NUMBER, ",\"", RECIPIENT, "\"\r")->number, 10);  // Add a recipient
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1017,24 +778,19 @@ int GSM_easyClass::EMAILbody(char TITLE[30], char BODY[200])
   {
     if(state == 0)
     {
-      Serial.print("AT+QSMTPSUB=0,\"");			    	    							  // Configure the title of the email
-      Serial.print(TITLE);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
+      if(Command(1, 1000, "AT+QSMTPSUB=0,\"", TITLE, "\"\r") == 1) { state += 1; } else { state = 1000; }  // Configure the title of the email, need OK
     }
 	 
     if(state == 1)
     {
-      Serial.print("AT+QSMTPBODY=1,10\r");		 	    	    						  // Configure the text of the email
-		if(WaitOfReaction(2000) == 14) { state += 1; } else { state = 1000; }     // wait of OK CONNECT 
+		if(Command(14, 2000, "AT+QSMTPBODY=1,10\r") == 14) { state += 1; } else { state = 1000; }  // Configure the text of the email, wait of OK CONNECT
     }
 
     if(state == 2)
     {
-      Serial.print(BODY);			    	    							                 // send the text of the email to the module memory
+      Command(GSM_ANY, 0, BODY);			    	    							        // send the text of the email to the module memory
       delay(1000);                                                              // 1. part of the escape sequence
-		Serial.print("+++");																		  // 2. part of the escape sequence	
-      if(WaitOfReaction(2000) == 15) { state += 1; } else { state = 1000; }     // need "+QSMTPBODY:" as reaction
+      if(Command(15, 2000, "+++") == 15) { state += 1; } else { state = 1000; }  // 2. part of the escape sequence, need "+QSMTPBODY:" as reaction
       delay(1000);                                                              // 3. part of the escape sequence
     }
 
@@ -1064,35 +820,18 @@ BEFORE sending!
 
 ATTENTION: Before using these functions set up a GPRS connection. 
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::EMAILsend()
+int GSM_easyClass::EMAILsend(GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QSMTPPUT\r");			    	       						     // Send Email!
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-
-    if(state == 1)
-    {
-      if(WaitOfReaction(120000) == 16) { state += 1; } else { state = 1000; }   // wait 120 seconds of "+QSMTPPUT: 0" as reaction
-    }
-
-    if(state == 2)
-    {
-      return 1;																					  // Sending process successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during sending process
+  if(!Chain(2, done)) { return 0; }
+  Queue(1, 1000, "AT+QSMTPPUT\r");                                              // Send Email!, need OK
+  Queue(16, 120000);                                                            // wait 120 seconds of "+QSMTPPUT: 0" as reaction
+  return Run(done);
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1113,55 +852,20 @@ All figures above are identic to the figures used for installation of a FTP prog
 With this function the listed parameters are transferred to the mobile module, but do not activate any further action,
 such as plausibility or access control, radio transmission, etc.
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::FTPopen(char HOST[50], int PORT, char USER[30], char PASS[30])
+int GSM_easyClass::FTPopen(char HOST[50], int PORT, char USER[30], char PASS[30], GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QFTPUSER=\"");			    	    								  // Configure USER NAME
-      Serial.print(USER);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 1)
-    {
-      Serial.print("AT+QFTPPASS=\"");			    	    								  // Configure PASSWORD
-      Serial.print(PASS);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-
-    if(state == 2)
-    {
-      Serial.print("AT+QFTPOPEN=\"");			    	    								  // Configure FTP server
-      Serial.print(HOST);
-		Serial.print("\",");
-		Serial.print(PORT);
-		Serial.print("\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-	 
-    if(state == 3)
-    {
-      if(WaitOfReaction(120000) == 17) { state += 1; } else { state = 1000; }   // wait 120 seconds of "+QFTPOPEN: 0" as reaction
-    }
-
-    if(state == 4)
-    {
-      return 1;																					  // open FTP server successfully ... let's go ahead!
-    }
-
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during opening FTP server
+  if(!Chain(4, done)) { return 0; }
+  Queue(1, 1000, "AT+QFTPUSER=\"", USER, "\"\r");                               // Configure USER NAME
+  Queue(1, 1000, "AT+QFTPPASS=\"", PASS, "\"\r");                               // Configure PASSWORD
+  itoa(PORT, Queue(1, 1000, "AT+QFTPOPEN=\"", HOST, "\",", GSM_NUMBER, "\r")->number, 10);  // Configure FTP server
+  Queue(17, 120000);                                                            // wait 120 seconds of "+QFTPOPEN: 0" as reaction
+  return Run(done);
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1176,59 +880,38 @@ The contents of the file to be downloaded via FTP is written into the variable "
 
 ATTENTION: Please note length "GSM_string" - adjust if necessary
 
-Return value = 0 ---> Error occured 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
+Return value = 0 ---> Error occured (also if the file did not come within 10 seconds)
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::FTPdownload(char PATH[50], char FILENAME[50])
+int GSM_easyClass::FTPdownload(char PATH[50], char FILENAME[50], GSM_handler done)
 {
-  state = 0;
-  do
-  {
-    if(state == 0)
-    {
-      Serial.print("AT+QFTPPATH=\"");			    	    								  // Configure PATH
-      Serial.print(PATH);
-		Serial.print("\"\r");
-      switch (WaitOfReaction(1000))
-		{
-         case 1:  state = state + 1;														  // get only "OK", need also "+QFTPPATH:0"
-         	  		break;
-         case 17: state = state + 2;														  // get "+QFTPPATH:0" ---> that's OK!
-				  		break;	  		
-		   default: state = 1000;
-		   			break;
-		}   			
-    }
-	 
-    if(state == 1)
-    {
-      if(WaitOfReaction(120000) == 17) { state += 1; } else { state = 1000; }   // wait 120 seconds of "+QFTPPATH:0" as reaction
-    }
-	 
-    if(state == 2)
-    {
- 		Serial.print("AT+QFTPGET=\"");			    	    								  // Configure FILENAME
-      Serial.print(FILENAME);
-		Serial.print("\"\r");
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
-    }
-
-    if(state == 3)
-    {
-      WaitOfDownload(10000);                                                    // wait 10 seconds of the content of the file
-		state += 1;                                                               // and of "+QFTPGET:" as reaction
-    }                  
-
-    if(state == 4)
-    {
-      return 1;																					  // downloading file from the server successfully ... let's go ahead!
-    }
+  if(!Chain(4, done)) { return 0; }
+  Queue(GSM_ANY, 1000, "AT+QFTPPATH=\"", PATH, "\"\r")->done = PathSet;        // Configure PATH, need OK or already "+QFTPPATH:0"
+  Queue(17, 120000);                                                            // wait 120 seconds of "+QFTPPATH:0" as reaction
+  Queue(1, 1000, "AT+QFTPGET=\"", FILENAME, "\"\r");                            // Configure FILENAME, need OK
+  Queue(18, 10000)->quotes = 1;                                                 // wait 10 seconds of the content of the file and "+QFTPGET:",
+                                                                                // its text ends with the silence
+  return Run(done);                                                             // the file is in "GSM_string" then
+}
 
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during opening FTP server
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Handler of "AT+QFTPPATH" of "FTPdownload": with "+QFTPPATH:0" already in the reaction the wait for it queued behind 
+is not needed, with neither the download fails at once
+*/
+void GSM_easyClass::PathSet(int)
+{
+  if(GSM.reaction == 17)
+  {
+    GSM.first = (GSM.first + 1) % GSM_QUEUE_SIZE;
+    GSM.pending -= 1;
+  }
+  else if(GSM.reaction != 1)
+  {
+    GSM.Fail();
+  }
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1240,155 +923,482 @@ none
 ATTENTION: If further operations via GPRS need to be processed, don't disconnect the GPRS connection at this point ("AT+QIDEACT"), 
 			  in order to avoid unnecessary costs!
 
+GSM_handler done = 0 ---> wait for the result; otherwise only queue the commands and pass the result to "done" (see "poll")
+
 Return value = 0 ---> Error occured 
 Return value = 1 ---> OK
 The public variable "GSM_string" contains the last response from the mobile module
 */
-int GSM_easyClass::FTPclose()
+int GSM_easyClass::FTPclose(GSM_handler done)
 {
-  state = 0;
-  do
+  if(!Chain(3, done)) { return 0; }
+  Queue(1, 1000, "AT+QFTPCLOSE\r");                                             // close the FTP service
+  Queue(17, 10000);                                                             // wait 10 seconds of "+QFTPCLOSE:0" as reaction
+  Queue(1, 1000, "AT+QIDEACT\r");                                               // deactivate GPRS/CSD context
+  return Run(done);
+}
+
+ 
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+//-- A T   C O M M A N D   E N G I N E ---------------------------------------------------------------------------------------------------------------
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Queue an AT command, it is sent and its reaction awaited by "poll" as soon as the commands before it are done
+
+Parameter:
+const char *command = the command without the final "\r", e.g. "AT+CSQ"; 0 sends nothing and only waits for a reaction
+int expect = reaction wanted (see "Classify"), GSM_ANY for any reaction or none
+unsigned long timeout = time to wait for the first character of the reaction (in milliseconds)
+GSM_handler done = function called with 1 when the reaction was the expected one, with 0 if not; may be 0
+
+ATTENTION: The text of "command" is only read when it is sent and must not change until then. The same goes for the 
+           parameters of all other functions when they are called with a handler "done".
+
+Return value = 0 ---> the queue is full
+Return value = 1 ---> OK
+*/
+int GSM_easyClass::queueCommand(const char *command, int expect, unsigned long timeout, GSM_handler done)
+{
+  if(pending == GSM_QUEUE_SIZE) { return 0; }
+  chaining = 0;
+  Queue(expect, timeout, command, command ? "\r" : 0)->done = done;
+  return 1;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Do whatever is due for the command in flight, without waiting for anything:
+- send as much of it as the transmit buffer of the serial line takes,
+- collect its reaction in "GSM_string",
+- once the reaction is complete (its final result code is in, see "Complete", or no character came for GSM_IDLE_GAP 
+  ms) or has not started in time, analyse it, call the handler of the command and go on with the next one; a 
+  command with "retries" left is sent again GSM_RETRY_PAUSE ms after a reaction that is not the expected one,
+- pass every character received, between the commands too, to "Unsolicited" and call the handlers of the events 
+  it found (see "onEvent").
+
+Call it as often as possible, e.g. once in every run of "loop()". The functions above that are called with a handler 
+"done" only queue their commands and "poll" does the rest; called without one they call "poll" themselves until 
+they are done, so they take as long as before.
+
+Return value = number of commands waiting or in flight
+The public variable "GSM_string" contains the reaction to the current or last command
+*/
+int GSM_easyClass::poll()
+{
+  unsigned long now = millis();
+
+  answered = 0;
+  if(phase == GSM_PAUSING && now - since >= GSM_RETRY_PAUSE) { phase = GSM_IDLE; }   // time to send the command in flight again
+
+  if(phase <= GSM_PAUSING)
   {
-    if(state == 0)
+    if(!pending || commands[first].part[0])                                     // what came before a command that only waits is its reaction
     {
-      Serial.print("AT+QFTPCLOSE\r");			    	       						     // close the FTP service
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
+      while(Serial.available()) { Unsolicited(Serial.read()); }                 // between commands the module only speaks for itself
     }
-	 
-    if(state == 1)
+
+    if(phase == GSM_IDLE && pending)
+    {
+      //----- erase GSM_string for the next command
+      memset(GSM_string, 0, BUFFER_SIZE);
+      received = 0;
+      matchState = GSM_REACTION_START;                                          // the reaction starts a line
+      matchRank = 0;
+      matchLine = 0;
+      lineStart = 0;
+      lineRank = 0;
+      sendPart = 0;
+      sendOffset = 0;
+      phase = GSM_SENDING;
+    }
+  }
+
+  if(phase == GSM_SENDING && Send())                                            // else the rest when the transmit buffer has room again
+  {
+    phase = GSM_WAITING;
+    since = now;
+    sentAt = now;
+  }
+
+  //----- collect the reaction
+  while(phase >= GSM_WAITING && Serial.available())
+  {
+    char c = Serial.read();
+    if(received < BUFFER_SIZE - 1) { GSM_string[received++] = c; }
+    matchState = GSM_reactionStep(matchState, c);                               // recognise the reaction as it comes in
+    byte rank = pgm_read_byte(&GSM_reactionRank[matchState]);
+    if((rank & GSM_REACTION_RANK) && ((rank & GSM_REACTION_RANK) > matchRank || commands[first].quotes))
     {
-      if(WaitOfReaction(10000) == 17) { state += 1; } else { state = 1000; }     // wait 10 seconds of "+QFTPCLOSE:0" as reaction
+      matchRank = rank & GSM_REACTION_RANK;                                     // the strongest text, of one that quotes the last
     }
+    if(rank & GSM_REACTION_LINE) { matchLine = 1; }
+    phase = GSM_READING;
+    since = now;
+    if(Unsolicited(c, commands[first].quotes))                                  // a "RING" in between is not part of the reaction
+    {
+      received = lineStart;
+      memset(GSM_string + received, 0, BUFFER_SIZE - received);
+      matchRank = lineRank;
+      if(strspn(GSM_string, "\r\n") == received) { phase = GSM_WAITING; since = sentAt; }   // nor did it start it
+    }
+    if(c == '\n')
+    {
+      lineStart = received;
+      lineRank = matchRank;
+    }
+#ifndef GSM_IDLE_GAP_ONLY
+    if(((rank & GSM_REACTION_FINAL) || (matchLine && c == '\n')) && Complete())   // the final result code is in
+    {
+      Done(Classify());                                                         // what follows is for "Unsolicited"
+      now = millis();
+    }
+#endif
+  }
 
-    if(state == 2)
+  now = millis();                                                               // a handler called by "Done" may have run commands
+  if(phase == GSM_WAITING && now - since >= commands[first].timeout) { Done(0); }    // no reaction in time
+  now = millis();
+  if(phase == GSM_READING && now - since >= GSM_IDLE_GAP) { Done(Classify()); }
+
+  //----- call the handlers of the unsolicited messages
+  while(eventCount && !answered)                                                // else the next time, "GSM_string" is for the function waiting
+  {
+    GSM_event event = events[eventFirst];
+    eventFirst = (eventFirst + 1) % GSM_EVENTS;
+    eventCount -= 1;
+    if(handlers[event.type]) { handlers[event.type](event.value); }
+  }
+  return pending;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+The reaction to the command in flight has just reached the end of a final result code ("OK", "ERROR", "SEND OK", ...) 
+or of the line of "+CME ERROR:", "+QSMTPPUT: 0", ... (see "gsm_reactions.h"): true if nothing more is to come, so 
+it need not wait for GSM_IDLE_GAP ms of silence.
+
+That is the case when the reaction so far is the expected one or an error. "OK" alone ends the reaction to a 
+command that expects it, but not to "AT+QISTAT" (OK, then STATE: ...) or "AT+QIOPEN" (OK, then CONNECT OK). A 
+command that expects any reaction ends with the first final result code, unless it only waits: then, e.g. for the 
+answer of a server, more may follow and the reaction still ends with the silence. So does the reaction to a command 
+that "quotes" text, e.g. of a SMS or a file: a line of it may be "OK" or "ERROR".
+*/
+bool GSM_easyClass::Complete()
+{
+  GSM_command *command = &commands[first];
+  int number = Classify();
+
+  if(command->quotes) { return false; }
+  if(command->expect == GSM_ANY) { return command->part[0] != 0; }
+  return (number == command->expect) || (number == GSM_REACTION_ERROR);
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Send as much of the command in flight as the transmit buffer of the serial line takes, true once all of it is sent
+*/
+bool GSM_easyClass::Send()
+{
+  GSM_command *command = &commands[first];
+  int room = SERIAL_ROOM();
+
+  while(sendPart < GSM_PARTS && command->part[sendPart])
+  {
+    const char *text = command->part[sendPart] == GSM_NUMBER ? command->number : command->part[sendPart];
+    while(text[sendOffset])
     {
-      Serial.print("AT+QIDEACT\r");			    	       						        // deactivate GPRS/CSD context
-      if(WaitOfReaction(1000) == 1) { state += 1; } else { state = 1000; }      // need OK 
+      if(room-- <= 0) { return false; }
+      Serial.write(text[sendOffset++]);
     }
+    sendPart += 1;
+    sendOffset = 0;
+  }
+  return true;
+}
 
-    if(state == 3)
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+The command in flight got the reaction "result" (0 = none in time): take it from the queue, fail the rest of its 
+operation if the reaction was not the expected one (see "Fail"), then call its handler or tell the blocking 
+function waiting for it (see "Run")
+*/
+void GSM_easyClass::Done(byte result)
+{
+  GSM_command command = commands[first];
+  int         ok = (command.expect == GSM_ANY) || (result == command.expect);
+
+  if(!ok && command.retries)                                                    // ask again a little later
+  {
+    commands[first].retries -= 1;
+    phase = GSM_PAUSING;
+    since = millis();
+    return;
+  }
+  first = (first + 1) % GSM_QUEUE_SIZE;
+  pending -= 1;
+  phase = GSM_IDLE;
+  reaction = result;
+
+  byte waited = (command.result != 0);
+  if(command.result) { *command.result = ok; }
+  if(!ok && Fail()) { waited = 1; }                                             // before the handler, so it finds room in the queue
+  if(command.done) { command.done(ok); }
+  if(waited) { answered = 1; }                                                  // after the handler, its own "poll" resets it
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+The operation of the command just done fails: drop the commands chained to it from the queue, then call their 
+handlers with 0 or tell the blocking function waiting for them. Used by "Done" and by handlers like "PathSet" 
+that find the reaction wrong.
+
+Return value = true  ---> a blocking function was waiting for one of them
+Return value = false ---> none was
+*/
+bool GSM_easyClass::Fail()
+{
+  GSM_handler dropped[GSM_QUEUE_SIZE];
+  byte        drops = 0;
+  bool        waited = false;
+
+  while(pending && commands[first].chained)
+  {
+    if(commands[first].result) { *commands[first].result = 0; waited = true; }
+    dropped[drops++] = commands[first].done;
+    first = (first + 1) % GSM_QUEUE_SIZE;
+    pending -= 1;
+  }
+  for(byte i = 0; i < drops; i++)
+  {
+    if(dropped[i]) { dropped[i](0); }
+  }
+  if(waited) { answered = 1; }
+  return waited;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Call "handler" with the value of each unsolicited message "type" (GSM_EVENT_RING, GSM_EVENT_SMS, ...), 0 = no longer
+
+The handlers are called by "poll", so only when it runs (as well inside the functions above that wait for their 
+result). Up to GSM_EVENTS messages wait for their handler, further ones are lost. A handler may queue commands, 
+e.g. "readSMS(value, done)" for a new SMS.
+
+ATTENTION: The module reports "+CREG:" only after "AT+CREG=1" and "+QIRDI:" only after "AT+QINDI=1", which 
+           "initialize" does not send. "RING", "+CMTI:" and "CLOSED" come without.
+ATTENTION: During a reaction that quotes text (the SMS of "readSMS", the file of "FTPdownload", the answer of the 
+           server to "sendHTTPGET") a line can't be told from an unsolicited message, so none is looked for: a 
+           "RING" or "CLOSED" then stays in "GSM_string" and is not reported, nor is a new SMS, though "numberofSMS" 
+           asks the module the next time. The module repeats "RING"; a lost "CLOSED" is noticed by the next HTTP GET.
+*/
+void GSM_easyClass::onEvent(byte type, GSM_event_handler handler)
+{
+  if(type < GSM_EVENT_TYPES) { handlers[type] = handler; }
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Follow the lines the module sends for its unsolicited messages, character by character: keep what they tell 
+("RingStatus" and "numberofSMS" answer from it) and queue an event for those with a handler.
+
+With "quoted" the line is part of a reaction that quotes text (see "quotes"), e.g. a SMS, a file or the answer of 
+a HTTP server, which may have a line "RING" or "CLOSED" of its own: nothing is done about it, only a "+CMTI:" 
+makes the number of SMS unknown, as it may have been a new one.
+
+Return value = true  ---> "c" ended the line of an unsolicited message, which is not part of a reaction
+Return value = false ---> anything else
+*/
+bool GSM_easyClass::Unsolicited(char c, bool quoted)
+{
+  if(c != '\n')
+  {
+    if(c != '\r' && urcLength < GSM_URC_LINE - 1) { urcLine[urcLength++] = c; }
+    return false;
+  }
+  urcLine[urcLength] = 0;
+  urcLength = 0;
+
+  if(quoted)
+  {
+    if(strncmp(urcLine, "+CMTI:", 6) == 0) { smsCount = -1; }                   // "numberofSMS" asks the module then
+    return false;
+  }
+
+  bool urc = true;
+  if(strcmp(urcLine, "RING") == 0)                                              // incoming call
+  {
+    ringing = 1;
+    ringAt = millis();
+    Event(GSM_EVENT_RING, 0);
+  }
+  else if(strncmp(urcLine, "+CMTI:", 6) == 0)                                   // new SMS, e.g. +CMTI: "SM",4
+  {
+    char *index = strrchr(urcLine, ',');
+    if(smsCount >= 0) { smsCount += 1; }
+    Event(GSM_EVENT_SMS, index ? atoi(index + 1) : 0);
+  }
+  else if(strncmp(urcLine, "+CREG:", 6) == 0)                                   // +CREG: 1 or, answering AT+CREG?, +CREG: 0,1
+  {
+    char *comma = strchr(urcLine, ',');
+    byte stat = atoi(comma ? comma + 1 : urcLine + 6);
+    urc = (comma == 0);
+    if(stat != registration)
     {
-      return 1;																					  // close FTP server successfully ... let's go ahead!
+      registration = stat;
+      Event(GSM_EVENT_REGISTRATION, stat);
     }
+  }
+  else if(strncmp(urcLine, "+QIRDI:", 7) == 0)   { Event(GSM_EVENT_DATA, 0); }   // data received
+  else if(strcmp(urcLine, "CLOSED") == 0 || strstr(urcLine, ", CLOSED"))          // the server closed the connection
+  {
+    connected = 0;
+    Event(GSM_EVENT_CLOSED, 0);
+  }
+  else                                           { urc = false; }
+  return urc;
+}
 
-  } 
-  while(state <= 999);
-  
-  return 0;																							  // ERROR ... during closing FTP server
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Queue an unsolicited message for its handler, if it has one and there is room
+*/
+void GSM_easyClass::Event(byte type, int value)
+{
+  if(!handlers[type] || eventCount == GSM_EVENTS) { return; }
+  GSM_event *event = &events[(eventFirst + eventCount) % GSM_EVENTS];
+  event->type = type;
+  event->value = value;
+  eventCount += 1;
 }
 
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
-Special receive routine of the serial interface for downloads
-Used for receiving files from FTP
+Add a command to the queue, there must be room for it (see "Chain"). A piece of text GSM_NUMBER stands for the 
+"number" of the command, which the caller fills in.
+*/
+GSM_command *GSM_easyClass::Queue(byte expect, unsigned long timeout, const char *a, const char *b, const char *c,
+                                  const char *d, const char *e, const char *f, const char *g)
+{
+  GSM_command *command = &commands[(first + pending) % GSM_QUEUE_SIZE];
+
+  command->part[0] = a;
+  command->part[1] = b;
+  command->part[2] = c;
+  command->part[3] = d;
+  command->part[4] = e;
+  command->part[5] = f;
+  command->part[6] = g;
+  command->number[0] = 0;
+  command->expect = expect;
+  command->chained = chaining;
+  command->timeout = timeout;
+  command->done = 0;
+  command->result = 0;
+  command->retries = 0;
+  command->quotes = 0;
+
+  chaining = 1;
+  pending += 1;
+  return command;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Make room for an operation of "count" commands, each of them chained to the one before. Without a handler "done" 
+wait for the room, with one give up if there is none.
 
-similar to "int GSM_easyClass::WaitOfReaction(int timeout)"
+Return value = 0 ---> the queue is too full
+Return value = 1 ---> OK
 */
-int GSM_easyClass::WaitOfDownload(int timeout)
+int GSM_easyClass::Chain(byte count, GSM_handler done)
 {
-  int  index = 0;
-  int  inByte = 0;
-  char WS[3];
+  if(done && pending + count > GSM_QUEUE_SIZE) { return 0; }
+  while(pending + count > GSM_QUEUE_SIZE) { poll(); }
+  chaining = 0;
+  return 1;
+}
 
-  //----- erase GSM_string
-  memset(GSM_string, 0, BUFFER_SIZE);
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Finish an operation queued after "Chain": with a handler "done" leave it to "poll" and call the handler at its end, 
+without one run it to its end now
 
-  //----- clear Serial Line Buffer
-  Serial.flush();
-  while(Serial.available()) { Serial.read(); }
-  
-  //----- wait of the first character for "timeout" ms
-  Serial.setTimeout(timeout);
-  inByte = Serial.readBytes(WS, 1);
-  GSM_string[index++] = WS[0];
-  
-  //----- wait of further characters until a pause of "timeout" ms occures
-  while(inByte > 0)
+Each blocking function waits for the result of its own last command, so a handler called meanwhile may call one 
+too, e.g. "readSMS(value)" for a new SMS during "sendHTTPGET(server, parameters)": it runs the commands queued 
+before its own first, then its own, and returns; the function it interrupted goes on waiting for its result. 
+"GSM_string" is that of the command done last, which is the nested function's if it ran after the interrupted 
+one's last command; "poll" calls no event handler in the run that ends a wait, so none comes in between.
+
+Return value = 0 ---> Error occured (without "done": one of the commands did not get its reaction)
+Return value = 1 ---> OK
+*/
+int GSM_easyClass::Run(GSM_handler done)
+{
+  GSM_command *last = &commands[(first + pending - 1) % GSM_QUEUE_SIZE];
+
+  if(done)
   {
-    inByte = Serial.readBytes(WS, 1);
-    GSM_string[index++] = WS[0];
-    if((strstr(GSM_string, "+QFTPGET:")) && (WS[0] == '\r'))  { break; }
+    last->done = done;
+    return 1;
   }
 
-  delay(100);
-  return 0;
-}        
- 
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-//----------------------------------------------------------------------------------------------------------------------------------------------------
+  int result = -1;                                                              // on the stack, one for each function waiting
+  last->result = &result;
+  while(result < 0) { poll(); }
+  return result;
+}
+
 /*----------------------------------------------------------------------------------------------------------------------------------------------------
-Central receive routine of the serial interface
+Send a command made of the pieces of text "a" ... "g" and wait for its reaction, all commands queued before 
+it go first; without any text only wait for a reaction. The reaction ends early once it is "expect" (GSM_ANY: any 
+final result code) or an error, see "Complete".
 
-ATTENTION: This function is used by all other functions (see above) and must not be deleted
+Return value = reaction (see "Classify")
+The public variable "GSM_string" contains the last response from the mobile module
+*/
+int GSM_easyClass::Command(byte expect, unsigned long timeout, const char *a, const char *b, const char *c,
+                           const char *d, const char *e, const char *f, const char *g)
+{
+  Chain(1, 0);
+  Queue(expect, timeout, a, b, c, d, e, f, g);
+  Run(0);
+  return reaction;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Central receive routine of the serial interface
 
 Parameter:
-int TIMEOUT = Waiting time to receive the first character (in milliseconds)
+unsigned long timeout = Waiting time to receive the first character (in milliseconds)
 
+Waits for a reaction of the mobile module without sending anything, see "Command" and "Classify"
+*/
+int GSM_easyClass::WaitOfReaction(unsigned long timeout)
+{
+  return Command(GSM_ANY, timeout);
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------------------
+Analyse the reaction of the mobile module
 
-Then contents of the received characters is written to the variable "GSM_string". If no characters is received 
-for 30 milliseconds, the reception is completed and the contents of "GSM_string" is being analysed.
+ATTENTION: This function is used by all other functions (see above) and must not be deleted
+
+"poll" follows every received character with the automaton of "gsm_reactions.h" and keeps the strongest of the 
+texts below found so far, so the reaction is known as soon as its last character is in and nothing is searched 
+again. All of the reaction counts, also what does not fit into "GSM_string"; of a reaction that quotes text, e.g. 
+of a SMS, the last text found counts instead. "OK", "ERROR", "+CME ERROR:" and "+CMS ERROR:" count only at the 
+start of a line. The reception is completed with the 
+final result code the command waits for (see "Complete") or else if no character is received for GSM_IDLE_GAP (30) 
+milliseconds; with GSM_IDLE_GAP_ONLY defined in "gsm_easy.h" only the latter, as in version 4.0.
 
 ATTENTION: The length of the reaction times of the mobile module depend on the condition of the mobile module, for example  
 			  quality of wireless connection, provider, etc. and thus can vary. Please keep this in mind in case this routine is 
 			  is changed.
 
+The texts, strongest first, are in "extras/reaction_gen/reaction_gen.cpp", which writes "gsm_reactions.h":
+"SIM PIN" 2, "READY" 3, "0,1" and "0,5" 4, the prompt ">" 5, "NO CARRIER" 6, "+CGATT: 1" 7, "IP INITIAL", 
+"IP STATUS" and "IP CLOSE" 8, "CONNECT OK" and "ALREADY CONNECT" 9, "SEND OK" 10, "RING" 11, "+QPING:" 12, 
+"+CPMS:" 13, "OK CONNECT" 14, "+QSMTPBODY:" 15, "+QSMTPPUT: 0" 16, "+QFTPGET:" 18, ":0" 17, "+CME ERROR:", 
+"+CMS ERROR:" and "ERROR" 19 (GSM_REACTION_ERROR), "DEACT OK", "CLOSE OK" and "OK" 1
+
 Return value = 0      ---> No known response of the mobile module detected 
-Rckgabewert = 1 - 18 ---> Response detected (see below)
-The public variable "GSM_string" contains the last response from the mobile module
+Rckgabewert = 1 - 19 ---> Response detected (see above)
 */
-int GSM_easyClass::WaitOfReaction(int timeout)
+int GSM_easyClass::Classify()
 {
-  int  index = 0;
-  int  inByte = 0;
-  char WS[3];
-
-  //----- erase GSM_string
-  memset(GSM_string, 0, BUFFER_SIZE);
-  memset(WS, 0, 3);
-
-  //----- clear Serial Line Buffer
-  Serial.flush();
-  while(Serial.available()) { Serial.read(); }
-  
-  //----- wait of the first character for "timeout" ms
-  Serial.setTimeout(timeout);
-  inByte = Serial.readBytes(WS, 1);
-  GSM_string[index++] = WS[0];
-  
-  //----- wait of further characters until a pause of 30 ms occures
-  while(inByte > 0)
-  {
-    Serial.setTimeout(30);
-    inByte = Serial.readBytes(WS, 1);
-    GSM_string[index++] = WS[0];
-  }
-
-  //----- analyse the reaction of the mobile module
-  if(strstr(GSM_string, "SIM PIN\r\n"))	      	{ return 2; }
-  if(strstr(GSM_string, "READY\r\n"))		      	{ return 3; }
-  if(strstr(GSM_string, "0,1\r\n"))						{ return 4; }
-  if(strstr(GSM_string, "0,5\r\n"))						{ return 4; }
-  if(strstr(GSM_string, "\n>"))							{ return 5; }					  // prompt for SMS text
-  if(strstr(GSM_string, "NO CARRIER\r\n"))			{ return 6; }
-  if(strstr(GSM_string, "+CGATT: 1\r\n"))				{ return 7; }
-  if(strstr(GSM_string, "IP INITIAL\r\n"))			{ return 8; }
-  if(strstr(GSM_string, "IP STATUS\r\n"))				{ return 8; }
-  if(strstr(GSM_string, "IP CLOSE\r\n"))				{ return 8; }
-  if(strstr(GSM_string, "CONNECT OK\r\n"))			{ return 9; }
-  if(strstr(GSM_string, "ALREADY CONNECT\r\n"))		{ return 9; }
-  if(strstr(GSM_string, "SEND OK\r\n"))				{ return 10; }
-  if(strstr(GSM_string, "RING\r\n"))					{ return 11; }
-  if(strstr(GSM_string, "+QPING:"))				   	{ return 12; }
-  if(strstr(GSM_string, "+CPMS:"))				   	{ return 13; }
-  if(strstr(GSM_string, "OK\r\n\r\nCONNECT\r\n"))	{ return 14; }
-  if(strstr(GSM_string, "+QSMTPBODY:"))			  	{ return 15; }
-  if(strstr(GSM_string, "+QSMTPPUT: 0"))		    	{ return 16; }
-  if(strstr(GSM_string, ":0\r\n"))		    	      { return 17; }
-  if(strstr(GSM_string, "+QFTPGET:"))		  	      { return 18; }
-
-  if(strstr(GSM_string, "OK\r\n"))						{ return 1; }
-  
-  return 0;
-}        
+  return pgm_read_byte(&GSM_reactionNumber[matchRank]);
+}
+        
       
 //----------------------------------------------------------------------------------------------------------------------------------------------------
 
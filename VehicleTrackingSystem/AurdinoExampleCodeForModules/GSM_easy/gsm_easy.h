@@ -21,6 +21,52 @@ Company:     antrax Datentechnik GmbH
 
 #define BUFFER_SIZE		250
 
+//-------------------------------
+// AT command engine
+#define GSM_QUEUE_SIZE		6       // commands waiting or in flight, the longest operation needs 6
+#define GSM_PARTS		7       // pieces of text per command
+#define GSM_ANY			255     // expect: any reaction, or none, will do
+#define GSM_NUMBER		((const char *)1)   // piece of text: the command's own number
+#define GSM_IDLE_GAP		30      // ms of silence that end a reaction
+#define GSM_RETRY_PAUSE		2000    // ms before a command with "retries" left is sent again
+//#define GSM_IDLE_GAP_ONLY             // end reactions only by silence, not by their final result code
+
+//-------------------------------
+// unsolicited messages of the mobile module (URC), see "onEvent"
+#define GSM_EVENT_RING		0       // "RING", value 0
+#define GSM_EVENT_SMS		1       // "+CMTI:", value = index of the new SMS
+#define GSM_EVENT_REGISTRATION	2       // "+CREG:" with a new state, value = state (1 = home network, 5 = roaming)
+#define GSM_EVENT_DATA		3       // "+QIRDI:", TCP data to read, value 0
+#define GSM_EVENT_CLOSED	4       // "CLOSED", the server closed the TCP connection, value 0
+#define GSM_EVENT_TYPES		5
+#define GSM_EVENTS		4       // events waiting for their handler
+#define GSM_URC_LINE		24      // characters of a line kept to recognise it
+#define GSM_RING_TIME		5000    // ms a "RING" counts as current, the module repeats it while the phone rings
+
+typedef void (*GSM_handler)(int ok);
+typedef void (*GSM_event_handler)(int value);
+
+// one unsolicited message waiting for its handler
+struct GSM_event
+{
+  byte          type;              // GSM_EVENT_...
+  int           value;
+};
+
+// one AT command of the engine's queue
+struct GSM_command
+{
+  const char    *part[GSM_PARTS];  // sent one after the other, unused ones 0; none at all = only wait
+  char          number[7];         // text sent for GSM_NUMBER
+  byte          expect;            // reaction wanted (see WaitOfReaction) or GSM_ANY
+  byte          chained;           // dropped if the command before it did not get its reaction
+  unsigned long timeout;           // ms to wait for the first character of the reaction
+  GSM_handler   done;              // called with 1 if the reaction was the expected one, 0 if not
+  int           *result;           // set to the same by "Done" for the blocking function waiting for it, or 0
+  byte          retries;           // times it is sent again after a reaction that is not the expected one
+  byte          quotes;            // its reaction quotes text (SMS, file, HTTP): only silence ends it, the last text found counts
+};
+
 //------------------------------------------------------------------------------
 
 class GSM_easyClass
@@ -29,39 +75,97 @@ class GSM_easyClass
       // Variables
       char GSM_string[250];
       
-      // Functions
+      // Functions; with a handler "done" they only queue their commands for "poll", without one they wait for
+      // their result. These always wait: initialize (6 s, up to 80 s without SIM or network), Status (4 commands),
+      // RingStatus (up to 5 s), numberofSMS (1 command, none once "+CMTI:" has been counted) and EMAILbody (2 s)
       void begin();
 		int  initialize(char simpin[4]);
 		int  Status();
 		int  RingStatus();
-		int  pickUp();
+		int  pickUp(GSM_handler done = 0);
       
 		int  numberofSMS();
-		int  readSMS(int index);
-		int  deleteSMS(int index);
-		int  sendSMS(char number[50], char text[180]);
+		int  readSMS(int index, GSM_handler done = 0);
+		int  deleteSMS(int index, GSM_handler done = 0);
+		int  sendSMS(char number[50], char text[180], GSM_handler done = 0);
       
-      int  dialCall(char number[50]);
-      int  sendDTMF(char dtmf);
-      int  exitCall();
+      int  dialCall(char number[50], GSM_handler done = 0);
+      int  sendDTMF(char dtmf, GSM_handler done = 0);
+      int  exitCall(GSM_handler done = 0);
       
-      int  EMAILconfigureSMTP(char SMTP[50], int PORT, char USER[30], char PWD[30]);
-      int  EMAILconfigureSender(char SENDERNAME[30], char SENDEREMAIL[30]);
-      int  EMAILrecipients(int TYPE, char RECIPIENT[30]);
+      int  EMAILconfigureSMTP(char SMTP[50], int PORT, char USER[30], char PWD[30], GSM_handler done = 0);
+      int  EMAILconfigureSender(char SENDERNAME[30], char SENDEREMAIL[30], GSM_handler done = 0);
+      int  EMAILrecipients(int TYPE, char RECIPIENT[30], GSM_handler done = 0);
       int  EMAILbody(char TITLE[30], char BODY[200]);
-      int  EMAILsend();
+      int  EMAILsend(GSM_handler done = 0);
       
-      int  connectGPRS(char APN[50], char USER[30], char PWD[50]);
-      int  sendHTTPGET(char server[50], char parameter_string[200]);
-      int  FTPopen(char HOST[50], int PORT, char USER[30], char PASS[30]);
-      int  FTPdownload(char PATH[50], char FILENAME[50]);
-      int  FTPclose();
-      int  sendPING(char server[50], int timeout);
-      void disconnectGPRS();
+      int  connectGPRS(char APN[50], char USER[30], char PWD[50], GSM_handler done = 0);
+      int  sendHTTPGET(char server[50], char parameter_string[200], GSM_handler done = 0);
+      void HTTPkeepAlive(int on);
+      int  HTTPclose(GSM_handler done = 0);
+      int  FTPopen(char HOST[50], int PORT, char USER[30], char PASS[30], GSM_handler done = 0);
+      int  FTPdownload(char PATH[50], char FILENAME[50], GSM_handler done = 0);
+      int  FTPclose(GSM_handler done = 0);
+      int  sendPING(char server[50], int timeout, GSM_handler done = 0);
+      void disconnectGPRS(GSM_handler done = 0);
+
+      // AT command engine
+      int  queueCommand(const char *command, int expect, unsigned long timeout, GSM_handler done = 0);
+      int  poll();
+      void onEvent(byte type, GSM_event_handler handler);
     
     private:
-      int  WaitOfReaction(int timeout);
-      int  WaitOfDownload(int timeout);
+      GSM_command   commands[GSM_QUEUE_SIZE];
+      byte          first;                     // oldest command, the one in flight
+      byte          pending;                   // commands in the queue
+      byte          chaining;                  // commands queued now are chained to the one before
+      byte          phase;                     // of the command in flight
+      byte          sendPart;                  // how much of it is sent
+      unsigned int  sendOffset;
+      unsigned int  received;                  // characters in GSM_string
+      unsigned long since;                     // time of the last character sent or received
+      unsigned long sentAt;                    // time the command in flight was sent
+      byte          reaction;                  // of the last command done
+      byte          answered;                  // "poll" is ending a blocking function's wait
+      byte          matchState;                // of the automaton recognising the reaction (see Classify)
+      byte          matchRank;                 // strongest text found in the reaction so far
+      byte          matchLine;                 // the reaction ends with the current line
+      unsigned int  lineStart;                 // of the current line in GSM_string
+      byte          lineRank;                  // matchRank before the current line
+
+      // unsolicited messages
+      char          urcLine[GSM_URC_LINE];     // start of the current line
+      byte          urcLength;
+      GSM_event     events[GSM_EVENTS];
+      byte          eventFirst;
+      byte          eventCount;
+      GSM_event_handler handlers[GSM_EVENT_TYPES];
+      byte          ringing;                   // a "RING" came at "ringAt" and was not reported yet
+      unsigned long ringAt;
+      int           smsCount;                  // SMS stored on the SIM, -1 = unknown
+      byte          registration;              // last state of "+CREG:", 255 = unknown
+
+      // HTTP session (see HTTPkeepAlive)
+      byte          keepAlive;                 // keep the TCP connection for the next HTTP GET
+      byte          connected;                 // the TCP connection is up, as far as known
+
+      GSM_command *Queue(byte expect, unsigned long timeout, const char *a = 0, const char *b = 0, const char *c = 0,
+                         const char *d = 0, const char *e = 0, const char *f = 0, const char *g = 0);
+      int  Chain(byte count, GSM_handler done);
+      int  Run(GSM_handler done);
+      int  Command(byte expect, unsigned long timeout, const char *a = 0, const char *b = 0, const char *c = 0,
+                   const char *d = 0, const char *e = 0, const char *f = 0, const char *g = 0);
+      bool Send();
+      bool Complete();
+      void Done(byte result);
+      bool Fail();
+      bool Unsolicited(char c, bool quoted = false);
+      void Event(byte type, int value);
+      static void Connected(int ok);
+      static void Reuse(int ok);
+      static void PathSet(int ok);
+      int  Classify();
+      int  WaitOfReaction(unsigned long timeout);
 };
 
 //------------------------------------------------------------------------------
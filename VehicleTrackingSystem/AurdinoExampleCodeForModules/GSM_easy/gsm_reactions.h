@@ -0,0 +1,171 @@
+/*
+gsm_reactions.h - Automaton recognising the reactions of the mobile module, see "Classify" in gsm_easy.cpp
+
+Written by extras/reaction_gen, don't edit: change the table there and run it again.
+
+Texts, strongest first, their numbers and whether the reaction ends with them or their line:
+  "SIM PIN\r\n"              2
+  "READY\r\n"                3
+  "0,1\r\n"                  4
+  "0,5\r\n"                  4
+  "\n> "                     5  final
+  "\n>"                      5
+  "NO CARRIER\r\n"           6  final
+  "+CGATT: 1\r\n"            7
+  "IP INITIAL\r\n"           8  final
+  "IP STATUS\r\n"            8  final
+  "IP CLOSE\r\n"             8  final
+  "CONNECT OK\r\n"           9  final
+  "ALREADY CONNECT\r\n"      9  final
+  "SEND OK\r\n"             10  final
+  "RING\r\n"                11
+  "+QPING:"                 12
+  "+CPMS:"                  13
+  "\nOK\r\n\r\nCONNECT\r\n" 14  final
+  "+QSMTPBODY:"             15
+  "+QSMTPPUT: 0"            16  line
+  "+QFTPGET:"               18
+  ":0\r\n"                  17  final
+  "\n+CME ERROR:"           19  line
+  "\n+CMS ERROR:"           19  line
+  "\nERROR\r\n"             19  final
+  "DEACT OK\r\n"             1  final
+  "CLOSE OK\r\n"             1  final
+  "\nOK\r\n"                 1  final
+*/
+
+#ifndef gsm_reactions_h
+#define gsm_reactions_h
+
+#define GSM_REACTION_STATES 216
+#define GSM_REACTION_RANK   0x3F                                          // of GSM_reactionRank[]
+#define GSM_REACTION_FINAL  0x80                                          // the reaction ends here
+#define GSM_REACTION_LINE   0x40                                          // the reaction ends with this line
+#define GSM_REACTION_ERROR  19                                            // number of the errors
+#define GSM_REACTION_START  25                                            // state at the start of a line
+
+// characters a text starts with, one bit each
+static const byte GSM_reactionStart[32] PROGMEM =
+{
+    0,   4,   0,   0,   0,   8,   1,   4,  26,  66,  12,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+// edges of state s: GSM_reactionFirst[s] ... GSM_reactionFirst[s + 1] - 1
+static const byte GSM_reactionFirst[217] PROGMEM =
+{
+    0,  11,  13,  14,  15,  16,  17,  18,  19,  20,  20,  22,  23,  24,  25,  26,
+   27,  27,  28,  30,  31,  32,  32,  33,  34,  34,  38,  39,  39,  40,  41,  42,
+   43,  44,  45,  46,  47,  48,  49,  50,  50,  52,  54,  55,  56,  57,  58,  59,
+   60,  61,  62,  62,  63,  64,  67,  68,  69,  70,  71,  72,  73,  74,  75,  75,
+   76,  77,  78,  79,  80,  81,  82,  82,  83,  84,  85,  86,  87,  88,  88,  90,
+   91,  92,  93,  94,  95,  96,  97,  98,  99, 100, 100, 101, 102, 103, 104, 105,
+  106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 116, 117, 118, 119, 120,
+  121, 122, 123, 123, 124, 125, 126, 127, 127, 130, 131, 132, 133, 134, 134, 135,
+  136, 137, 137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 149, 150,
+  151, 151, 152, 153, 154, 156, 157, 158, 159, 160, 160, 161, 162, 163, 164, 165,
+  165, 166, 167, 168, 169, 170, 171, 171, 172, 173, 174, 174, 175, 176, 178, 179,
+  180, 181, 182, 183, 184, 185, 185, 186, 187, 188, 189, 190, 191, 192, 192, 193,
+  194, 195, 196, 197, 198, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 207,
+  208, 209, 210, 211, 212, 213, 214, 215, 215
+};
+
+// character and state of each edge
+static const byte GSM_reactionChar[215] PROGMEM =
+{
+   83,  82,  48,  10,  78,  43,  73,  67,  65,  58,  68,  73,  69,  77,  32,  80,
+   73,  78,  13,  10,  69,  73,  65,  68,  89,  13,  10,  44,  49,  53,  13,  10,
+   13,  10,  62,  79,  43,  69,  32,  79,  32,  67,  65,  82,  82,  73,  69,  82,
+   13,  10,  67,  81,  71,  80,  65,  84,  84,  58,  32,  49,  13,  10,  80,  32,
+   73,  83,  67,  78,  73,  84,  73,  65,  76,  13,  10,  84,  65,  84,  85,  83,
+   13,  10,  76,  79,  83,  69,  13,  10,  79,  76,  78,  78,  69,  67,  84,  32,
+   79,  75,  13,  10,  76,  82,  69,  65,  68,  89,  32,  67,  79,  78,  78,  69,
+   67,  84,  13,  10,  78,  68,  32,  79,  75,  13,  10,  78,  71,  13,  10,  80,
+   83,  70,  73,  78,  71,  58,  77,  83,  58,  75,  13,  10,  13,  10,  67,  79,
+   78,  78,  69,  67,  84,  13,  10,  77,  84,  80,  66,  80,  79,  68,  89,  58,
+   85,  84,  58,  32,  48,  84,  80,  71,  69,  84,  58,  48,  13,  10,  67,  77,
+   69,  83,  32,  69,  82,  82,  79,  82,  58,  32,  69,  82,  82,  79,  82,  58,
+   82,  82,  79,  82,  13,  10,  69,  65,  67,  84,  32,  79,  75,  13,  10,  79,
+   83,  69,  32,  79,  75,  13,  10
+};
+
+static const byte GSM_reactionNext[215] PROGMEM =
+{
+    1,  10,  17,  25,  28,  40,  51,  78,  90, 167, 197,   2, 107,   3,   4,   5,
+    6,   7,   8,   9,  11, 115,  12,  13,  14,  15,  16,  18,  19,  22,  20,  21,
+   23,  24,  26, 130, 171, 190,  27,  29,  30,  31,  32,  33,  34,  35,  36,  37,
+   38,  39,  41, 120,  42, 126,  43,  44,  45,  46,  47,  48,  49,  50,  52,  53,
+   54,  63,  71,  55,  56,  57,  58,  59,  60,  61,  62,  64,  65,  66,  67,  68,
+   69,  70,  72,  73,  74,  75,  76,  77,  79, 207,  80,  81,  82,  83,  84,  85,
+   86,  87,  88,  89,  91,  92,  93,  94,  95,  96,  97,  98,  99, 100, 101, 102,
+  103, 104, 105, 106, 108, 109, 110, 111, 112, 113, 114, 116, 117, 118, 119, 121,
+  145, 160, 122, 123, 124, 125, 127, 128, 129, 131, 132, 133, 134, 135, 136, 137,
+  138, 139, 140, 141, 142, 143, 144, 146, 147, 148, 149, 154, 150, 151, 152, 153,
+  155, 156, 157, 158, 159, 161, 162, 163, 164, 165, 166, 168, 169, 170, 172, 173,
+  174, 182, 175, 176, 177, 178, 179, 180, 181, 183, 184, 185, 186, 187, 188, 189,
+  191, 192, 193, 194, 195, 196, 198, 199, 200, 201, 202, 203, 204, 205, 206, 208,
+  209, 210, 211, 212, 213, 214, 215
+};
+
+// state of the longest end of the text so far that is the start of a text
+static const byte GSM_reactionFail[216] PROGMEM =
+{
+    0,   0,  51,   0,   0,   0,  51,  28,   0,  25,   0,   0,  90, 197,   0,   0,
+   25,   0,   0,   0,   0,  25,   0,   0,  25,   0,   0,   0,   0,   0,   0,  78,
+   90,  10,  10, 115,   0,  10,   0,  25,   0,  78,   0,  90,   0,   0, 167,   0,
+    0,   0,  25,   0,   0,   0,  51,  28,  51,   0,  51,  90,  91,   0,  25,   1,
+    0,  90,   0,   0,   1,   0,  25,  78, 207, 208, 209, 210,   0,  25,   0,   0,
+   28,  28,   0,  78,   0,   0,   0,   0,   0,  25,   0,   0,  10,  11,  12,  13,
+   14,   0,  78,  79,  80,  81,  82,  83,  84,   0,  25,   0,  28, 197,   0,   0,
+    0,   0,  25,  51,  28,   0,   0,  25,   0,   0,  51,  28,   0, 167,   0,   0,
+    1, 167,   0,   0,   0,  25,   0,  25,  78,  79,  80,  81,  82,  83,  84,   0,
+   25,   1,   0,   0,   0,   0,   0, 197,   0, 167,   0,   0,   0, 167,   0,  17,
+    0,   0,   0,   0,   0,   0, 167,   0,  17,   0,  25,  40,  41,   0,   0,   0,
+    0,  10,  10,   0,  10, 167,   1,   0,   0,  10,  10,   0,  10, 167,   0,  10,
+   10,   0,  10,   0,  25,   0,   0,  90,  78,   0,   0,   0,   0,   0,  25,   0,
+    0,   1, 107,   0,   0,   0,   0,  25
+};
+
+// strongest text ending in the state, 0 = none, and whether the reaction ends; numbers of the texts
+static const byte GSM_reactionRank[216] PROGMEM =
+{
+    0,   0,   0,   0,   0,   0,   0,   0,   0,  28,   0,   0,   0,   0,   0,   0,
+   27,   0,   0,   0,   0,  26,   0,   0,  25,   0,  23, 152,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0, 150,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,  21,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 148,   0,
+    0,   0,   0,   0,   0,   0, 147,   0,   0,   0,   0,   0,   0, 146,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0, 145,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 144,   0,   0,   0,   0,   0,
+    0,   0, 143,   0,   0,   0,   0,  14,   0,   0,   0,   0,   0,  13,   0,   0,
+    0,  12,   0,   0,   0, 129,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+  139,   0,   0,   0,   0,   0,   0,   0,   0,  10,   0,   0,   0,   0,   0,  73,
+    0,   0,   0,   0,   0,   0,   8,   0,   0,   0, 135,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,  70,   0,   0,   0,   0,   0,   0,   0,  69,   0,   0,
+    0,   0,   0,   0, 132,   0,   0,   0,   0,   0,   0,   0,   0,   0, 131,   0,
+    0,   0,   0,   0,   0,   0,   0, 130
+};
+
+static const byte GSM_reactionNumber[29] PROGMEM =
+{
+    0,   1,   1,   1,  19,  19,  19,  17,  18,  16,  15,  14,  13,  12,  11,  10,
+    9,   9,   8,   8,   8,   7,   6,   5,   5,   4,   4,   3,   2
+};
+
+// state after character "c" in state "s", 0 is the state at the start
+static inline byte GSM_reactionStep(byte s, char c)
+{
+  for(;;)
+  {
+    if(s == 0 && !(pgm_read_byte(&GSM_reactionStart[(byte)c >> 3]) & (1 << (c & 7)))) { return 0; }
+    byte e = pgm_read_byte(&GSM_reactionFirst[s]);
+    byte end = pgm_read_byte(&GSM_reactionFirst[s + 1]);
+    for(; e < end; e++)
+    {
+      if(pgm_read_byte(&GSM_reactionChar[e]) == (byte)c) { return pgm_read_byte(&GSM_reactionNext[e]); }
+    }
+    if(s == 0) { return 0; }
+    s = pgm_read_byte(&GSM_reactionFail[s]);
+  }
+}
+
+#endif
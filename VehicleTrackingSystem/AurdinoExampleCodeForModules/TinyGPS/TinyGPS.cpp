@@ -22,32 +22,57 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "TinyGPS.h"
+#include "TinyGPSSentence.h"
+#include <string.h>
 
-#define _GPRMC_TERM   "GPRMC"
-#define _GPGGA_TERM   "GPGGA"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The sentence formatter (the three letters after the two-letter talker id)
+// packed 5 bits per letter, so sentence types can be switched on
+#define _GPS_KEY(a, b, c) \
+  ((((unsigned)(a) - 'A') << 10) | (((unsigned)(b) - 'A') << 5) | ((unsigned)(c) - 'A'))
 
-TinyGPS::TinyGPS()
+TinyGPS::TinyGPS(TinyGPSLayout)
   :  _time(GPS_INVALID_TIME)
   ,  _date(GPS_INVALID_DATE)
   ,  _latitude(GPS_INVALID_ANGLE)
   ,  _longitude(GPS_INVALID_ANGLE)
+#ifndef _GPS_NO_ALTITUDE
   ,  _altitude(GPS_INVALID_ALTITUDE)
+#endif
+#ifndef _GPS_NO_SPEED
   ,  _speed(GPS_INVALID_SPEED)
+#endif
+#ifndef _GPS_NO_COURSE
   ,  _course(GPS_INVALID_ANGLE)
+#endif
+#ifndef _GPS_NO_HDOP
   ,  _hdop(GPS_INVALID_HDOP)
+#endif
+#ifndef _GPS_NO_SATELLITES
   ,  _numsats(GPS_INVALID_SATELLITES)
+#endif
   ,  _last_time_fix(GPS_INVALID_FIX_TIME)
   ,  _last_position_fix(GPS_INVALID_FIX_TIME)
+  ,  _sequence(0)
   ,  _parity(0)
   ,  _is_checksum_term(false)
   ,  _sentence_type(_GPS_SENTENCE_OTHER)
   ,  _term_number(0)
   ,  _term_offset(0)
   ,  _gps_data_good(false)
+#ifdef _GPS_DEFERRED_PARSE
+  ,  _sentence_length(_GPS_SENTENCE_DROPPED)
+#endif
 #ifndef _GPS_NO_STATS
   ,  _encoded_characters(0)
   ,  _good_sentences(0)
   ,  _failed_checksum(0)
+  ,  _dropped_characters(0)
 #endif
 {
   _term[0] = '\0';
@@ -59,58 +84,321 @@ TinyGPS::TinyGPS()
 
 bool TinyGPS::encode(char c)
 {
-  bool valid_sentence = false;
-
 #ifndef _GPS_NO_STATS
   ++_encoded_characters;
 #endif
   switch(c)
   {
   case ',': // term terminators
-    _parity ^= c;
   case '\r':
   case '\n':
   case '*':
-    if (_term_offset < sizeof(_term))
-    {
-      _term[_term_offset] = 0;
-      valid_sentence = term_complete();
-    }
-    ++_term_number;
-    _term_offset = 0;
-    _is_checksum_term = c == '*';
-    return valid_sentence;
+    return end_term(c);
 
   case '$': // sentence begin
-    _term_number = _term_offset = 0;
-    _parity = 0;
-    _sentence_type = _GPS_SENTENCE_OTHER;
-    _is_checksum_term = false;
-    _gps_data_good = false;
-    return valid_sentence;
+    begin_sentence();
+    return false;
   }
 
   // ordinary characters
+#ifdef _GPS_DEFERRED_PARSE
+  if (!_is_checksum_term)
+  {
+    append_sentence(c);
+    return false;
+  }
+#endif
   if (_term_offset < sizeof(_term) - 1)
     _term[_term_offset++] = c;
   if (!_is_checksum_term)
     _parity ^= c;
 
-  return valid_sentence;
+  return false;
 }
 
+// Processes a block of characters exactly as if each had been passed to
+// encode(char), but handles the runs between delimiters as whole spans.
+// Returns the number of sentences that passed the checksum test and were validated.
+unsigned TinyGPS::encode(const char *buf, size_t len)
+{
+  unsigned valid_sentences = 0;
+  const char *end = buf + len;
+
 #ifndef _GPS_NO_STATS
-void TinyGPS::stats(unsigned long *chars, unsigned short *sentences, unsigned short *failed_cs)
+  _encoded_characters += len;
+#endif
+  while (buf < end)
+  {
+#ifdef _GPS_DEFERRED_PARSE
+    // commas are only delimiters in the checksum term once sentences are buffered
+    size_t span = find_delimiter(buf, end - buf, _is_checksum_term ? ',' : '$');
+#else
+    size_t span = find_delimiter(buf, end - buf, ',');
+#endif
+    if (span)
+    {
+      append_term(buf, span);
+      buf += span;
+      if (buf == end)
+        break;
+    }
+
+    char c = *buf++;
+    if (c == '$')
+      begin_sentence();
+    else if (end_term(c))
+      ++valid_sentences;
+  }
+
+  return valid_sentences;
+}
+
+// Runs the terms of a sentence that has already passed its checksum
+// through the parser; do not interleave with encode(char) on the same
+// object, whose sentence in progress it replaces
+bool TinyGPS::encode(const TinyGPSSentence &sentence)
+{
+  _sentence_type = _GPS_SENTENCE_OTHER;
+  _gps_data_good = false;
+  _is_checksum_term = false;
+  for (_term_number = 0; _term_number < sentence.terms; ++_term_number)
+  {
+    byte n = sentence.term_length(_term_number);
+    if (n > sizeof(_term) - 1)
+      n = sizeof(_term) - 1;
+    memcpy(_term, sentence.term(_term_number), n);
+    _term[n] = 0;
+    term_complete();
+    if (_sentence_type == _GPS_SENTENCE_OTHER)
+      break;
+  }
+  return commit();
+}
+
+#ifndef _GPS_NO_STATS
+void TinyGPS::stats(unsigned long *chars, unsigned short *sentences, unsigned short *failed_cs,
+  unsigned long *dropped)
 {
   if (chars) *chars = _encoded_characters;
   if (sentences) *sentences = _good_sentences;
   if (failed_cs) *failed_cs = _failed_checksum;
+  if (dropped) *dropped = _dropped_characters;
 }
 #endif
 
 //
 // internal utilities
 //
+void TinyGPS::begin_sentence()
+{
+  _term_number = _term_offset = 0;
+  _parity = 0;
+  _sentence_type = _GPS_SENTENCE_OTHER;
+  _is_checksum_term = false;
+  _gps_data_good = false;
+#ifdef _GPS_DEFERRED_PARSE
+  _sentence_length = 0;
+#endif
+}
+
+bool TinyGPS::end_term(char c)
+{
+  bool valid_sentence = false;
+
+#ifdef _GPS_DEFERRED_PARSE
+  if (!_is_checksum_term)
+  {
+    if (c == ',')
+      append_sentence(c);
+    else if (c == '*')
+    {
+      _is_checksum_term = true;
+      _term_offset = 0;
+    }
+    else // no checksum: nothing to commit
+      _sentence_length = _GPS_SENTENCE_DROPPED;
+    return false;
+  }
+
+  _term[_term_offset] = 0;
+  if (_sentence_length != _GPS_SENTENCE_DROPPED)
+    valid_sentence = parse_sentence();
+  _sentence_length = _GPS_SENTENCE_DROPPED;
+  _is_checksum_term = false;
+  _term_offset = 0;
+  return valid_sentence;
+#endif
+
+  if (c == ',')
+    _parity ^= c;
+  if (_term_offset < sizeof(_term))
+  {
+    _term[_term_offset] = 0;
+    valid_sentence = term_complete();
+  }
+  ++_term_number;
+  _term_offset = 0;
+  _is_checksum_term = c == '*';
+  return valid_sentence;
+}
+
+// Appends a run of ordinary characters to the current term
+void TinyGPS::append_term(const char *s, size_t len)
+{
+#ifdef _GPS_DEFERRED_PARSE
+  if (!_is_checksum_term)
+  {
+    append_sentence(s, len);
+    return;
+  }
+#endif
+
+  size_t room = sizeof(_term) - 1 - _term_offset;
+  size_t n = len < room ? len : room;
+
+  if (len < sizeof(size_t))
+  {
+    // short terms are the common case: copy and fold parity in one pass
+    byte parity = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+      if (i < n)
+        _term[_term_offset + i] = s[i];
+      parity ^= s[i];
+    }
+    _term_offset += n;
+    if (!_is_checksum_term)
+      _parity ^= parity;
+    return;
+  }
+
+  memcpy(_term + _term_offset, s, n);
+  _term_offset += n;
+  if (!_is_checksum_term)
+    _parity ^= xor_span(s, len);
+}
+
+#ifdef _GPS_DEFERRED_PARSE
+// Appends characters to the buffered sentence, or drops the sentence
+// once it is too long to be one
+void TinyGPS::append_sentence(const char *s, size_t len)
+{
+  if (_sentence_length == _GPS_SENTENCE_DROPPED)
+    return;
+  if (len > sizeof(_sentence) - _sentence_length)
+  {
+    _sentence_length = _GPS_SENTENCE_DROPPED;
+    return;
+  }
+  memcpy(_sentence + _sentence_length, s, len);
+  _sentence_length += len;
+  _parity ^= xor_span(s, len);
+}
+
+// Checks the parity of the buffered sentence against the checksum term
+// in _term, which must have both digits, and only if it matches feeds
+// the sentence's terms through term_complete() in one pass and commits
+bool TinyGPS::parse_sentence()
+{
+  byte checksum = 16 * from_hex(_term[0]) + from_hex(_term[1]);
+  if (_term_offset < 2 || checksum != _parity)
+  {
+#ifndef _GPS_NO_STATS
+    ++_failed_checksum;
+#endif
+    return false;
+  }
+
+  byte i = 0;
+  _is_checksum_term = false;
+  for (_term_number = 0; ; ++_term_number)
+  {
+    byte n = 0;
+    for (; i < _sentence_length && _sentence[i] != ','; ++i)
+      if (n < sizeof(_term) - 1)
+        _term[n++] = _sentence[i];
+    _term[n] = 0;
+    term_complete();
+    // the fields of other sentences are of no interest
+    if (i == _sentence_length || _sentence_type == _GPS_SENTENCE_OTHER)
+      break;
+    ++i;
+  }
+  return commit();
+}
+#endif
+
+// Returns the offset of the first of '$' '*' '\r' '\n' and separator in s,
+// or len if there is none
+size_t TinyGPS::find_delimiter(const char *s, size_t len, char separator)
+{
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i dollar = _mm256_set1_epi8('$'), sep = _mm256_set1_epi8(separator),
+    star = _mm256_set1_epi8('*'), cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n');
+  for (; i + 32 <= len; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i m = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, dollar), _mm256_cmpeq_epi8(v, sep)),
+      _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, star), _mm256_cmpeq_epi8(v, cr)),
+                      _mm256_cmpeq_epi8(v, lf)));
+    unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+#endif
+
+#if defined(__SSE2__)
+  {
+    const __m128i dollar = _mm_set1_epi8('$'), sep = _mm_set1_epi8(separator),
+      star = _mm_set1_epi8('*'), cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n');
+    for (; i + 16 <= len; i += 16)
+    {
+      __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+      __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, dollar), _mm_cmpeq_epi8(v, sep)),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(v, cr)),
+                     _mm_cmpeq_epi8(v, lf)));
+      unsigned mask = (unsigned)_mm_movemask_epi8(m);
+      if (mask)
+        return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; i < len; ++i)
+    switch(s[i])
+    {
+    case '$': case '*': case '\r': case '\n':
+      return i;
+    default:
+      if (s[i] == separator)
+        return i;
+    }
+  return len;
+}
+
+// XOR of all bytes in s, taken a machine word at a time
+byte TinyGPS::xor_span(const char *s, size_t len)
+{
+  size_t word = 0;
+  for (; len >= sizeof(word); s += sizeof(word), len -= sizeof(word))
+  {
+    size_t w;
+    memcpy(&w, s, sizeof(w));
+    word ^= w;
+  }
+
+  byte parity = 0;
+  for (byte i = 0; i < sizeof(word); ++i)
+    parity ^= (byte)(word >> (8 * i));
+  while (len--)
+    parity ^= *s++;
+  return parity;
+}
+
 int TinyGPS::from_hex(char a) 
 {
   if (a >= 'A' && a <= 'F')
@@ -126,8 +414,9 @@ unsigned long TinyGPS::parse_decimal()
   char *p = _term;
   bool isneg = *p == '-';
   if (isneg) ++p;
-  unsigned long ret = 100UL * gpsatol(p);
-  while (gpsisdigit(*p)) ++p;
+  byte n;
+  unsigned long ret = 100UL * parse_digits(p, 255, &n);
+  p += n;
   if (*p == '.')
   {
     if (gpsisdigit(p[1]))
@@ -140,27 +429,115 @@ unsigned long TinyGPS::parse_decimal()
   return isneg ? -ret : ret;
 }
 
-// Parse a string in the form ddmm.mmmmmmm...
+// dddmm.mmmmm to millionths of a degree without dividing, which is slow
+// on AVR: x / 100 == (x * 5243) >> 19 for x < 43699, and
+// (minutes * 100000 + fraction + 3) / 6 is split using
+// 100000 = 6 * 16666 + 4 and x / 3 == (x * 43691) >> 17 for x < 2^17
 unsigned long TinyGPS::parse_degrees()
 {
-  char *p;
-  unsigned long left_of_decimal = gpsatol(_term);
-  unsigned long hundred1000ths_of_minute = (left_of_decimal % 100UL) * 100000UL;
-  for (p=_term; gpsisdigit(*p); ++p);
+  byte n;
+  unsigned long left_of_decimal = parse_digits(_term, 255, &n);
+  unsigned long degrees = left_of_decimal < 43699 ?
+    (left_of_decimal * 5243) >> 19 : left_of_decimal / 100;
+  unsigned long minutes = left_of_decimal - 100 * degrees;
+  unsigned long hundred1000ths_of_minute = 0;
+  const char *p = _term + n;
   if (*p == '.')
   {
-    unsigned long mult = 10000;
-    while (gpsisdigit(*++p))
-    {
-      hundred1000ths_of_minute += mult * (*p - '0');
-      mult /= 10;
-    }
+    hundred1000ths_of_minute = parse_digits(p + 1, 5, &n);
+    while (n++ < 5)
+      hundred1000ths_of_minute *= 10;
   }
-  return (left_of_decimal / 100) * 1000000 + (hundred1000ths_of_minute + 3) / 6;
+  unsigned long rest = (4 * minutes + hundred1000ths_of_minute + 3) >> 1;
+  return degrees * 1000000 + minutes * 16666 + ((rest * 43691UL) >> 17);
 }
 
 #define COMBINE(sentence_type, term_number) (((unsigned)(sentence_type) << 5) | term_number)
 
+// Copies the fields of a sentence that passed its checksum into the
+// fix, returns true if it was validated
+bool TinyGPS::commit()
+{
+  if (!_gps_data_good)
+    return false;
+
+#ifndef _GPS_NO_STATS
+  ++_good_sentences;
+#endif
+  begin_publish();
+  switch(_sentence_type)
+  {
+#ifndef _GPS_NO_RMC
+  case _GPS_SENTENCE_RMC:
+    _time      = _new_time;
+    _date      = _new_date;
+    _latitude  = _new_latitude;
+    _longitude = _new_longitude;
+#ifndef _GPS_NO_SPEED
+    _speed     = _new_speed;
+#endif
+#ifndef _GPS_NO_COURSE
+    _course    = _new_course;
+#endif
+    _last_time_fix = _new_time_fix;
+    _last_position_fix = _new_position_fix;
+    break;
+#endif
+#ifndef _GPS_NO_GGA
+  case _GPS_SENTENCE_GGA:
+#ifndef _GPS_NO_ALTITUDE
+    _altitude  = _new_altitude;
+#endif
+    _time      = _new_time;
+    _latitude  = _new_latitude;
+    _longitude = _new_longitude;
+#ifndef _GPS_NO_SATELLITES
+    _numsats   = _new_numsats;
+#endif
+#ifndef _GPS_NO_HDOP
+    _hdop      = _new_hdop;
+#endif
+    _last_time_fix = _new_time_fix;
+    _last_position_fix = _new_position_fix;
+    break;
+#endif
+#ifndef _GPS_NO_GLL
+  case _GPS_SENTENCE_GLL:
+    _time      = _new_time;
+    _latitude  = _new_latitude;
+    _longitude = _new_longitude;
+    _last_time_fix = _new_time_fix;
+    _last_position_fix = _new_position_fix;
+    break;
+#endif
+#ifndef _GPS_NO_VTG
+  case _GPS_SENTENCE_VTG:
+#ifndef _GPS_NO_SPEED
+    _speed     = _new_speed;
+#endif
+#ifndef _GPS_NO_COURSE
+    _course    = _new_course;
+#endif
+    break;
+#endif
+#ifndef _GPS_NO_GSA
+  case _GPS_SENTENCE_GSA:
+    _hdop      = _new_hdop;
+    break;
+#endif
+#ifndef _GPS_NO_ZDA
+  case _GPS_SENTENCE_ZDA:
+    _time      = _new_time;
+    _date      = _new_date;
+    _last_time_fix = _new_time_fix;
+    break;
+#endif
+  }
+  end_publish();
+
+  return true;
+}
+
 // Processes a just-completed term
 // Returns true if new sentence has just passed checksum test and is validated
 bool TinyGPS::term_complete()
@@ -169,42 +546,9 @@ bool TinyGPS::term_complete()
   {
     byte checksum = 16 * from_hex(_term[0]) + from_hex(_term[1]);
     if (checksum == _parity)
-    {
-      if (_gps_data_good)
-      {
+      return commit();
 #ifndef _GPS_NO_STATS
-        ++_good_sentences;
-#endif
-        _last_time_fix = _new_time_fix;
-        _last_position_fix = _new_position_fix;
-
-        switch(_sentence_type)
-        {
-        case _GPS_SENTENCE_GPRMC:
-          _time      = _new_time;
-          _date      = _new_date;
-          _latitude  = _new_latitude;
-          _longitude = _new_longitude;
-          _speed     = _new_speed;
-          _course    = _new_course;
-          break;
-        case _GPS_SENTENCE_GPGGA:
-          _altitude  = _new_altitude;
-          _time      = _new_time;
-          _latitude  = _new_latitude;
-          _longitude = _new_longitude;
-          _numsats   = _new_numsats;
-          _hdop      = _new_hdop;
-          break;
-        }
-
-        return true;
-      }
-    }
-
-#ifndef _GPS_NO_STATS
-    else
-      ++_failed_checksum;
+    ++_failed_checksum;
 #endif
     return false;
   }
@@ -212,66 +556,178 @@ bool TinyGPS::term_complete()
   // the first term determines the sentence type
   if (_term_number == 0)
   {
-    if (!gpsstrcmp(_term, _GPRMC_TERM))
-      _sentence_type = _GPS_SENTENCE_GPRMC;
-    else if (!gpsstrcmp(_term, _GPGGA_TERM))
-      _sentence_type = _GPS_SENTENCE_GPGGA;
-    else
-      _sentence_type = _GPS_SENTENCE_OTHER;
+    _sentence_type = sentence_type();
+    _gps_data_good = false;
+#ifndef _GPS_NO_VTG
+    // VTG has no status term before NMEA 2.3, so it is good once it has
+    // given a speed or course; the one it leaves empty is committed invalid
+    if (_sentence_type == _GPS_SENTENCE_VTG)
+    {
+#ifndef _GPS_NO_SPEED
+      _new_speed = GPS_INVALID_SPEED;
+#endif
+#ifndef _GPS_NO_COURSE
+      _new_course = GPS_INVALID_ANGLE;
+#endif
+    }
+#endif
     return false;
   }
 
   if (_sentence_type != _GPS_SENTENCE_OTHER && _term[0])
     switch(COMBINE(_sentence_type, _term_number))
   {
-    case COMBINE(_GPS_SENTENCE_GPRMC, 1): // Time in both sentences
-    case COMBINE(_GPS_SENTENCE_GPGGA, 1):
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 1): // Time in RMC, GGA, ZDA and GLL
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 1):
+#endif
+#ifndef _GPS_NO_ZDA
+    case COMBINE(_GPS_SENTENCE_ZDA, 1):
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 5):
+#endif
       _new_time = parse_decimal();
-      _new_time_fix = millis();
+      _new_time_fix = _clock();
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 2): // GPRMC validity
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 2): // RMC validity
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 6): // GLL validity
+#endif
       _gps_data_good = _term[0] == 'A';
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 3): // Latitude
-    case COMBINE(_GPS_SENTENCE_GPGGA, 2):
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 3): // Latitude
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 2):
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 1):
+#endif
       _new_latitude = parse_degrees();
-      _new_position_fix = millis();
+      _new_position_fix = _clock();
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 4): // N/S
-    case COMBINE(_GPS_SENTENCE_GPGGA, 3):
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 4): // N/S
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 3):
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 2):
+#endif
       if (_term[0] == 'S')
         _new_latitude = -_new_latitude;
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 5): // Longitude
-    case COMBINE(_GPS_SENTENCE_GPGGA, 4):
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 5): // Longitude
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 4):
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 3):
+#endif
       _new_longitude = parse_degrees();
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 6): // E/W
-    case COMBINE(_GPS_SENTENCE_GPGGA, 5):
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 6): // E/W
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 5):
+#endif
+#ifndef _GPS_NO_GLL
+    case COMBINE(_GPS_SENTENCE_GLL, 4):
+#endif
       if (_term[0] == 'W')
         _new_longitude = -_new_longitude;
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 7): // Speed (GPRMC)
+#ifndef _GPS_NO_SPEED
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 7): // Speed (RMC)
+#endif
+#ifndef _GPS_NO_VTG
+    case COMBINE(_GPS_SENTENCE_VTG, 5): // Speed over ground in knots (VTG)
+#endif
       _new_speed = parse_decimal();
+#ifndef _GPS_NO_VTG
+      if (_sentence_type == _GPS_SENTENCE_VTG)
+        _gps_data_good = true;
+#endif
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 8): // Course (GPRMC)
+#endif
+#ifndef _GPS_NO_COURSE
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 8): // Course (RMC)
+#endif
+#ifndef _GPS_NO_VTG
+    case COMBINE(_GPS_SENTENCE_VTG, 1): // True course (VTG)
+#endif
       _new_course = parse_decimal();
+#ifndef _GPS_NO_VTG
+      if (_sentence_type == _GPS_SENTENCE_VTG)
+        _gps_data_good = true;
+#endif
       break;
-    case COMBINE(_GPS_SENTENCE_GPRMC, 9): // Date (GPRMC)
+#endif
+#ifndef _GPS_NO_RMC
+    case COMBINE(_GPS_SENTENCE_RMC, 9): // Date (RMC)
       _new_date = gpsatol(_term);
       break;
-    case COMBINE(_GPS_SENTENCE_GPGGA, 6): // Fix data (GPGGA)
+#endif
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 6): // Fix data (GGA)
       _gps_data_good = _term[0] > '0';
       break;
-    case COMBINE(_GPS_SENTENCE_GPGGA, 7): // Satellites used (GPGGA)
+#endif
+#ifndef _GPS_NO_GSA
+    case COMBINE(_GPS_SENTENCE_GSA, 2): // Fix mode (GSA), 1 = no fix
+      _gps_data_good = _term[0] > '1';
+      break;
+#endif
+#if !defined(_GPS_NO_GGA) && !defined(_GPS_NO_SATELLITES)
+    case COMBINE(_GPS_SENTENCE_GGA, 7): // Satellites used (GGA)
       _new_numsats = (unsigned char)atoi(_term);
       break;
-    case COMBINE(_GPS_SENTENCE_GPGGA, 8): // HDOP
+#endif
+#ifndef _GPS_NO_HDOP
+#ifndef _GPS_NO_GGA
+    case COMBINE(_GPS_SENTENCE_GGA, 8): // HDOP
+#endif
+#ifndef _GPS_NO_GSA
+    case COMBINE(_GPS_SENTENCE_GSA, 16):
+#endif
       _new_hdop = parse_decimal();
       break;
-    case COMBINE(_GPS_SENTENCE_GPGGA, 9): // Altitude (GPGGA)
+#endif
+#if !defined(_GPS_NO_GGA) && !defined(_GPS_NO_ALTITUDE)
+    case COMBINE(_GPS_SENTENCE_GGA, 9): // Altitude (GGA)
       _new_altitude = parse_decimal();
       break;
+#endif
+#ifndef _GPS_NO_VTG
+    case COMBINE(_GPS_SENTENCE_VTG, 9): // Mode indicator (VTG, NMEA 2.3 and later)
+      if (_term[0] == 'N')
+        _gps_data_good = false;
+      break;
+#endif
+#ifndef _GPS_NO_ZDA
+    case COMBINE(_GPS_SENTENCE_ZDA, 2): // Day, month and year (ZDA) into ddmmyy
+      _new_date = gpsatol(_term) * 10000;
+      break;
+    case COMBINE(_GPS_SENTENCE_ZDA, 3):
+      _new_date += gpsatol(_term) * 100;
+      break;
+    case COMBINE(_GPS_SENTENCE_ZDA, 4):
+      _new_date += gpsatol(_term) % 100;
+      _gps_data_good = true;
+      break;
+#endif
   }
 
   return false;
@@ -279,17 +735,54 @@ bool TinyGPS::term_complete()
 
 long TinyGPS::gpsatol(const char *str)
 {
-  long ret = 0;
-  while (gpsisdigit(*str))
-    ret = 10 * ret + *str++ - '0';
+  byte n;
+  return parse_digits(str, 255, &n);
+}
+
+// Value of the digits at str, up to max of them, in a single pass;
+// *n is set to the number used
+unsigned long TinyGPS::parse_digits(const char *str, byte max, byte *n)
+{
+  unsigned long ret = 0;
+  byte i = 0;
+  for (; i < max && gpsisdigit(str[i]); ++i)
+    ret = 10 * ret + str[i] - '0';
+  *n = i;
   return ret;
 }
 
-int TinyGPS::gpsstrcmp(const char *str1, const char *str2)
+// Identifies the sentence from its first term, whatever the talker id
+// (GP, GN, GL, GA, GB, ...)
+byte TinyGPS::sentence_type()
 {
-  while (*str1 && *str1 == *str2)
-    ++str1, ++str2;
-  return *str1;
+  for (byte i = 0; i < 5; ++i)
+    if (_term[i] < 'A' || _term[i] > 'Z')
+      return _GPS_SENTENCE_OTHER;
+  if (_term[5])
+    return _GPS_SENTENCE_OTHER;
+
+  switch(_GPS_KEY(_term[2], _term[3], _term[4]))
+  {
+#ifndef _GPS_NO_RMC
+  case _GPS_KEY('R', 'M', 'C'): return _GPS_SENTENCE_RMC;
+#endif
+#ifndef _GPS_NO_GGA
+  case _GPS_KEY('G', 'G', 'A'): return _GPS_SENTENCE_GGA;
+#endif
+#ifndef _GPS_NO_GLL
+  case _GPS_KEY('G', 'L', 'L'): return _GPS_SENTENCE_GLL;
+#endif
+#ifndef _GPS_NO_VTG
+  case _GPS_KEY('V', 'T', 'G'): return _GPS_SENTENCE_VTG;
+#endif
+#ifndef _GPS_NO_GSA
+  case _GPS_KEY('G', 'S', 'A'): return _GPS_SENTENCE_GSA;
+#endif
+#ifndef _GPS_NO_ZDA
+  case _GPS_KEY('Z', 'D', 'A'): return _GPS_SENTENCE_ZDA;
+#endif
+  }
+  return _GPS_SENTENCE_OTHER;
 }
 
 /* static */
@@ -338,6 +831,246 @@ float TinyGPS::course_to (float lat1, float long1, float lat2, float long2)
   return degrees(a2);
 }
 
+// cos(k * 2^20 millionths of a degree) * 65535, k = 0..86
+static const unsigned short _gps_cos_table[87] PROGMEM = {
+  65535, 65524, 65491, 65436, 65359, 65261, 65140, 64998, 64834, 64648,
+  64441, 64212, 63961, 63689, 63396, 63081, 62745, 62389, 62011, 61613,
+  61194, 60754, 60295, 59815, 59314, 58795, 58255, 57696, 57117, 56520,
+  55903, 55268, 54614, 53942, 53252, 52544, 51819, 51076, 50316, 49539,
+  48746, 47936, 47110, 46268, 45411, 44539, 43652, 42750, 41834, 40904,
+  39960, 39003, 38032, 37049, 36054, 35046, 34027, 32996, 31955, 30902,
+  29839, 28767, 27684, 26592, 25492, 24383, 23266, 22140, 21008, 19868,
+  18722, 17570, 16411, 15248, 14079, 12905, 11727, 10545, 9360, 8171,
+  6980, 5786, 4591, 3394, 2195, 996, 0
+};
+
+// atan(k / 64) in thousandths of a degree, k = 0..64
+static const unsigned short _gps_atan_table[65] PROGMEM = {
+  0, 895, 1790, 2684, 3576, 4467, 5356, 6242, 7125, 8005,
+  8881, 9752, 10620, 11482, 12339, 13191, 14036, 14876, 15709, 16535,
+  17354, 18166, 18970, 19767, 20556, 21337, 22109, 22874, 23629, 24376,
+  25115, 25844, 26565, 27277, 27979, 28673, 29358, 30033, 30700, 31357,
+  32005, 32645, 33275, 33896, 34509, 35112, 35707, 36293, 36870, 37439,
+  37999, 38550, 39094, 39629, 40156, 40675, 41186, 41689, 42184, 42672,
+  43152, 43625, 44091, 44549, 45000
+};
+
+// cosine of an angle in millionths of a degree, times 65535
+static unsigned long cos_millionths(long angle)
+{
+  unsigned long a = angle < 0 ? -angle : angle;
+  if (a >= 90000000UL)
+    return 0;
+  byte k = a >> 20;
+  unsigned long frac = a & 0xFFFFF;
+  unsigned short c0 = pgm_read_word(&_gps_cos_table[k]);
+  unsigned short c1 = pgm_read_word(&_gps_cos_table[k + 1]);
+  return c0 - (((unsigned long)(c0 - c1) * frac) >> 20);
+}
+
+// a * b >> 16 without overflowing 32 bits, b up to 65535
+static unsigned long mul_q16(unsigned long a, unsigned long b)
+{
+  return (a >> 16) * b + (((a & 0xFFFF) * b) >> 16);
+}
+
+static unsigned long isqrt(unsigned long n)
+{
+  unsigned long root = 0, bit = 1UL << 30;
+  while (bit > n)
+    bit >>= 2;
+  while (bit)
+  {
+    if (n >= root + bit)
+    {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+      root >>= 1;
+    bit >>= 2;
+  }
+  return root;
+}
+
+// The leg from 1 to 2 on a flat earth scaled by the cosine of the middle
+// latitude, east and north in 1/256 millionths of a degree of latitude so
+// short legs keep their direction; false if the points are too far apart,
+// or too near a pole, for that to hold.
+static bool flat_leg(long lat1, long long1, long lat2, long long2,
+  long *east, long *north, long *dlon, long *mid)
+{
+  long d = long2 - long1;
+  if (d > 180000000L) d -= 360000000L;
+  else if (d < -180000000L) d += 360000000L;
+  long dlat = lat2 - lat1;
+  long m = (lat1 >> 1) + (lat2 >> 1);
+  if (d > _GPS_FLAT_LIMIT || d < -_GPS_FLAT_LIMIT || dlat > _GPS_FLAT_LIMIT ||
+    dlat < -_GPS_FLAT_LIMIT || m > _GPS_FLAT_POLE || m < -_GPS_FLAT_POLE)
+    return false;
+  unsigned long x = mul_q16((unsigned long)(d < 0 ? -d : d) << 8, cos_millionths(m));
+  *east = d < 0 ? -(long)x : (long)x;
+  *north = dlat * 256;
+  *dlon = d;
+  *mid = m;
+  return true;
+}
+
+unsigned long TinyGPS::distance_between_fixed (long lat1, long long1, long lat2, long long2)
+{
+  long east, north, dlon, mid;
+  if (!flat_leg(lat1, long1, lat2, long2, &east, &north, &dlon, &mid))
+    return (unsigned long)(distance_between(lat1 / 1000000.0, long1 / 1000000.0,
+      lat2 / 1000000.0, long2 / 1000000.0) + 0.5);
+
+  // scale down until the sum of squares fits in 32 bits
+  unsigned long x = east < 0 ? -east : east, y = north < 0 ? -north : north;
+  byte shift = 0;
+  while (x > 46340 || y > 46340)
+  {
+    x >>= 1;
+    y >>= 1;
+    ++shift;
+  }
+  unsigned long r = isqrt(x * x + y * y) << shift;
+  // 0.1112263 metres per millionth of a degree on the sphere distance_between()
+  // uses, 58315 / 2^19, and r is in 1/256 millionths
+  return (mul_q16(r, 58315) + 1024) >> 11;
+}
+
+unsigned long TinyGPS::course_to_fixed (long lat1, long long1, long lat2, long long2)
+{
+  long east, north, dlon, mid;
+  if (!flat_leg(lat1, long1, lat2, long2, &east, &north, &dlon, &mid))
+  {
+    unsigned long c = (unsigned long)(course_to(lat1 / 1000000.0, long1 / 1000000.0,
+      lat2 / 1000000.0, long2 / 1000000.0) * 100 + 0.5);
+    return c >= 36000 ? c - 36000 : c;
+  }
+
+  unsigned long x = east < 0 ? -east : east, y = north < 0 ? -north : north;
+  if (x == 0 && y == 0)
+    return 0;
+  while (x > 32767 || y > 32767)
+  {
+    x >>= 1;
+    y >>= 1;
+  }
+
+  // angle from the nearer of north and south, in thousandths of a degree,
+  // from the table at 1/64 steps of the smaller over the larger component
+  bool steep = x > y;
+  unsigned long ratio = steep ? (y << 16) / x : (x << 16) / y;
+  byte k = ratio >> 10;
+  long theta;
+  if (k == 64)
+    theta = 45000;
+  else
+  {
+    unsigned short t0 = pgm_read_word(&_gps_atan_table[k]);
+    unsigned short t1 = pgm_read_word(&_gps_atan_table[k + 1]);
+    theta = t0 + (((unsigned long)(t1 - t0) * (ratio & 1023)) >> 10);
+  }
+  if (steep)
+    theta = 90000 - theta;
+
+  long course;
+  if (east >= 0)
+    course = north >= 0 ? theta : 180000 - theta;
+  else
+    course = north >= 0 ? 360000 - theta : 180000 + theta;
+
+  // That is the course at the middle of the leg. Meridians converge, so the
+  // course at the start differs by half the longitude change times the
+  // sine of the latitude.
+  unsigned long half = mul_q16(dlon < 0 ? -dlon : dlon, cos_millionths(90000000L - (mid < 0 ? -mid : mid)));
+  long convergence = (long)((mul_q16(half, 131) + 2) >> 2); // / 2000, thousandths of a degree
+  course -= (dlon < 0) == (mid < 0) ? convergence : -convergence;
+
+  course = (course + 5) / 10;
+  if (course < 0) course += 36000;
+  else if (course >= 36000) course -= 36000;
+  return course;
+}
+
+// Legs are handled in blocks: the sine and cosine of each point's latitude
+// are taken once and shared by the two legs that meet there, and those of
+// each leg's longitude change serve both distance and course. That is 4 sine
+// or cosine and 2 arctangent calls a leg where distance_between() and
+// course_to() make 13 and 2. The calls go to libm one at a time, so the
+// passes do not vectorize. The arrays take (4 * block + 2) * sizeof(T) of
+// stack, kept small on the AVR at the cost of one extra sine and cosine
+// per block.
+#ifdef __AVR__
+#define _GPS_TRACK_BLOCK 8
+#else
+#define _GPS_TRACK_BLOCK 32
+#endif
+
+template <typename T>
+static void track_legs(const T *lat, const T *lon, size_t count,
+  T *distance, T *course, T *cumulative)
+{
+  T slat[_GPS_TRACK_BLOCK + 1], clat[_GPS_TRACK_BLOCK + 1];
+  T sdlon[_GPS_TRACK_BLOCK], cdlon[_GPS_TRACK_BLOCK];
+  double total = 0;
+
+  for (size_t first = 0; first + 1 < count; first += _GPS_TRACK_BLOCK)
+  {
+    size_t legs = count - 1 - first;
+    if (legs > _GPS_TRACK_BLOCK)
+      legs = _GPS_TRACK_BLOCK;
+
+    for (size_t i = 0; i <= legs; ++i)
+    {
+      T phi = radians(lat[first + i]);
+      slat[i] = sin(phi);
+      clat[i] = cos(phi);
+    }
+    for (size_t i = 0; i < legs; ++i)
+    {
+      T dlon = radians(lon[first + i + 1] - lon[first + i]);
+      sdlon[i] = sin(dlon);
+      cdlon[i] = cos(dlon);
+    }
+
+    for (size_t i = 0; i < legs; ++i)
+    {
+      T a = clat[i] * slat[i + 1] - slat[i] * clat[i + 1] * cdlon[i];
+      if (distance || cumulative)
+      {
+        T delta = sqrt(sq(a) + sq(clat[i + 1] * sdlon[i]));
+        T denom = slat[i] * slat[i + 1] + clat[i] * clat[i + 1] * cdlon[i];
+        T d = atan2(delta, denom) * 6372795;
+        if (distance)
+          distance[first + i] = d;
+        total += d;
+        if (cumulative)
+          cumulative[first + i] = total;
+      }
+      if (course)
+      {
+        T c = atan2(sdlon[i] * clat[i + 1], a);
+        if (c < 0.0)
+          c += TWO_PI;
+        course[first + i] = degrees(c);
+      }
+    }
+  }
+}
+
+void TinyGPS::distances_between (const float *lat, const float *lon, size_t count,
+  float *distance, float *course, float *cumulative)
+{
+  track_legs(lat, lon, count, distance, course, cumulative);
+}
+
+void TinyGPS::distances_between (const double *lat, const double *lon, size_t count,
+  double *distance, double *course, double *cumulative)
+{
+  track_legs(lat, lon, count, distance, course, cumulative);
+}
+
 const char *TinyGPS::cardinal (float course)
 {
   static const char* directions[] = {"N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE", "S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW"};
@@ -350,27 +1083,135 @@ const char *TinyGPS::cardinal (float course)
 // (note: versions 12 and earlier gave this value in 100,000ths of a degree.
 void TinyGPS::get_position(long *latitude, long *longitude, unsigned long *fix_age)
 {
-  if (latitude) *latitude = _latitude;
-  if (longitude) *longitude = _longitude;
-  if (fix_age) *fix_age = _last_position_fix == GPS_INVALID_FIX_TIME ? 
-   GPS_INVALID_AGE : millis() - _last_position_fix;
+  long lat, lon;
+  unsigned long fix;
+  sequence s;
+  do
+  {
+    s = begin_read();
+    lat = _latitude;
+    lon = _longitude;
+    fix = _last_position_fix;
+  } while (retry_read(s));
+
+  if (latitude) *latitude = lat;
+  if (longitude) *longitude = lon;
+  if (fix_age) *fix_age = fix == GPS_INVALID_FIX_TIME ? 
+   GPS_INVALID_AGE : _clock() - fix;
 }
 
 // date as ddmmyy, time as hhmmsscc, and age in milliseconds
 void TinyGPS::get_datetime(unsigned long *date, unsigned long *time, unsigned long *age)
 {
-  if (date) *date = _date;
-  if (time) *time = _time;
-  if (age) *age = _last_time_fix == GPS_INVALID_FIX_TIME ? 
-   GPS_INVALID_AGE : millis() - _last_time_fix;
+  unsigned long d, t, fix;
+  sequence s;
+  do
+  {
+    s = begin_read();
+    d = _date;
+    t = _time;
+    fix = _last_time_fix;
+  } while (retry_read(s));
+
+  if (date) *date = d;
+  if (time) *time = t;
+  if (age) *age = fix == GPS_INVALID_FIX_TIME ? 
+   GPS_INVALID_AGE : _clock() - fix;
 }
 
-void TinyGPS::f_get_position(float *latitude, float *longitude, unsigned long *fix_age)
+void TinyGPS::get_fix(TinyGPSFix *fix)
 {
-  long lat, lon;
-  get_position(&lat, &lon, fix_age);
-  *latitude = lat == GPS_INVALID_ANGLE ? GPS_INVALID_F_ANGLE : (lat / 1000000.0);
-  *longitude = lat == GPS_INVALID_ANGLE ? GPS_INVALID_F_ANGLE : (lon / 1000000.0);
+  TinyGPSFix f;
+  sequence s;
+  do
+  {
+    s = begin_read();
+    f.time         = _time;
+    f.date         = _date;
+    f.latitude     = _latitude;
+    f.longitude    = _longitude;
+#ifndef _GPS_NO_ALTITUDE
+    f.altitude     = _altitude;
+#else
+    f.altitude     = GPS_INVALID_ALTITUDE;
+#endif
+#ifndef _GPS_NO_SPEED
+    f.speed        = _speed;
+#else
+    f.speed        = GPS_INVALID_SPEED;
+#endif
+#ifndef _GPS_NO_COURSE
+    f.course       = _course;
+#else
+    f.course       = GPS_INVALID_ANGLE;
+#endif
+#ifndef _GPS_NO_HDOP
+    f.hdop         = _hdop;
+#else
+    f.hdop         = GPS_INVALID_HDOP;
+#endif
+#ifndef _GPS_NO_SATELLITES
+    f.satellites   = _numsats;
+#else
+    f.satellites   = GPS_INVALID_SATELLITES;
+#endif
+    f.time_fix     = _last_time_fix;
+    f.position_fix = _last_position_fix;
+  } while (retry_read(s));
+  *fix = f;
+}
+
+// the high 32 bits of x * m, from 16-bit halves so an AVR needs no 64-bit multiply
+static unsigned long mul_high(unsigned long x, unsigned long m)
+{
+  unsigned long xl = x & 0xFFFF, xh = x >> 16, ml = m & 0xFFFF, mh = m >> 16;
+  unsigned long lo = xl * ml, a = xh * ml, b = xl * mh;
+  unsigned long mid = (lo >> 16) + (a & 0xFFFF) + (b & 0xFFFF);
+  return xh * mh + (a >> 16) + (b >> 16) + (mid >> 16);
+}
+
+// x / 100 and x / 10000 by reciprocal, exact for every 32-bit x
+static unsigned long div100(unsigned long x) { return mul_high(x, 1374389535UL) >> 5; }
+static unsigned long div10000(unsigned long x) { return mul_high(x, 3518437209UL) >> 13; }
+
+// splits ddmmyy and hhmmsscc into their pairs of digits
+struct civil_fields
+{
+  unsigned long day, hour; // only out of range if the packed values are
+  byte month, year, minute, second, hundredths;
+};
+
+static void split_datetime(unsigned long date, unsigned long time, civil_fields *f)
+{
+  unsigned long ddmm = div100(date);
+  f->year = date - ddmm * 100;
+  f->day = div100(ddmm);
+  f->month = ddmm - f->day * 100;
+
+  unsigned long hhmm = div10000(time), sscc = time - hhmm * 10000;
+  f->hour = div100(hhmm);
+  f->minute = hhmm - f->hour * 100;
+  f->second = (sscc * 5243) >> 19; // sscc / 100, exact below 43699
+  f->hundredths = sscc - f->second * 100;
+}
+
+// milliseconds since 1970 of a ddmmyy, hhmmsscc pair with years 1981 to 2080
+static unsigned long long epoch_ms_of(unsigned long date, unsigned long time)
+{
+  civil_fields f;
+  split_datetime(date, time, &f);
+
+  // days_from_civil() with years counted from 1900 and starting in March.
+  // Between 1980 and 2080 y / 100 - y / 400 is always 15, which leaves
+  // only the leap days of y / 4 to count.
+  unsigned long y = f.year + (f.year > 80 ? 0 : 100) - (f.month <= 2);
+  unsigned long doy = ((153 * (f.month > 2 ? f.month - 3 : f.month + 9) + 2) * 52429UL >> 18) + f.day - 1;
+  unsigned long days = 365 * y + (y >> 2) + doy - 25508;
+  unsigned long seconds = days * 86400UL + (f.hour * 60 + f.minute) * 60 + f.second;
+
+  bool valid = date != TinyGPS::GPS_INVALID_DATE && time != TinyGPS::GPS_INVALID_TIME &&
+    f.month - 1U < 12 && f.day - 1 < 31 && f.hour < 24 && f.minute < 60 && f.second < 60;
+  return valid ? seconds * 1000ULL + f.hundredths * 10 : 0;
 }
 
 void TinyGPS::crack_datetime(int *year, byte *month, byte *day, 
@@ -378,29 +1219,59 @@ void TinyGPS::crack_datetime(int *year, byte *month, byte *day,
 {
   unsigned long date, time;
   get_datetime(&date, &time, age);
+  civil_fields f;
+  split_datetime(date, time, &f);
   if (year) 
   {
-    *year = date % 100;
+    *year = f.year;
     *year += *year > 80 ? 1900 : 2000;
   }
-  if (month) *month = (date / 100) % 100;
-  if (day) *day = date / 10000;
-  if (hour) *hour = time / 1000000;
-  if (minute) *minute = (time / 10000) % 100;
-  if (second) *second = (time / 100) % 100;
-  if (hundredths) *hundredths = time % 100;
+  if (month) *month = f.month;
+  if (day) *day = f.day;
+  if (hour) *hour = f.hour;
+  if (minute) *minute = f.minute;
+  if (second) *second = f.second;
+  if (hundredths) *hundredths = f.hundredths;
 }
 
+unsigned long long TinyGPS::get_epoch_ms(unsigned long *age)
+{
+  unsigned long date, time;
+  get_datetime(&date, &time, age);
+  return epoch_ms_of(date, time);
+}
+
+void TinyGPS::epochs_ms(const unsigned long *date, const unsigned long *time, size_t count,
+  unsigned long long *epoch_ms)
+{
+  for (size_t i = 0; i < count; ++i)
+    epoch_ms[i] = epoch_ms_of(date[i], time[i]);
+}
+
+#ifndef _GPS_NO_FLOAT
+void TinyGPS::f_get_position(float *latitude, float *longitude, unsigned long *fix_age)
+{
+  long lat, lon;
+  get_position(&lat, &lon, fix_age);
+  *latitude = lat == GPS_INVALID_ANGLE ? GPS_INVALID_F_ANGLE : (lat / 1000000.0);
+  *longitude = lat == GPS_INVALID_ANGLE ? GPS_INVALID_F_ANGLE : (lon / 1000000.0);
+}
+
+#ifndef _GPS_NO_ALTITUDE
 float TinyGPS::f_altitude()    
 {
   return _altitude == GPS_INVALID_ALTITUDE ? GPS_INVALID_F_ALTITUDE : _altitude / 100.0;
 }
+#endif
 
+#ifndef _GPS_NO_COURSE
 float TinyGPS::f_course()
 {
   return _course == GPS_INVALID_ANGLE ? GPS_INVALID_F_ANGLE : _course / 100.0;
 }
+#endif
 
+#ifndef _GPS_NO_SPEED
 float TinyGPS::f_speed_knots() 
 {
   return _speed == GPS_INVALID_SPEED ? GPS_INVALID_F_SPEED : _speed / 100.0;
@@ -423,7 +1294,11 @@ float TinyGPS::f_speed_kmph()
   float sk = f_speed_knots();
   return sk == GPS_INVALID_F_SPEED ? GPS_INVALID_F_SPEED : _GPS_KMPH_PER_KNOT * sk; 
 }
+#endif
 
 const float TinyGPS::GPS_INVALID_F_ANGLE = 1000.0;
 const float TinyGPS::GPS_INVALID_F_ALTITUDE = 1000000.0;
 const float TinyGPS::GPS_INVALID_F_SPEED = -1.0;
+#endif
+
+unsigned long (*TinyGPS::_clock)() = millis;
@@ -38,7 +38,104 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define _GPS_KMPH_PER_KNOT 1.852
 #define _GPS_MILES_PER_METER 0.00062137112
 #define _GPS_KM_PER_METER 0.001
-// #define _GPS_NO_STATS
+#define _GPS_FLAT_LIMIT 500000L   // millionths of a degree, see distance_between_fixed()
+#define _GPS_FLAT_POLE 80000000L  // millionths of a degree
+
+// _GPS_NO_STATS, the _GPS_NO_* field and sentence options and
+// _GPS_DEFERRED_PARSE are set in TinyGPSConfig.h
+#include "TinyGPSConfig.h"
+
+// sentences that would carry nothing still wanted
+#if defined(_GPS_NO_SPEED) && defined(_GPS_NO_COURSE) && !defined(_GPS_NO_VTG)
+#define _GPS_NO_VTG
+#endif
+#if defined(_GPS_NO_HDOP) && !defined(_GPS_NO_GSA)
+#define _GPS_NO_GSA
+#endif
+
+#if defined(_GPS_DEFERRED_PARSE) && !defined(_GPS_SENTENCE_SIZE)
+#define _GPS_SENTENCE_SIZE 80
+#endif
+
+// The options that change the members, as the name of an empty type the
+// constructors take, so that it is part of their link names. Each digit
+// is 1 for one of _GPS_NO_ALTITUDE, _SPEED, _COURSE, _HDOP, _SATELLITES,
+// _GPS_NO_STATS and _GPS_DEFERRED_PARSE, then comes _GPS_SENTENCE_SIZE.
+#ifdef _GPS_NO_ALTITUDE
+#define _GPS_LAYOUT_ALTITUDE 1
+#else
+#define _GPS_LAYOUT_ALTITUDE 0
+#endif
+#ifdef _GPS_NO_SPEED
+#define _GPS_LAYOUT_SPEED 1
+#else
+#define _GPS_LAYOUT_SPEED 0
+#endif
+#ifdef _GPS_NO_COURSE
+#define _GPS_LAYOUT_COURSE 1
+#else
+#define _GPS_LAYOUT_COURSE 0
+#endif
+#ifdef _GPS_NO_HDOP
+#define _GPS_LAYOUT_HDOP 1
+#else
+#define _GPS_LAYOUT_HDOP 0
+#endif
+#ifdef _GPS_NO_SATELLITES
+#define _GPS_LAYOUT_SATELLITES 1
+#else
+#define _GPS_LAYOUT_SATELLITES 0
+#endif
+#ifdef _GPS_NO_STATS
+#define _GPS_LAYOUT_STATS 1
+#else
+#define _GPS_LAYOUT_STATS 0
+#endif
+#ifdef _GPS_DEFERRED_PARSE
+#define _GPS_LAYOUT_DEFERRED 1
+#define _GPS_LAYOUT_SENTENCE _GPS_SENTENCE_SIZE
+#else
+#define _GPS_LAYOUT_DEFERRED 0
+#define _GPS_LAYOUT_SENTENCE 0
+#endif
+#define _GPS_LAYOUT_PASTE(a, s, c, h, n, t, d, size) TinyGPSLayout_##a##s##c##h##n##t##d##_##size
+#define _GPS_LAYOUT_NAME(a, s, c, h, n, t, d, size) _GPS_LAYOUT_PASTE(a, s, c, h, n, t, d, size)
+struct _GPS_LAYOUT_NAME(_GPS_LAYOUT_ALTITUDE, _GPS_LAYOUT_SPEED, _GPS_LAYOUT_COURSE, _GPS_LAYOUT_HDOP,
+  _GPS_LAYOUT_SATELLITES, _GPS_LAYOUT_STATS, _GPS_LAYOUT_DEFERRED, _GPS_LAYOUT_SENTENCE) {};
+typedef _GPS_LAYOUT_NAME(_GPS_LAYOUT_ALTITUDE, _GPS_LAYOUT_SPEED, _GPS_LAYOUT_COURSE, _GPS_LAYOUT_HDOP,
+  _GPS_LAYOUT_SATELLITES, _GPS_LAYOUT_STATS, _GPS_LAYOUT_DEFERRED, _GPS_LAYOUT_SENTENCE) TinyGPSLayout;
+
+// Orders the fix sequence counter against the fields it guards. An AVR
+// has one core and only needs the compiler kept from reordering.
+#if defined(__AVR__)
+#define _GPS_WRITE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#define _GPS_READ_BARRIER() __asm__ __volatile__("" ::: "memory")
+#elif defined(__ATOMIC_ACQUIRE)
+#define _GPS_WRITE_BARRIER() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define _GPS_READ_BARRIER() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+#define _GPS_WRITE_BARRIER() __sync_synchronize()
+#define _GPS_READ_BARRIER() __sync_synchronize()
+#endif
+
+#if __cplusplus >= 201103L
+#define _GPS_CONSTEXPR constexpr
+#else
+#define _GPS_CONSTEXPR inline
+#endif
+
+struct TinyGPSSentence;
+
+// a committed fix, same units as the TinyGPS accessors; fields compiled
+// out of TinyGPS (see _GPS_NO_ALTITUDE etc.) stay invalid
+struct TinyGPSFix
+{
+  unsigned long time, date;
+  long latitude, longitude, altitude;
+  unsigned long speed, course, hdop;
+  unsigned short satellites;
+  unsigned long time_fix, position_fix;
+};
 
 class TinyGPS
 {
@@ -51,10 +148,14 @@ public:
     GPS_INVALID_HDOP = 0xFFFFFFFF
   };
 
+#ifndef _GPS_NO_FLOAT
   static const float GPS_INVALID_F_ANGLE, GPS_INVALID_F_ALTITUDE, GPS_INVALID_F_SPEED;
+#endif
 
-  TinyGPS();
+  TinyGPS(TinyGPSLayout = TinyGPSLayout());
   bool encode(char c); // process one character received from GPS
+  unsigned encode(const char *buf, size_t len); // process a block of characters, returns number of valid sentences
+  bool encode(const TinyGPSSentence &sentence); // process a checksummed sentence from TinyGPSScanner
   TinyGPS &operator << (char c) {encode(c); return *this;}
 
   // lat/long in MILLIONTHs of a degree and age of fix in milliseconds
@@ -64,58 +165,149 @@ public:
   // date as ddmmyy, time as hhmmsscc, and age in milliseconds
   void get_datetime(unsigned long *date, unsigned long *time, unsigned long *age = 0);
 
-  // signed altitude in centimeters (from GPGGA sentence)
+  // Every field of the last committed fix, read as one snapshot. Safe to
+  // call from other threads, or outside an interrupt handler that calls
+  // encode(), while one writer keeps encoding: a sentence committed during
+  // the copy makes it start again instead of mixing two fixes. The pairs
+  // from get_position() and get_datetime() are read the same way; the
+  // single-field accessors are not.
+  void get_fix(TinyGPSFix *fix);
+
+#ifndef _GPS_NO_ALTITUDE
+  // signed altitude in centimeters (from GGA sentence)
   inline long altitude() { return _altitude; }
+#endif
 
-  // course in last full GPRMC sentence in 100th of a degree
+#ifndef _GPS_NO_COURSE
+  // course in last full RMC or VTG sentence in 100th of a degree
   inline unsigned long course() { return _course; }
+#endif
 
-  // speed in last full GPRMC sentence in 100ths of a knot
+#ifndef _GPS_NO_SPEED
+  // speed in last full RMC or VTG sentence in 100ths of a knot
   inline unsigned long speed() { return _speed; }
+#endif
 
-  // satellites used in last full GPGGA sentence
+#ifndef _GPS_NO_SATELLITES
+  // satellites used in last full GGA sentence
   inline unsigned short satellites() { return _numsats; }
+#endif
 
-  // horizontal dilution of precision in 100ths
+#ifndef _GPS_NO_HDOP
+  // horizontal dilution of precision in 100ths (from GGA or GSA sentence)
   inline unsigned long hdop() { return _hdop; }
+#endif
 
-  void f_get_position(float *latitude, float *longitude, unsigned long *fix_age = 0);
   void crack_datetime(int *year, byte *month, byte *day, 
     byte *hour, byte *minute, byte *second, byte *hundredths = 0, unsigned long *fix_age = 0);
+
+  // milliseconds since 1970-01-01 00:00 UTC, reading yy as 1981 to 2080 like
+  // crack_datetime(); 0 without a valid date and time
+  unsigned long long get_epoch_ms(unsigned long *age = 0);
+  // the same for count ddmmyy and hhmmsscc pairs, such as logged fixes
+  static void epochs_ms(const unsigned long *date, const unsigned long *time, size_t count,
+    unsigned long long *epoch_ms);
+  // days from 1970-01-01 to a date of the proleptic Gregorian calendar,
+  // negative before it; usable in constant expressions
+  static _GPS_CONSTEXPR long days_from_civil(int year, byte month, byte day)
+    { return civil_days(year - (month <= 2), month, day); }
+#ifndef _GPS_NO_FLOAT
+  void f_get_position(float *latitude, float *longitude, unsigned long *fix_age = 0);
+#ifndef _GPS_NO_ALTITUDE
   float f_altitude();
+#endif
+#ifndef _GPS_NO_COURSE
   float f_course();
+#endif
+#ifndef _GPS_NO_SPEED
   float f_speed_knots();
   float f_speed_mph();
   float f_speed_mps();
   float f_speed_kmph();
+#endif
+#endif
 
   static int library_version() { return _GPS_VERSION; }
 
+  // millisecond clock used to time stamp and age fixes, millis() by default;
+  // a replay can substitute its own to run faster than real time
+  static void set_clock(unsigned long (*clock)()) { _clock = clock ? clock : millis; }
+
   static float distance_between (float lat1, float long1, float lat2, float long2);
   static float course_to (float lat1, float long1, float lat2, float long2);
+
+  // distance_between() in metres and course_to() in hundredths of a degree,
+  // in integers on the millionths of a degree from get_position(). Points
+  // within _GPS_FLAT_LIMIT of each other are measured on a flat earth from
+  // cosine and arctangent tables, to within 0.03% + 0.5 m and 0.02 degrees;
+  // points further apart, or nearer a pole than _GPS_FLAT_POLE, go to the
+  // float versions.
+  static unsigned long distance_between_fixed (long lat1, long long1, long lat2, long long2);
+  static unsigned long course_to_fixed (long lat1, long long1, long lat2, long long2);
   static const char *cardinal(float course);
 
+  // distance_between and course_to for each leg of a track of count points
+  // given as separate latitude and longitude arrays. Any of the count - 1
+  // element outputs may be null; cumulative[i] is the distance travelled
+  // from the first point to the end of leg i.
+  static void distances_between (const float *lat, const float *lon, size_t count,
+    float *distance, float *course, float *cumulative);
+  static void distances_between (const double *lat, const double *lon, size_t count,
+    double *distance, double *course, double *cumulative);
+
 #ifndef _GPS_NO_STATS
-  void stats(unsigned long *chars, unsigned short *good_sentences, unsigned short *failed_cs);
+  // dropped counts characters lost to a full TinyGPSRing before they reached encode()
+  void stats(unsigned long *chars, unsigned short *good_sentences, unsigned short *failed_cs,
+    unsigned long *dropped = 0);
 #endif
 
 private:
-  enum {_GPS_SENTENCE_GPGGA, _GPS_SENTENCE_GPRMC, _GPS_SENTENCE_OTHER};
+  friend class TinyGPSFleet;
+  friend class TinyGPSUBX;
+  template <unsigned N> friend class TinyGPSRing;
+
+  enum {
+    _GPS_SENTENCE_GGA, _GPS_SENTENCE_RMC, _GPS_SENTENCE_GLL,
+    _GPS_SENTENCE_VTG, _GPS_SENTENCE_GSA, _GPS_SENTENCE_ZDA,
+    _GPS_SENTENCE_OTHER
+  };
 
   // properties
   unsigned long _time, _new_time;
   unsigned long _date, _new_date;
   long _latitude, _new_latitude;
   long _longitude, _new_longitude;
+#ifndef _GPS_NO_ALTITUDE
   long _altitude, _new_altitude;
+#endif
+#ifndef _GPS_NO_SPEED
   unsigned long  _speed, _new_speed;
+#endif
+#ifndef _GPS_NO_COURSE
   unsigned long  _course, _new_course;
+#endif
+#ifndef _GPS_NO_HDOP
   unsigned long  _hdop, _new_hdop;
+#endif
+#ifndef _GPS_NO_SATELLITES
   unsigned short _numsats, _new_numsats;
+#endif
 
   unsigned long _last_time_fix, _new_time_fix;
   unsigned long _last_position_fix, _new_position_fix;
 
+  // odd while commit() is writing the fields above. A byte on the AVR,
+  // where it must be read in one instruction; readers there are only
+  // interrupted by encode(), which cannot commit 128 sentences meanwhile.
+#ifdef __AVR__
+  typedef byte sequence;
+#else
+  typedef unsigned long sequence;
+#endif
+  volatile sequence _sequence;
+
+  static unsigned long (*_clock)();
+
   // parsing state variables
   byte _parity;
   bool _is_checksum_term;
@@ -125,22 +317,70 @@ private:
   byte _term_offset;
   bool _gps_data_good;
 
+#ifdef _GPS_DEFERRED_PARSE
+  // the sentence so far, or _GPS_SENTENCE_DROPPED until the next '$'
+  enum { _GPS_SENTENCE_DROPPED = 0xFF };
+  char _sentence[_GPS_SENTENCE_SIZE];
+  byte _sentence_length;
+#endif
+
 #ifndef _GPS_NO_STATS
   // statistics
   unsigned long _encoded_characters;
   unsigned short _good_sentences;
   unsigned short _failed_checksum;
   unsigned short _passed_checksum;
+  unsigned long _dropped_characters;
 #endif
 
   // internal utilities
+  void begin_sentence();
+  bool end_term(char c);
+  void append_term(const char *s, size_t len);
+  static size_t find_delimiter(const char *s, size_t len, char separator);
+  static byte xor_span(const char *s, size_t len);
   int from_hex(char a);
   unsigned long parse_decimal();
   unsigned long parse_degrees();
   bool term_complete();
-  bool gpsisdigit(char c) { return c >= '0' && c <= '9'; }
+  bool commit();
+  void begin_publish() { _sequence = _sequence + 1; _GPS_WRITE_BARRIER(); }
+  void end_publish() { _GPS_WRITE_BARRIER(); _sequence = _sequence + 1; }
+  sequence begin_read()
+  {
+    sequence s;
+    while ((s = _sequence) & 1)
+      ;
+    _GPS_READ_BARRIER();
+    return s;
+  }
+  bool retry_read(sequence s) { _GPS_READ_BARRIER(); return _sequence != s; }
+#ifdef _GPS_DEFERRED_PARSE
+  void append_sentence(const char *s, size_t len);
+  void append_sentence(char c)
+  {
+    if (_sentence_length < sizeof(_sentence))
+    {
+      _sentence[_sentence_length++] = c;
+      _parity ^= c;
+    }
+    else
+      _sentence_length = _GPS_SENTENCE_DROPPED;
+  }
+  bool parse_sentence();
+#endif
+  static bool gpsisdigit(char c) { return c >= '0' && c <= '9'; }
   long gpsatol(const char *str);
-  int gpsstrcmp(const char *str1, const char *str2);
+  static unsigned long parse_digits(const char *str, byte max, byte *n);
+  // days_from_civil() with the year starting in March, after Howard Hinnant
+  static _GPS_CONSTEXPR long civil_era(long y) { return (y >= 0 ? y : y - 399) / 400; }
+  static _GPS_CONSTEXPR long civil_year_days(long yoe) { return yoe * 365 + yoe / 4 - yoe / 100; }
+  static _GPS_CONSTEXPR long civil_days(long y, byte m, byte d)
+  {
+    return civil_era(y) * 146097 + civil_year_days(y - civil_era(y) * 400)
+      + (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1 - 719468;
+  }
+  byte sentence_type();
 };
 
 #if !defined(ARDUINO) 
@@ -0,0 +1,43 @@
+/*
+TinyGPSConfig - build options of TinyGPS
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSConfig_h
+#define TinyGPSConfig_h
+
+// These options change the members of TinyGPS and of the classes built on
+// it, so TinyGPS.cpp and every file including TinyGPS.h must agree on
+// them. Set them here, or with -D for the whole build; a #define in a
+// sketch ahead of #include <TinyGPS.h> does not reach TinyGPS.cpp. A file
+// built with other settings than the library fails to link, with an
+// undefined reference to a constructor taking a TinyGPSLayout_... argument.
+
+// #define _GPS_NO_STATS
+
+// Fields, sentences and the float accessors that are not needed can be
+// compiled out to save RAM and cycles; their accessors go with them.
+// #define _GPS_NO_ALTITUDE
+// #define _GPS_NO_SPEED
+// #define _GPS_NO_COURSE
+// #define _GPS_NO_HDOP
+// #define _GPS_NO_SATELLITES
+// #define _GPS_NO_FLOAT
+// #define _GPS_NO_GGA
+// #define _GPS_NO_RMC
+// #define _GPS_NO_GLL
+// #define _GPS_NO_VTG
+// #define _GPS_NO_GSA
+// #define _GPS_NO_ZDA
+
+// Buffer each sentence and parse its fields only after its checksum has
+// passed, so corrupted sentences on a noisy link cost a copy and a parity
+// check rather than a full parse. Takes _GPS_SENTENCE_SIZE more bytes of
+// RAM; a sentence longer than that is dropped as soon as it overflows.
+// Fix times are taken when the sentence ends rather than at its time term.
+// #define _GPS_DEFERRED_PARSE
+// #define _GPS_SENTENCE_SIZE 80 // characters between '$' and '*', a plain number up to 254
+
+#endif
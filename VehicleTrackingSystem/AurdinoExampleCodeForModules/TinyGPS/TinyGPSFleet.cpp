@@ -0,0 +1,232 @@
+/*
+TinyGPSFleet - decodes many interleaved NMEA streams with one TinyGPS parser
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSFleet.h"
+#include <string.h>
+
+#define _GPS_NO_STREAM 0xFFFF
+
+TinyGPSFleet::TinyGPSFleet(unsigned short streams, TinyGPSLayout)
+  :  _streams(streams)
+  ,  _loaded(_GPS_NO_STREAM)
+  ,  _parsers((parser_state *)malloc(streams * sizeof(parser_state)))
+  ,  _staged((staged_fields *)calloc(streams, sizeof(staged_fields)))
+  ,  _fixes((TinyGPSFix *)malloc(streams * sizeof(TinyGPSFix)))
+  ,  _pending((byte *)calloc(streams, sizeof(byte)))
+  ,  _pending_list((unsigned short *)malloc(streams * sizeof(unsigned short)))
+  ,  _pending_count(0)
+{
+  if (!_parsers || !_staged || !_fixes || !_pending || !_pending_list)
+  {
+    _streams = 0;
+    return;
+  }
+
+  // every stream starts out like a freshly constructed TinyGPS
+  parser_state p;
+  memset(&p, 0, sizeof(p));
+  p.sentence_type = TinyGPS::_GPS_SENTENCE_OTHER;
+#ifdef _GPS_DEFERRED_PARSE
+  p.sentence_length = TinyGPS::_GPS_SENTENCE_DROPPED;
+#endif
+
+  TinyGPSFix f;
+  f.time         = TinyGPS::GPS_INVALID_TIME;
+  f.date         = TinyGPS::GPS_INVALID_DATE;
+  f.latitude     = TinyGPS::GPS_INVALID_ANGLE;
+  f.longitude    = TinyGPS::GPS_INVALID_ANGLE;
+  f.altitude     = TinyGPS::GPS_INVALID_ALTITUDE;
+  f.speed        = TinyGPS::GPS_INVALID_SPEED;
+  f.course       = TinyGPS::GPS_INVALID_ANGLE;
+  f.hdop         = TinyGPS::GPS_INVALID_HDOP;
+  f.satellites   = TinyGPS::GPS_INVALID_SATELLITES;
+  f.time_fix     = TinyGPS::GPS_INVALID_FIX_TIME;
+  f.position_fix = TinyGPS::GPS_INVALID_FIX_TIME;
+
+  for (unsigned short i = 0; i < _streams; ++i)
+  {
+    _parsers[i] = p;
+    _fixes[i] = f;
+  }
+}
+
+TinyGPSFleet::~TinyGPSFleet()
+{
+  free(_parsers);
+  free(_staged);
+  free(_fixes);
+  free(_pending);
+  free(_pending_list);
+}
+
+unsigned TinyGPSFleet::encode(unsigned short stream, const char *buf, size_t len)
+{
+  if (stream >= _streams)
+    return 0;
+
+  if (_loaded != stream)
+    load(stream);
+  unsigned valid_sentences = _engine.encode(buf, len);
+  store(stream, valid_sentences != 0);
+
+  if (valid_sentences && !_pending[stream])
+  {
+    _pending[stream] = 1;
+    _pending_list[_pending_count++] = stream;
+  }
+  return valid_sentences;
+}
+
+unsigned short TinyGPSFleet::poll(const unsigned short **streams)
+{
+  unsigned short count = _pending_count;
+
+  for (unsigned short i = 0; i < count; ++i)
+    _pending[_pending_list[i]] = 0;
+  _pending_count = 0;
+
+  if (streams) *streams = _pending_list;
+  return count;
+}
+
+//
+// internal utilities
+//
+
+// Moves one stream's state into the engine
+void TinyGPSFleet::load(unsigned short stream)
+{
+  const parser_state &p = _parsers[stream];
+  memcpy(_engine._term, p.term, sizeof(p.term));
+  _engine._parity           = p.parity;
+  _engine._sentence_type    = p.sentence_type;
+  _engine._term_number      = p.term_number;
+  _engine._term_offset      = p.term_offset;
+  _engine._is_checksum_term = p.is_checksum_term;
+  _engine._gps_data_good    = p.gps_data_good;
+#ifdef _GPS_DEFERRED_PARSE
+  _engine._sentence_length  = p.sentence_length;
+  if (p.sentence_length != TinyGPS::_GPS_SENTENCE_DROPPED)
+    memcpy(_engine._sentence, p.sentence, p.sentence_length);
+#endif
+
+  const staged_fields &s = _staged[stream];
+  _engine._new_time          = s.time;
+  _engine._new_date          = s.date;
+  _engine._new_latitude      = s.latitude;
+  _engine._new_longitude     = s.longitude;
+#ifndef _GPS_NO_ALTITUDE
+  _engine._new_altitude      = s.altitude;
+#endif
+#ifndef _GPS_NO_SPEED
+  _engine._new_speed         = s.speed;
+#endif
+#ifndef _GPS_NO_COURSE
+  _engine._new_course        = s.course;
+#endif
+#ifndef _GPS_NO_HDOP
+  _engine._new_hdop          = s.hdop;
+#endif
+#ifndef _GPS_NO_SATELLITES
+  _engine._new_numsats       = s.satellites;
+#endif
+  _engine._new_time_fix      = s.time_fix;
+  _engine._new_position_fix  = s.position_fix;
+
+  // a sentence may commit only some of the fields
+  const TinyGPSFix &f = _fixes[stream];
+  _engine._time              = f.time;
+  _engine._date              = f.date;
+  _engine._latitude          = f.latitude;
+  _engine._longitude         = f.longitude;
+#ifndef _GPS_NO_ALTITUDE
+  _engine._altitude          = f.altitude;
+#endif
+#ifndef _GPS_NO_SPEED
+  _engine._speed             = f.speed;
+#endif
+#ifndef _GPS_NO_COURSE
+  _engine._course            = f.course;
+#endif
+#ifndef _GPS_NO_HDOP
+  _engine._hdop              = f.hdop;
+#endif
+#ifndef _GPS_NO_SATELLITES
+  _engine._numsats           = f.satellites;
+#endif
+  _engine._last_time_fix     = f.time_fix;
+  _engine._last_position_fix = f.position_fix;
+
+  _loaded = stream;
+}
+
+// Moves the engine's state back into one stream's slots
+void TinyGPSFleet::store(unsigned short stream, bool committed)
+{
+  parser_state &p = _parsers[stream];
+  memcpy(p.term, _engine._term, sizeof(p.term));
+  p.parity           = _engine._parity;
+  p.sentence_type    = _engine._sentence_type;
+  p.term_number      = _engine._term_number;
+  p.term_offset      = _engine._term_offset;
+  p.is_checksum_term = _engine._is_checksum_term;
+  p.gps_data_good    = _engine._gps_data_good;
+#ifdef _GPS_DEFERRED_PARSE
+  p.sentence_length  = _engine._sentence_length;
+  if (p.sentence_length != TinyGPS::_GPS_SENTENCE_DROPPED)
+    memcpy(p.sentence, _engine._sentence, p.sentence_length);
+#endif
+
+  staged_fields &s = _staged[stream];
+  s.time         = _engine._new_time;
+  s.date         = _engine._new_date;
+  s.latitude     = _engine._new_latitude;
+  s.longitude    = _engine._new_longitude;
+#ifndef _GPS_NO_ALTITUDE
+  s.altitude     = _engine._new_altitude;
+#endif
+#ifndef _GPS_NO_SPEED
+  s.speed        = _engine._new_speed;
+#endif
+#ifndef _GPS_NO_COURSE
+  s.course       = _engine._new_course;
+#endif
+#ifndef _GPS_NO_HDOP
+  s.hdop         = _engine._new_hdop;
+#endif
+#ifndef _GPS_NO_SATELLITES
+  s.satellites   = _engine._new_numsats;
+#endif
+  s.time_fix     = _engine._new_time_fix;
+  s.position_fix = _engine._new_position_fix;
+
+  if (committed)
+  {
+    TinyGPSFix &f = _fixes[stream];
+    f.time         = _engine._time;
+    f.date         = _engine._date;
+    f.latitude     = _engine._latitude;
+    f.longitude    = _engine._longitude;
+#ifndef _GPS_NO_ALTITUDE
+    f.altitude     = _engine._altitude;
+#endif
+#ifndef _GPS_NO_SPEED
+    f.speed        = _engine._speed;
+#endif
+#ifndef _GPS_NO_COURSE
+    f.course       = _engine._course;
+#endif
+#ifndef _GPS_NO_HDOP
+    f.hdop         = _engine._hdop;
+#endif
+#ifndef _GPS_NO_SATELLITES
+    f.satellites   = _engine._numsats;
+#endif
+    f.time_fix     = _engine._last_time_fix;
+    f.position_fix = _engine._last_position_fix;
+  }
+}
@@ -0,0 +1,376 @@
+/*
+TinyGPSGeofence - circle and polygon geofences with a grid index
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSGeofence_h
+#define TinyGPSGeofence_h
+
+#include "TinyGPS.h"
+#include <math.h>
+
+#define _GPS_FENCE_DEFAULT_UNIT 10      // millionths of a degree, about 1.1 m
+#define _GPS_METERS_PER_MILLIONTH 0.1112263 // on the sphere distance_between() uses
+
+// Fences are stored as 16-bit offsets from an origin, in units of
+// unit millionths of a degree, so with the default unit they must lie
+// within about 36 km of it and no fence may be more than about 36 km
+// across. Each fence takes 8 bytes, each polygon vertex 4 (plus 8 per
+// polygon for its bounding box), each grid cell 2 and each cell entry 2.
+//
+// A grid of GRID x GRID cells over all the fences lists the fences that
+// reach into each cell, so a fix is only tested against the fences of
+// its own cell and those it is inside or being entered. A fence is
+// entered when the fix is inside it for debounce fixes in a row, and left
+// when it is outside for debounce fixes in a row; a circle also has to be
+// left by margin metres. Up to ACTIVE fences can be inside or being
+// entered at the same time.
+//
+// FENCES, VERTICES, ENTRIES (fence references over all cells), GRID and
+// ACTIVE are capacities, fixed at compile time like TinyGPSRing's.
+template <unsigned short FENCES, unsigned short VERTICES,
+  unsigned short ENTRIES = 2 * FENCES, byte GRID = 8, byte ACTIVE = 8>
+class TinyGPSGeofence
+{
+public:
+  // called for every transition
+  typedef void (*handler)(unsigned short fence, bool entered);
+
+  TinyGPSGeofence(long origin_lat, long origin_lon, handler on_transition,
+    unsigned margin = 10, byte debounce = 2, byte unit = _GPS_FENCE_DEFAULT_UNIT)
+    : _origin_lat(origin_lat), _origin_lon(origin_lon), _handler(on_transition)
+    , _unit(unit ? unit : 1), _debounce(debounce ? (debounce < 63 ? debounce : 63) : 1)
+    , _fence_count(0), _vertex_count(0), _active_count(0), _built(false)
+    , _last_fix(TinyGPS::GPS_INVALID_FIX_TIME)
+  {
+    _cos_lat = (unsigned short)(cos(radians(origin_lat / 1000000.0)) * 32768.0 + 0.5);
+    if (_cos_lat > 32767) _cos_lat = 32767;
+    _margin = to_units(margin);
+  }
+
+  // lat/lon in millionths of a degree, radius in metres;
+  // return the fence id, or -1 if it does not fit
+  int add_circle(long lat, long lon, unsigned long radius)
+  {
+    long x, y;
+    unsigned long r = to_units(radius);
+    if (_fence_count == FENCES || !to_grid(lat, lon, &x, &y) || r + _margin > 0x7FFF)
+      return -1;
+
+    fence &f = _fences[_fence_count];
+    f.x = (short)x;
+    f.y = (short)y;
+    f.r_or_first = (unsigned short)r;
+    f.count = 0;
+    f.state = 0;
+    _built = false;
+    return _fence_count++;
+  }
+
+  int add_polygon(const long *lat, const long *lon, byte count)
+  {
+    if (_fence_count == FENCES || count < 3 || _vertex_count + 2 + count > VERTICES)
+      return -1;
+
+    vertex *v = _vertices + _vertex_count;
+    long x0 = 0x7FFF, y0 = 0x7FFF, x1 = -0x7FFF, y1 = -0x7FFF;
+    for (byte i = 0; i < count; ++i)
+    {
+      long x, y;
+      if (!to_grid(lat[i], lon[i], &x, &y))
+        return -1;
+      v[2 + i].x = (short)x;
+      v[2 + i].y = (short)y;
+      if (x < x0) x0 = x;
+      if (x > x1) x1 = x;
+      if (y < y0) y0 = y;
+      if (y > y1) y1 = y;
+    }
+
+    // keeps the edge tests within 32-bit arithmetic
+    if (x1 - x0 > 0x7FFF || y1 - y0 > 0x7FFF)
+      return -1;
+
+    v[0].x = (short)x0; v[0].y = (short)y0;
+    v[1].x = (short)x1; v[1].y = (short)y1;
+
+    fence &f = _fences[_fence_count];
+    f.r_or_first = _vertex_count;
+    f.count = count;
+    f.state = 0;
+    _vertex_count += 2 + count;
+    _built = false;
+    return _fence_count++;
+  }
+
+  // rebuild the grid after adding fences, false if ENTRIES is too small;
+  // update() does it when needed
+  bool build()
+  {
+    _built = true;
+    _cell_w = _cell_h = 0;
+    if (_fence_count == 0)
+      return true;
+
+    long x0 = 0x7FFF, y0 = 0x7FFF, x1 = -0x7FFF, y1 = -0x7FFF;
+    for (unsigned short i = 0; i < _fence_count; ++i)
+    {
+      long fx0, fy0, fx1, fy1;
+      bounds(_fences[i], &fx0, &fy0, &fx1, &fy1);
+      if (fx0 < x0) x0 = fx0;
+      if (fy0 < y0) y0 = fy0;
+      if (fx1 > x1) x1 = fx1;
+      if (fy1 > y1) y1 = fy1;
+    }
+    _grid_x = x0;
+    _grid_y = y0;
+    _cell_w = (unsigned short)((x1 - x0) / GRID + 1);
+    _cell_h = (unsigned short)((y1 - y0) / GRID + 1);
+
+    // count, then place, the fence references of every cell
+    memset(_cells, 0, sizeof(_cells));
+    for (unsigned short pass = 0; pass < 2; ++pass)
+    {
+      for (unsigned short i = 0; i < _fence_count; ++i)
+      {
+        long fx0, fy0, fx1, fy1;
+        bounds(_fences[i], &fx0, &fy0, &fx1, &fy1);
+        byte cx0 = cell_x(fx0), cx1 = cell_x(fx1), cy0 = cell_y(fy0), cy1 = cell_y(fy1);
+        for (byte cy = cy0; cy <= cy1; ++cy)
+          for (byte cx = cx0; cx <= cx1; ++cx)
+          {
+            unsigned short &c = _cells[cy * GRID + cx + (pass == 0)];
+            if (pass == 0)
+              ++c;
+            else if (c < ENTRIES)
+              _entries[c++] = i;
+          }
+      }
+
+      if (pass == 0)
+      {
+        for (unsigned short c = 1; c <= GRID * GRID; ++c)
+          _cells[c] += _cells[c - 1];
+        if (_cells[GRID * GRID] > ENTRIES)
+        {
+          _cell_w = _cell_h = 0;
+          return false;
+        }
+      }
+    }
+
+    // the placing pass left every cell start at the next one's; shift back
+    for (unsigned short c = GRID * GRID; c > 0; --c)
+      _cells[c] = _cells[c - 1];
+    _cells[0] = 0;
+    return true;
+  }
+
+  // test a fix against the fences, returns the number of transitions
+  byte update(long lat, long lon)
+  {
+    if (!_built)
+      build();
+
+    long x, y;
+    byte events = 0;
+
+    if (to_grid(lat, lon, &x, &y) && _cell_w && x >= _grid_x && y >= _grid_y
+      && (x - _grid_x) / _cell_w < GRID && (y - _grid_y) / _cell_h < GRID)
+    {
+      unsigned short c = cell_y(y) * GRID + cell_x(x);
+      for (unsigned short e = _cells[c]; e < _cells[c + 1]; ++e)
+        events += observe(_entries[e], contains(_fences[_entries[e]], x, y));
+    }
+
+    // fences entered (or being entered) that are not listed in this
+    // cell do not reach it, so the fix is certainly outside them
+    for (byte a = 0; a < _active_count; )
+    {
+      unsigned short id = _active[a];
+      if (!(_fences[id].state & _GPS_FENCE_SEEN))
+      {
+        events += observe(id, false);
+        if (a == _active_count || _active[a] != id)
+          continue;   // dropped, and the last one moved into its place
+      }
+      _fences[id].state &= ~_GPS_FENCE_SEEN;
+      ++a;
+    }
+    return events;
+  }
+
+  // test the latest position of a TinyGPS object, or a fix taken from
+  // one; a fix already tested, or without a position, gives no events
+  byte update(TinyGPS &gps)
+  {
+    TinyGPSFix fix;
+    gps.get_fix(&fix);
+    return update(fix);
+  }
+
+  byte update(const TinyGPSFix &fix)
+  {
+    if (fix.position_fix == TinyGPS::GPS_INVALID_FIX_TIME || fix.position_fix == _last_fix)
+      return 0;
+    _last_fix = fix.position_fix;
+    return update(fix.latitude, fix.longitude);
+  }
+
+  bool inside(unsigned short fence) { return _fences[fence].state & _GPS_FENCE_INSIDE; }
+  unsigned short fences() { return _fence_count; }
+
+private:
+  enum {_GPS_FENCE_INSIDE = 0x80, _GPS_FENCE_SEEN = 0x40, _GPS_FENCE_COUNT = 0x3F};
+
+  struct fence
+  {
+    short x, y;                   // circle centre
+    unsigned short r_or_first;    // circle radius, or first polygon vertex
+    byte count;                   // polygon vertices, 0 for a circle
+    byte state;                   // inside, seen this fix, debounce count
+  };
+
+  struct vertex
+  {
+    short x, y;
+  };
+
+  long _origin_lat, _origin_lon;
+  handler _handler;
+  byte _unit;
+  byte _debounce;
+  unsigned short _cos_lat;        // Q15
+  unsigned short _margin;
+
+  fence _fences[FENCES];
+  vertex _vertices[VERTICES];     // bounding box, then the vertices, of each polygon
+  unsigned short _fence_count, _vertex_count;
+
+  long _grid_x, _grid_y;
+  unsigned short _cell_w, _cell_h;
+  unsigned short _cells[GRID * GRID + 1];
+  unsigned short _entries[ENTRIES];
+
+  unsigned short _active[ACTIVE];
+  byte _active_count;
+  bool _built;
+  unsigned long _last_fix;        // position_fix of the last fix tested
+
+  unsigned long to_units(unsigned long meters)
+  {
+    return (unsigned long)(meters / (_GPS_METERS_PER_MILLIONTH * _unit) + 0.5);
+  }
+
+  bool to_grid(long lat, long lon, long *x, long *y)
+  {
+    *x = (lon - _origin_lon) / _unit;
+    *y = (lat - _origin_lat) / _unit;
+    return *x >= -0x7FFF && *x <= 0x7FFF && *y >= -0x7FFF && *y <= 0x7FFF;
+  }
+
+  byte cell_x(long x) { unsigned long c = (x - _grid_x) / _cell_w; return c < GRID ? c : GRID - 1; }
+  byte cell_y(long y) { unsigned long c = (y - _grid_y) / _cell_h; return c < GRID ? c : GRID - 1; }
+
+  void bounds(const fence &f, long *x0, long *y0, long *x1, long *y1)
+  {
+    if (f.count == 0)
+    {
+      // east-west units are shorter than north-south ones away from the equator
+      long ry = (long)f.r_or_first + _margin;
+      long rx = ((ry << 15) + _cos_lat - 1) / _cos_lat;
+      *x0 = f.x - rx; *x1 = f.x + rx;
+      *y0 = f.y - ry; *y1 = f.y + ry;
+    }
+    else
+    {
+      const vertex *v = _vertices + f.r_or_first;
+      *x0 = v[0].x; *y0 = v[0].y;
+      *x1 = v[1].x; *y1 = v[1].y;
+    }
+  }
+
+  bool contains(const fence &f, long x, long y)
+  {
+    if (f.count == 0)
+    {
+      unsigned long r = f.r_or_first;
+      if (f.state & _GPS_FENCE_INSIDE)
+        r += _margin;
+      long dy = y - f.y;
+      long dx = ((x - f.x) * (long)_cos_lat) >> 15;
+      if (dx < -(long)r || dx > (long)r || dy < -(long)r || dy > (long)r)
+        return false;
+      return (unsigned long)(dx * dx) + (unsigned long)(dy * dy) <= r * r;
+    }
+
+    const vertex *v = _vertices + f.r_or_first;
+    if (x < v[0].x || x > v[1].x || y < v[0].y || y > v[1].y)
+      return false;
+
+    // crossing number; every difference is bounded by the box
+    bool in = false;
+    v += 2;
+    for (byte i = 0, j = f.count - 1; i < f.count; j = i++)
+    {
+      if ((v[i].y > y) != (v[j].y > y))
+      {
+        long lhs = (x - v[i].x) * (long)(v[j].y - v[i].y);
+        long rhs = (long)(v[j].x - v[i].x) * (y - v[i].y);
+        if ((v[j].y > v[i].y) ? lhs < rhs : lhs > rhs)
+          in = !in;
+      }
+    }
+    return in;
+  }
+
+  // one more observation of a fence, returns 1 if it made a transition
+  byte observe(unsigned short id, bool in)
+  {
+    fence &f = _fences[id];
+    byte old = f.state & ~_GPS_FENCE_SEEN;
+    bool was_in = old & _GPS_FENCE_INSIDE;
+    byte count = old & _GPS_FENCE_COUNT;
+    bool changed = false;
+    byte state;
+
+    if (in == was_in)
+      state = old & _GPS_FENCE_INSIDE;
+    else if (++count >= _debounce)
+    {
+      state = in ? _GPS_FENCE_INSIDE : 0;
+      changed = true;
+    }
+    else
+      state = (old & _GPS_FENCE_INSIDE) | count;
+
+    // fences with anything but a plain "outside" are tracked until they are
+    if (state && !old)
+    {
+      if (_active_count == ACTIVE)
+        return 0;   // no room: the fence stays outside
+      _active[_active_count++] = id;
+    }
+    else if (!state && old)
+      forget(id);
+
+    f.state = state | _GPS_FENCE_SEEN;
+    if (changed && _handler)
+      _handler(id, in);
+    return changed;
+  }
+
+  void forget(unsigned short id)
+  {
+    for (byte a = 0; a < _active_count; ++a)
+      if (_active[a] == id)
+      {
+        _active[a] = _active[--_active_count];
+        return;
+      }
+  }
+};
+
+#endif
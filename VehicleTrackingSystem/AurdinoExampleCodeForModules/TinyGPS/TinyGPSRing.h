@@ -0,0 +1,143 @@
+/*
+TinyGPSRing - lock-free single-producer/single-consumer character ring
+that feeds TinyGPS in bulk
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSRing_h
+#define TinyGPSRing_h
+
+#include "TinyGPS.h"
+
+// The producer (a receive ISR on the device, a reader thread on a host)
+// calls put(); the consumer calls drain() whenever it gets around to it,
+// which hands everything received so far to TinyGPS::encode() in at most
+// two contiguous spans. Neither side ever waits for the other. Characters
+// arriving while the ring is full are dropped and counted; drain() adds
+// them to the "dropped" count reported by TinyGPS::stats().
+//
+// N must be a power of two; on AVR it is limited to 128 so that the
+// indices fit in a byte and are read and written atomically.
+template <unsigned N>
+class TinyGPSRing
+{
+public:
+  TinyGPSRing() : _head(0), _tail(0), _overflows(0), _reported(0) {}
+
+  // producer side: queue one character, false if the ring was full
+  bool put(char c)
+  {
+    index head = _head;
+    if ((index)(head - load_acquire(_tail)) == N)
+    {
+      store_release(_overflows, _overflows + 1);
+      return false;
+    }
+    _buf[head & (N - 1)] = c;
+    store_release(_head, (index)(head + 1));
+    return true;
+  }
+
+  // producer side: queue a block, returns how many characters fitted
+  size_t put(const char *buf, size_t len)
+  {
+    index head = _head;
+    size_t room = N - (index)(head - load_acquire(_tail));
+    size_t n = len < room ? len : room;
+    for (size_t i = 0; i < n; ++i)
+      _buf[(index)(head + i) & (N - 1)] = buf[i];
+    if (n < len)
+      store_release(_overflows, _overflows + (len - n));
+    store_release(_head, (index)(head + n));
+    return n;
+  }
+
+  // consumer side: characters waiting to be drained
+  size_t available() { return (index)(load_acquire(_head) - _tail); }
+
+  // consumer side: feed everything queued so far to gps,
+  // returns the number of valid sentences it completed
+  unsigned drain(TinyGPS &gps)
+  {
+    index head = load_acquire(_head);
+    index tail = _tail;
+    unsigned valid_sentences = 0;
+
+    while (tail != head)
+    {
+      size_t start = tail & (N - 1);
+      size_t len = (index)(head - tail);
+      if (len > N - start)
+        len = N - start;
+      valid_sentences += gps.encode(_buf + start, len);
+      tail += len;
+    }
+    store_release(_tail, tail);
+
+#ifndef _GPS_NO_STATS
+    unsigned long overflows = load_overflows();
+    gps._dropped_characters += overflows - _reported;
+    _reported = overflows;
+#endif
+    return valid_sentences;
+  }
+
+  // characters dropped because the ring was full
+  unsigned long overflows() { return load_overflows(); }
+
+  static unsigned capacity() { return N; }
+
+private:
+#if defined(__AVR__)
+  typedef byte index;
+  typedef char _capacity_must_be_a_power_of_two_up_to_128[(N & (N - 1)) == 0 && N <= 128 ? 1 : -1];
+#else
+  typedef unsigned index;
+  typedef char _capacity_must_be_a_power_of_two[(N & (N - 1)) == 0 && N > 0 ? 1 : -1];
+#endif
+
+  char _buf[N];
+  index _head;                // written by the producer only
+  index _tail;                // written by the consumer only
+  unsigned long _overflows;   // written by the producer only
+  unsigned long _reported;    // overflows already added to the TinyGPS stats
+
+  template <typename T> static T load_acquire(const T &v)
+  {
+#if defined(__AVR__)
+    T r = *(volatile const T *)&v;
+    __asm__ __volatile__ ("" ::: "memory");
+    return r;
+#else
+    return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+#endif
+  }
+
+  template <typename T> static void store_release(T &v, T value)
+  {
+#if defined(__AVR__)
+    __asm__ __volatile__ ("" ::: "memory");
+    *(volatile T *)&v = value;
+#else
+    __atomic_store_n(&v, value, __ATOMIC_RELEASE);
+#endif
+  }
+
+  unsigned long load_overflows()
+  {
+#if defined(__AVR__)
+    // four bytes written from an ISR: read them with interrupts held off
+    byte sreg = SREG;
+    cli();
+    unsigned long overflows = _overflows;
+    SREG = sreg;
+    return overflows;
+#else
+    return load_acquire(_overflows);
+#endif
+  }
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+TinyGPSSentence - checksummed NMEA sentences as views into the caller's
+buffer, for sentences TinyGPS does not model
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSSentence_h
+#define TinyGPSSentence_h
+
+#include "TinyGPS.h"
+#include <string.h>
+
+// A sentence that has passed its checksum: the characters between '$'
+// and '*', and where each of its terms starts. Term 0 is the address,
+// such as "GPRMC" or "PUBX". Terms are not terminated; use term_length().
+struct TinyGPSSentence
+{
+  const char *body;
+  const byte *offsets;
+  byte length;
+  byte terms;
+
+  const char *term(byte i) const { return body + offsets[i]; }
+  byte term_length(byte i) const
+    { return (i + 1 < terms ? offsets[i + 1] - 1 : length) - offsets[i]; }
+
+  // is the address type, or any two-letter talker id followed by type?
+  // is("RMC") matches $GPRMC and $GNRMC, is("PUBX") matches $PUBX
+  bool is(const char *type) const
+  {
+    byte n = strlen(type), address = term_length(0);
+    if (address == n + 2 && body[0] != 'P')
+      return memcmp(body + 2, type, n) == 0;
+    return address == n && memcmp(body, type, n) == 0;
+  }
+};
+
+// Finds the sentences in the buffers passed to scan() and hands each one
+// whose checksum matches to the handler, as a view into that buffer
+// valid for the duration of the call. Only a sentence split across two
+// calls is copied, into a SIZE byte line buffer. Bodies longer than SIZE
+// or with more than TERMS terms are dropped. To keep the built-in fields
+// up to date as well, pass the sentence on to TinyGPS::encode():
+//
+//   void handle(const TinyGPSSentence &sentence)
+//   {
+//     if (sentence.is("PUBX"))
+//       ...
+//     gps.encode(sentence);
+//   }
+//   TinyGPSScanner<> scanner(handle);
+template <byte SIZE = 120, byte TERMS = 32>
+class TinyGPSScanner
+{
+public:
+  TinyGPSScanner(void (*handler)(const TinyGPSSentence &sentence))
+    : _handler(handler), _state(IDLE), _length(0), _terms(0), _parity(0), _hex(0), _failed(0) {}
+
+  // returns the number of sentences handed to the handler
+  unsigned scan(const char *buf, size_t len)
+  {
+    const char *end = buf + len;
+    const char *p = buf;
+    unsigned valid = 0;
+
+    // finish a sentence begun in an earlier buffer
+    while (_state != IDLE && p < end)
+      valid += resume(*p++);
+
+    while (p < end)
+    {
+      p = (const char *)memchr(p, '$', end - p);
+      if (!p)
+        break;
+      const char *body = ++p;
+      _parity = 0;
+      _terms = 1;
+      _offsets[0] = 0;
+      for (; p < end && p - body < SIZE; ++p)
+      {
+        char c = *p;
+        if (c == '*' || c == '$' || c == '\r' || c == '\n')
+          break;
+        if (c == ',' && !add_term(p - body + 1))
+          break;
+        _parity ^= c;
+      }
+      _length = p - body;
+
+      if (p == end || (*p == '*' && end - p < 3))
+      {
+        // carry what there is over to the next buffer
+        memcpy(_line, body, _length);
+        _state = BODY;
+        while (p < end)
+          valid += resume(*p++);
+        break;
+      }
+      if (*p != '*')
+        continue;
+      if (checksum(p[1], p[2]))
+      {
+        dispatch(body);
+        ++valid;
+      }
+      p += 3;
+    }
+    return valid;
+  }
+
+  // sentences whose checksum did not match
+  unsigned short failed_checksum() { return _failed; }
+
+private:
+  enum { IDLE, BODY, HEX1, HEX2 };
+
+  void (*_handler)(const TinyGPSSentence &sentence);
+  byte _state;
+  byte _length;
+  byte _terms;
+  byte _parity;
+  char _hex;
+  unsigned short _failed;
+  byte _offsets[TERMS];
+  char _line[SIZE];
+
+  bool add_term(byte offset)
+  {
+    if (_terms == TERMS)
+      return false;
+    _offsets[_terms++] = offset;
+    return true;
+  }
+
+  static int from_hex(char a)
+  {
+    if (a >= 'A' && a <= 'F')
+      return a - 'A' + 10;
+    if (a >= 'a' && a <= 'f')
+      return a - 'a' + 10;
+    if (a >= '0' && a <= '9')
+      return a - '0';
+    return -1;
+  }
+
+  bool checksum(char a, char b)
+  {
+    int hi = from_hex(a), lo = from_hex(b);
+    if (hi >= 0 && lo >= 0 && (byte)(16 * hi + lo) == _parity)
+      return true;
+    ++_failed;
+    return false;
+  }
+
+  void dispatch(const char *body)
+  {
+    TinyGPSSentence sentence = { body, _offsets, _length, _terms };
+    _handler(sentence);
+  }
+
+  // one character of a sentence that is being carried over in _line
+  unsigned resume(char c)
+  {
+    if (c == '$')
+    {
+      _state = BODY;
+      _length = _parity = 0;
+      _terms = 1;
+      _offsets[0] = 0;
+      return 0;
+    }
+
+    switch (_state)
+    {
+    case BODY:
+      if (c == '*')
+        _state = HEX1;
+      else if (c == '\r' || c == '\n' || _length == SIZE || (c == ',' && !add_term(_length + 1)))
+        _state = IDLE;
+      else
+      {
+        _line[_length++] = c;
+        _parity ^= c;
+      }
+      return 0;
+    case HEX1:
+      _hex = c;
+      _state = HEX2;
+      return 0;
+    case HEX2:
+      _state = IDLE;
+      if (!checksum(_hex, c))
+        return 0;
+      dispatch(_line);
+      return 1;
+    }
+    return 0;
+  }
+};
+
+#endif
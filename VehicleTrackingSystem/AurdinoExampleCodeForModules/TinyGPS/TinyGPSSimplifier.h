@@ -0,0 +1,128 @@
+/*
+TinyGPSSimplifier - streaming track simplification with bounded error
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSSimplifier_h
+#define TinyGPSSimplifier_h
+
+#include "TinyGPS.h"
+#include <math.h>
+
+// An opening-window simplifier. The last kept fix is the anchor; fixes
+// after it are held back while the straight line from the anchor to the
+// newest fix passes within tolerance metres of every one of them. When
+// it no longer does, the fix before the newest is kept and becomes the
+// anchor. So every dropped fix lies within tolerance of the line between
+// the kept fixes either side of it (to float precision, about a metre).
+//
+// A fix is decided one fix late: add() reports the id of a fix to keep,
+// if any, which is never the one just added. The first fix is always
+// kept, and flush() keeps the last one at the end of a track. At most
+// W fixes are held back; a longer straight run keeps every W-th fix.
+// W must be at least 2: with 1 every fix would be kept.
+template <byte W>
+class TinyGPSSimplifier
+{
+public:
+  TinyGPSSimplifier(float tolerance)
+    : _tolerance(tolerance), _anchor_lat(0), _anchor_lon(0), _anchored(false), _held(0) {}
+
+  // offer a fix, returns true and sets *keep if a fix is to be kept
+  bool add(float lat, float lon, unsigned long id, unsigned long *keep)
+  {
+    if (!_anchored)
+    {
+      anchor(lat, lon);
+      *keep = id;
+      return true;
+    }
+
+    bool kept = false;
+    if (_held == W || !fits(lat, lon))
+    {
+      const held &last = _fixes[_held - 1];
+      anchor(last.lat, last.lon);
+      *keep = last.id;
+      kept = true;
+    }
+
+    held &h = _fixes[_held++];
+    h.lat = lat;
+    h.lon = lon;
+    h.id = id;
+    h.distance = TinyGPS::distance_between(_anchor_lat, _anchor_lon, lat, lon);
+    h.course = radians(TinyGPS::course_to(_anchor_lat, _anchor_lon, lat, lon));
+    return kept;
+  }
+
+  // end of the track: returns true and sets *keep if a fix is still held
+  bool flush(unsigned long *keep)
+  {
+    if (_held == 0)
+      return false;
+    const held &last = _fixes[_held - 1];
+    anchor(last.lat, last.lon);
+    *keep = last.id;
+    return true;
+  }
+
+  // start a new track
+  void reset() { _anchored = false; _held = 0; }
+
+  float tolerance() { return _tolerance; }
+
+private:
+  typedef char _window_must_hold_at_least_two_fixes[W >= 2 ? 1 : -1];
+
+  struct held
+  {
+    float lat, lon;
+    unsigned long id;
+    float distance, course;   // from the anchor, metres and radians
+  };
+
+  float _tolerance;
+  float _anchor_lat, _anchor_lon;
+  bool _anchored;
+  byte _held;
+  held _fixes[W];
+
+  void anchor(float lat, float lon)
+  {
+    _anchor_lat = lat;
+    _anchor_lon = lon;
+    _anchored = true;
+    _held = 0;
+  }
+
+  // is every held fix within tolerance of the segment from the anchor to lat/lon?
+  bool fits(float lat, float lon)
+  {
+    float length = TinyGPS::distance_between(_anchor_lat, _anchor_lon, lat, lon);
+    float course = radians(TinyGPS::course_to(_anchor_lat, _anchor_lon, lat, lon));
+
+    for (byte i = 0; i < _held; ++i)
+    {
+      const held &h = _fixes[i];
+      float angle = h.course - course;
+      float along = h.distance * cos(angle);
+      float error;
+
+      if (along <= 0)
+        error = h.distance;
+      else if (along >= length)
+        error = TinyGPS::distance_between(h.lat, h.lon, lat, lon);
+      else
+        error = fabs(h.distance * sin(angle));
+
+      if (error > _tolerance)
+        return false;
+    }
+    return true;
+  }
+};
+
+#endif
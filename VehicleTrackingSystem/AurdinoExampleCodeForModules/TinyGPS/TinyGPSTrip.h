@@ -0,0 +1,169 @@
+/*
+TinyGPSTrip - incremental odometer, moving and idle time, speeds and trip events
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSTrip_h
+#define TinyGPSTrip_h
+
+#include "TinyGPS.h"
+#include <math.h>
+
+#ifndef _GPS_METERS_PER_MILLIONTH
+#define _GPS_METERS_PER_MILLIONTH 0.1112263 // on the sphere distance_between() uses
+#endif
+
+// Keeps a vehicle's trip totals up to date from each committed fix, in
+// constant time and 56 bytes, so it can run on the device or once per
+// vehicle on a server. Legs between fixes are measured on a plane scaled
+// by the cosine of the latitude, which is only recomputed once the
+// latitude has moved about 200 m; over the few metres between fixes this is
+// as good as distance_between() and needs no trig. The odometer is kept in
+// whole millimetres so it does not drift however long the trip.
+//
+// A fix at start_speed or more (hundredths of a knot) is moving: its leg
+// is added to the odometer and the time since the previous fix to the
+// moving time. A slower fix during a trip adds to the idle time instead,
+// and its leg, which is mostly position noise, is left out. The first
+// moving fix starts a trip; stop_delay milliseconds without one end it.
+// Without speed() (see _GPS_NO_SPEED) the speed is taken from the leg.
+//
+//   TinyGPSTrip trip;
+//   ...
+//   if (gps.encode(c) && trip.update(gps) == TinyGPSTrip::TRIP_STOP)
+//   {
+//     log(trip.odometer(), trip.moving_time(), trip.max_speed());
+//     trip.reset();
+//   }
+class TinyGPSTrip
+{
+public:
+  enum { TRIP_NONE, TRIP_START, TRIP_STOP };
+
+  TinyGPSTrip(unsigned long start_speed = 300, unsigned long stop_delay = 120000)
+    : _start_speed(start_speed), _stop_delay(stop_delay), _last_fix(TinyGPS::GPS_INVALID_FIX_TIME)
+    , _in_trip(false)
+  {
+    _cos_lat_at = TinyGPS::GPS_INVALID_ANGLE;
+    reset();
+  }
+
+  // feed each fix once; returns TRIP_START or TRIP_STOP when a trip starts or ends
+  byte update(TinyGPS &gps)
+  {
+    TinyGPSFix fix;
+    gps.get_fix(&fix);
+    return update(fix);
+  }
+
+  byte update(const TinyGPSFix &fix)
+  {
+    if (fix.position_fix == TinyGPS::GPS_INVALID_FIX_TIME || fix.position_fix == _last_fix)
+      return TRIP_NONE;
+
+    bool first = _last_fix == TinyGPS::GPS_INVALID_FIX_TIME;
+    unsigned long dt = first ? 0 : fix.position_fix - _last_fix;
+    unsigned long leg = first ? 0 : leg_mm(fix.latitude, fix.longitude);
+    unsigned long speed = fix.speed;
+    if (speed == TinyGPS::GPS_INVALID_SPEED)
+      // mm/ms is m/s; 194.38 hundredths of a knot per m/s
+      speed = dt ? (unsigned long)(leg * 194.384f / dt) : 0;
+
+    _lat = fix.latitude;
+    _lon = fix.longitude;
+    _last_fix = fix.position_fix;
+    if (speed > _max_speed)
+      _max_speed = speed;
+
+    if (speed >= _start_speed)
+    {
+      unsigned long mm = _odometer_mm + leg;
+      _odometer_m += mm / 1000;
+      _odometer_mm = mm % 1000;
+      _moving_time += dt;
+      // hundredths of a knot times seconds, carrying the remainder
+      unsigned long part = speed * (dt % 1000) + _speed_rem;
+      _speed_seconds += speed * (dt / 1000) + part / 1000;
+      _speed_rem = part % 1000;
+
+      _stopped_at = TinyGPS::GPS_INVALID_FIX_TIME;
+      if (!_in_trip)
+      {
+        _in_trip = true;
+        return TRIP_START;
+      }
+      return TRIP_NONE;
+    }
+
+    if (!_in_trip)
+      return TRIP_NONE;
+    _idle_time += dt;
+    if (_stopped_at == TinyGPS::GPS_INVALID_FIX_TIME)
+      _stopped_at = fix.position_fix;
+    else if (fix.position_fix - _stopped_at >= _stop_delay)
+    {
+      _in_trip = false;
+      _stopped_at = TinyGPS::GPS_INVALID_FIX_TIME;
+      return TRIP_STOP;
+    }
+    return TRIP_NONE;
+  }
+
+  // clears the totals, keeping the last position and whether a trip is on
+  void reset()
+  {
+    _odometer_m = 0;
+    _odometer_mm = 0;
+    _moving_time = _idle_time = 0;
+    _max_speed = 0;
+    _speed_seconds = 0;
+    _speed_rem = 0;
+    _stopped_at = TinyGPS::GPS_INVALID_FIX_TIME;
+  }
+
+  bool in_trip() { return _in_trip; }
+  // metres moved since reset()
+  unsigned long odometer() { return _odometer_m + (_odometer_mm >= 500); }
+  // milliseconds
+  unsigned long moving_time() { return _moving_time; }
+  unsigned long idle_time() { return _idle_time; }
+  // hundredths of a knot; the average is over the moving time
+  unsigned long max_speed() { return _max_speed; }
+  unsigned long average_speed()
+    { return _moving_time ? (unsigned long)(_speed_seconds * 1000.0 / _moving_time + 0.5) : 0; }
+
+private:
+  unsigned long _start_speed, _stop_delay;
+  long _lat, _lon;
+  unsigned long _last_fix;
+  unsigned long _stopped_at;
+  long _cos_lat_at;
+  unsigned short _cos_lat; // Q15
+  unsigned short _odometer_mm;
+  unsigned long _odometer_m;
+  unsigned long _moving_time, _idle_time;
+  unsigned long _max_speed;
+  unsigned long _speed_seconds;
+  unsigned short _speed_rem;
+  bool _in_trip;
+
+  // millimetres from the last fix to lat/lon, both in millionths of a degree
+  unsigned long leg_mm(long lat, long lon)
+  {
+    long away = lat - _cos_lat_at;
+    if (away > 2000 || away < -2000)
+    {
+      _cos_lat = (unsigned short)(cos(radians(lat / 1000000.0)) * 32768.0 + 0.5);
+      _cos_lat_at = lat;
+    }
+    long dlon = lon - _lon;
+    if (dlon > 180000000L) dlon -= 360000000L;
+    else if (dlon < -180000000L) dlon += 360000000L;
+    float x = (float)dlon * _cos_lat * (1.0f / 32768), y = (float)(lat - _lat);
+    return (unsigned long)(sqrt(x * x + y * y) * (_GPS_METERS_PER_MILLIONTH * 1000) + 0.5f);
+  }
+};
+
+#endif
@@ -0,0 +1,280 @@
+/*
+TinyGPSUBX - decodes u-blox UBX NAV-PVT and NAV-DOP frames into a TinyGPS
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSUBX.h"
+#include <string.h>
+
+#define _UBX_SYNC1 0xB5
+#define _UBX_SYNC2 0x62
+#define _UBX_CLASS_NAV 0x01
+#define _UBX_ID_NAV_DOP 0x04
+#define _UBX_ID_NAV_PVT 0x07
+
+// u-blox 7 sends the first 84 bytes of NAV-PVT, later receivers 92
+#define _UBX_NAV_PVT_MIN_LENGTH 84
+
+TinyGPSUBX::TinyGPSUBX(TinyGPS &gps, TinyGPSLayout)
+  :  _gps(gps)
+  ,  _state(SYNC1)
+#ifndef _GPS_NO_STATS
+  ,  _frames(0)
+  ,  _failed_checksum(0)
+#endif
+{
+}
+
+bool TinyGPSUBX::encode(char c)
+{
+  byte b = (byte)c;
+  switch (_state)
+  {
+  case SYNC1:
+    if (b == _UBX_SYNC1)
+      _state = SYNC2;
+    return false;
+  case SYNC2:
+    _state = b == _UBX_SYNC2 ? CLASS : b == _UBX_SYNC1 ? SYNC2 : SYNC1;
+    _ck_a = _ck_b = 0;
+    return false;
+  case CLASS:
+    _class = b;
+    break;
+  case ID:
+    _id = b;
+    break;
+  case LENGTH1:
+    _length = b;
+    break;
+  case LENGTH2:
+    _length |= (unsigned short)b << 8;
+    if (_length > sizeof(_payload))
+    {
+      // a corrupted length, or a sync pair that was not a frame start;
+      // waiting for that many bytes would swallow the frames after it
+      _state = SYNC1;
+#ifndef _GPS_NO_STATS
+      ++_failed_checksum;
+#endif
+      return false;
+    }
+    _offset = 0;
+    checksum(b);
+    _state = _length ? PAYLOAD : CK_A;
+    return false;
+  case PAYLOAD:
+    _payload[_offset] = b;
+    checksum(b);
+    if (++_offset == _length)
+      _state = CK_A;
+    return false;
+  case CK_A:
+    _state = b == _ck_a ? CK_B : SYNC1;
+#ifndef _GPS_NO_STATS
+    if (_state == SYNC1)
+      ++_failed_checksum;
+#endif
+    return false;
+  case CK_B:
+    _state = SYNC1;
+    if (b != _ck_b)
+    {
+#ifndef _GPS_NO_STATS
+      ++_failed_checksum;
+#endif
+      return false;
+    }
+    return frame_complete();
+  }
+
+  // class, id and first length byte
+  checksum(b);
+  ++_state;
+  return false;
+}
+
+unsigned TinyGPSUBX::encode(const char *buf, size_t len)
+{
+  const char *end = buf + len;
+  unsigned valid = 0;
+
+  while (buf < end)
+  {
+    if (_state == SYNC1)
+    {
+      // NMEA and frames we do not decode never contain the sync byte
+      // outside a payload, so skip straight to the next one
+      buf = (const char *)memchr(buf, _UBX_SYNC1, end - buf);
+      if (!buf)
+        break;
+    }
+    else if (_state == PAYLOAD)
+    {
+      size_t n = _length - _offset;
+      if (n > (size_t)(end - buf))
+        n = end - buf;
+      byte a = _ck_a, b = _ck_b;
+      for (size_t i = 0; i < n; ++i)
+      {
+        a += (byte)buf[i];
+        b += a;
+      }
+      memcpy(_payload + _offset, buf, n);
+      _ck_a = a;
+      _ck_b = b;
+      _offset += n;
+      buf += n;
+      if (_offset == _length)
+        _state = CK_A;
+      continue;
+    }
+    valid += encode(*buf++);
+  }
+  return valid;
+}
+
+#ifndef _GPS_NO_STATS
+void TinyGPSUBX::stats(unsigned short *frames, unsigned short *failed_cs)
+{
+  if (frames) *frames = _frames;
+  if (failed_cs) *failed_cs = _failed_checksum;
+}
+#endif
+
+//
+// internal utilities
+//
+unsigned short TinyGPSUBX::u2(byte offset)
+{
+  return _payload[offset] | (unsigned short)_payload[offset + 1] << 8;
+}
+
+unsigned long TinyGPSUBX::u4(byte offset)
+{
+  return (unsigned long)u2(offset) | (unsigned long)u2(offset + 2) << 16;
+}
+
+// sign extends, so this also works where long is wider than 32 bits
+long TinyGPSUBX::i4(byte offset)
+{
+  unsigned long v = u4(offset);
+  return v & 0x80000000UL ? -(long)(~v & 0x7FFFFFFFUL) - 1 : (long)v;
+}
+
+// rounds to the nearest tenth, away from zero
+static long tenth(long v)
+{
+  return (v >= 0 ? v + 5 : v - 5) / 10;
+}
+
+static byte days_in_month(int year, byte month)
+{
+  static const byte days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+    return 29;
+  return days[month - 1];
+}
+
+bool TinyGPSUBX::frame_complete()
+{
+#ifndef _GPS_NO_STATS
+  ++_frames;
+#endif
+  if (_class != _UBX_CLASS_NAV)
+    return false;
+  if (_id == _UBX_ID_NAV_PVT && _length >= _UBX_NAV_PVT_MIN_LENGTH && _length <= NAV_PVT_LENGTH)
+    return nav_pvt();
+#ifndef _GPS_NO_HDOP
+  if (_id == _UBX_ID_NAV_DOP && _length == NAV_DOP_LENGTH)
+  {
+    // hDOP, in hundredths like the GSA field
+    _gps.begin_publish();
+    _gps._hdop = u2(12);
+    _gps.end_publish();
+    return true;
+  }
+#endif
+  return false;
+}
+
+bool TinyGPSUBX::nav_pvt()
+{
+  bool committed = false;
+  byte valid = _payload[11];
+  _gps.begin_publish();
+
+  // validDate and validTime
+  if ((valid & 0x03) == 0x03)
+  {
+    int year = u2(4);
+    byte month = _payload[6], day = _payload[7];
+    byte hour = _payload[8], minute = _payload[9], second = _payload[10];
+    long nano = i4(16);
+
+    // the time is rounded to the second and nano may be negative:
+    // borrow a second, back into the previous day if need be
+    if (nano < 0)
+    {
+      nano += 1000000000L;
+      if (second-- == 0)
+      {
+        second = 59;
+        if (minute-- == 0)
+        {
+          minute = 59;
+          if (hour-- == 0)
+          {
+            hour = 23;
+            if (--day == 0)
+            {
+              if (--month == 0)
+              {
+                month = 12;
+                --year;
+              }
+              day = days_in_month(year, month);
+            }
+          }
+        }
+      }
+    }
+
+    _gps._time = ((hour * 100UL + minute) * 100UL + second) * 100UL + nano / 10000000L;
+    _gps._date = (day * 100UL + month) * 100UL + year % 100;
+    _gps._last_time_fix = TinyGPS::_clock();
+    committed = true;
+  }
+
+  // gnssFixOK with a 2D, 3D or GNSS + dead reckoning fix
+  byte fix_type = _payload[20];
+  if ((_payload[21] & 0x01) && fix_type >= 2 && fix_type <= 4)
+  {
+    _gps._longitude = tenth(i4(24));
+    _gps._latitude = tenth(i4(28));
+#ifndef _GPS_NO_ALTITUDE
+    if (fix_type != 2)
+      _gps._altitude = tenth(i4(36));
+#endif
+#ifndef _GPS_NO_SPEED
+    // mm/s to hundredths of a knot: 12739 / 65536 = 0.19438 knot s/m,
+    // halving first keeps the product in 32 bits up to 670 m/s
+    long speed = i4(60);
+    _gps._speed = speed > 0 ? (((unsigned long)speed >> 1) * 12739UL + 16384) >> 15 : 0;
+#endif
+#ifndef _GPS_NO_COURSE
+    // 1e-5 degrees to hundredths
+    _gps._course = (u4(64) + 500) / 1000;
+#endif
+#ifndef _GPS_NO_SATELLITES
+    _gps._numsats = _payload[23];
+#endif
+    _gps._last_position_fix = TinyGPS::_clock();
+    committed = true;
+  }
+
+  _gps.end_publish();
+  return committed;
+}
@@ -0,0 +1,65 @@
+/*
+TinyGPSUBX - decodes u-blox UBX NAV-PVT and NAV-DOP frames into a TinyGPS
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef TinyGPSUBX_h
+#define TinyGPSUBX_h
+
+#include "TinyGPS.h"
+
+// At 10 Hz, RMC and GGA take about 150 bytes an epoch, more than a
+// 9600 baud link carries; a NAV-PVT frame is 100 bytes and needs no text
+// parsing. Frames are checked with the UBX Fletcher checksum and their
+// fields copied into the TinyGPS passed to the constructor, in its units,
+// so its accessors work as if RMC and GGA had been received. NAV-PVT has
+// no HDOP; enable NAV-DOP (26 bytes) as well if hdop() is wanted.
+//
+// The receiver has to be told to send these frames, with u-center or
+// CFG-MSG / CFG-VALSET. Other frames are checked and skipped, and NMEA
+// can be fed to both this and TinyGPS::encode() on a mixed link. A length
+// over the 92 bytes of NAV-PVT is taken as a framing error and counted as
+// a failed checksum, so longer frames (NAV-SAT, MON-VER) are best disabled.
+class TinyGPSUBX
+{
+public:
+  TinyGPSUBX(TinyGPS &gps, TinyGPSLayout = TinyGPSLayout());
+
+  // process one character, true if a frame updated the fix
+  bool encode(char c);
+  // process a block of characters, returns the number of frames that updated the fix
+  unsigned encode(const char *buf, size_t len);
+
+#ifndef _GPS_NO_STATS
+  void stats(unsigned short *frames, unsigned short *failed_cs);
+#endif
+
+private:
+  enum { SYNC1, SYNC2, CLASS, ID, LENGTH1, LENGTH2, PAYLOAD, CK_A, CK_B };
+  // only NAV-PVT is kept; NAV-DOP fits in the first bytes
+  enum { NAV_PVT_LENGTH = 92, NAV_DOP_LENGTH = 18 };
+
+  TinyGPS &_gps;
+  byte _state;
+  byte _class, _id;
+  unsigned short _length, _offset;
+  byte _ck_a, _ck_b;
+  byte _payload[NAV_PVT_LENGTH];
+
+#ifndef _GPS_NO_STATS
+  unsigned short _frames;
+  unsigned short _failed_checksum;
+#endif
+
+  void checksum(byte b) { _ck_a += b; _ck_b += _ck_a; }
+  bool frame_complete();
+  bool nav_pvt();
+
+  unsigned short u2(byte offset);
+  unsigned long u4(byte offset);
+  long i4(byte offset);
+};
+
+#endif
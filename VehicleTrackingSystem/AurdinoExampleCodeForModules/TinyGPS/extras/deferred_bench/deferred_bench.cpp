@@ -0,0 +1,179 @@
+/*
+deferred_bench - CPU per valid fix with and without _GPS_DEFERRED_PARSE
+
+Generates an hour of 1 Hz receiver output (RMC, GGA, GSA, three GSV and
+VTG each second), corrupts a given share of the sentences with a single
+bit error on a random character, as a noisy UART does, and feeds it to
+TinyGPS one character at a time and in 64-byte chunks. For each
+corruption rate it reports the time per sentence that was committed and
+a digest of the committed positions and times, which must be the same
+for both builds.
+
+Build from this directory twice, once with the default eager parser and
+once with the deferred one, and compare the output:
+
+  g++ -O2 -I../host -I../.. deferred_bench.cpp ../../TinyGPS.cpp -o eager_bench
+  g++ -O2 -D_GPS_DEFERRED_PARSE -I../host -I../.. deferred_bench.cpp ../../TinyGPS.cpp -o deferred_bench
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <stdio.h>
+#include <string>
+
+static unsigned long random_state = 2463534242UL;
+
+static unsigned long random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state & 0xFFFFFFFFUL;
+}
+
+static void sentence(std::string &out, const char *body)
+{
+  byte parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// one second of output from a receiver moving north-east at 10 m/s
+static void second(std::string &out, unsigned s)
+{
+  char body[96];
+  unsigned hh = 10 + s / 3600, mm = s / 60 % 60, ss = s % 60;
+  double lat = 4807.038 + s * 0.0054, lon = 1131.000 + s * 0.0073;
+
+  snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.00,A,%09.4f,N,%010.4f,E,019.4,045.0,230394,003.1,W",
+    hh, mm, ss, lat, lon);
+  sentence(out, body);
+  snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,%09.4f,N,%010.4f,E,1,08,0.9,%.1f,M,46.9,M,,",
+    hh, mm, ss, lat, lon, 545.4 + s % 17);
+  sentence(out, body);
+  sentence(out, "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1");
+  sentence(out, "GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00");
+  sentence(out, "GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00");
+  sentence(out, "GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00,,,,");
+  sentence(out, "GPVTG,045.0,T,,M,019.4,N,035.9,K,A");
+}
+
+// flips one bit of a random character in rate percent of the sentences
+static std::string corrupt(const std::string &clean, unsigned rate)
+{
+  std::string out = clean;
+  size_t start = 0;
+  while (start < out.size())
+  {
+    size_t end = out.find('\n', start) + 1;
+    if (random_next() % 100 < rate)
+      out[start + random_next() % (end - start)] ^= (char)(1 << (random_next() % 7));
+    start = end;
+  }
+  return out;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct result
+{
+  unsigned long valid;
+  unsigned long digest;
+  double seconds;
+};
+
+static void fold(TinyGPS &gps, unsigned long *digest)
+{
+  long lat, lon;
+  unsigned long date, time;
+  gps.get_position(&lat, &lon);
+  gps.get_datetime(&date, &time);
+  *digest = (*digest * 31 + lat) * 31 + lon + time + date;
+}
+
+static result per_char(const std::string &data)
+{
+  TinyGPS gps;
+  result r = {0, 0, 0};
+  double start = seconds();
+  for (size_t i = 0; i < data.size(); ++i)
+    if (gps.encode(data[i]))
+    {
+      ++r.valid;
+      fold(gps, &r.digest);
+    }
+  r.seconds = seconds() - start;
+  return r;
+}
+
+static result chunked(const std::string &data)
+{
+  TinyGPS gps;
+  result r = {0, 0, 0};
+  double start = seconds();
+  for (size_t i = 0; i < data.size(); i += 64)
+  {
+    size_t n = data.size() - i < 64 ? data.size() - i : 64;
+    unsigned valid = gps.encode(data.data() + i, n);
+    if (valid)
+    {
+      r.valid += valid;
+      fold(gps, &r.digest);
+    }
+  }
+  r.seconds = seconds() - start;
+  return r;
+}
+
+// best of several runs, the digest and count are the same each time
+static result best(result (*run)(const std::string &), const std::string &data)
+{
+  result r = run(data);
+  for (int i = 0; i < 9; ++i)
+  {
+    result again = run(data);
+    if (again.seconds < r.seconds)
+      r.seconds = again.seconds;
+  }
+  return r;
+}
+
+int main()
+{
+  std::string clean;
+  for (unsigned s = 0; s < 3600; ++s)
+    second(clean, s);
+
+#ifdef _GPS_DEFERRED_PARSE
+  printf("deferred parse, %zu bytes per run\n", clean.size());
+#else
+  printf("eager parse, %zu bytes per run\n", clean.size());
+#endif
+  printf("corrupt   valid  ns/valid(char)  ns/valid(64)  digest(char)  digest(64)\n");
+
+  static const unsigned rates[] = { 0, 1, 5, 10, 20, 30 };
+  for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i)
+  {
+    random_state = 2463534242UL;
+    std::string data = corrupt(clean, rates[i]);
+    result c = best(per_char, data);
+    result b = best(chunked, data);
+    printf("%6u%% %7lu %15.1f %13.1f %13lx %11lx\n", rates[i], c.valid,
+      c.valid ? c.seconds / c.valid * 1e9 : 0.0,
+      b.valid ? b.seconds / b.valid * 1e9 : 0.0,
+      c.digest & 0xFFFFFFFFUL, b.digest & 0xFFFFFFFFUL);
+  }
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+dispatch_bench - sentence dispatch by formatter for any talker id
+
+Generates a log of one fix per second in three flavours: RMC, GGA and
+three GSV sentences from a GPS-only receiver ($GP..); the same from a
+multi-constellation receiver ($GN.. fixes, $GP.. and $GL.. GSV); and a
+mixed $GN log that adds VTG, GLL, GSA and ZDA. It reports encode()
+throughput on each and checks that all three give the same fix.
+
+Then it checks VTG validity: a VTG with empty speed and course terms
+must leave a new TinyGPS without speed and course rather than commit
+whatever its staging fields held, one with mode 'N' must not change
+the fix, and one with only a course must make the speed invalid rather
+than keep a stale one.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. dispatch_bench.cpp ../../TinyGPS.cpp -o dispatch_bench
+
+and run as
+
+  ./dispatch_bench [seconds]
+
+It only uses the API of TinyGPS 13, so it also builds against that
+version to compare with its dispatch, which compared the first term
+against "GPRMC" and "GPGGA" and ignored everything else.
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <stdio.h>
+#include <string>
+
+static void append_sentence(std::string &out, const char *body)
+{
+  unsigned char parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+enum { GPS_ONLY, MULTI, MIXED };
+
+static std::string make_log(int flavour, unsigned seconds)
+{
+  const char *fix = flavour == GPS_ONLY ? "GP" : "GN";
+  std::string out;
+  char body[120];
+  double lat = 52.520008, lon = 13.404954;
+  for (unsigned t = 0; t < seconds; ++t)
+  {
+    unsigned s = t % 86400;
+    unsigned hh = s / 3600, mm = s / 60 % 60, ss = s % 60;
+    lat += 0.00009;
+    lon += 0.00006;
+    double lat_min = (lat - (int)lat) * 60, lon_min = (lon - (int)lon) * 60;
+    snprintf(body, sizeof(body), "%sRMC,%02u%02u%02u.00,A,%02d%07.4f,N,%03d%07.4f,E,21.40,31.66,240413,,,A",
+      fix, hh, mm, ss, (int)lat, lat_min, (int)lon, lon_min);
+    append_sentence(out, body);
+    snprintf(body, sizeof(body), "%sGGA,%02u%02u%02u.00,%02d%07.4f,N,%03d%07.4f,E,1,09,0.9,48.5,M,47.0,M,,",
+      fix, hh, mm, ss, (int)lat, lat_min, (int)lon, lon_min);
+    append_sentence(out, body);
+    for (int i = 1; i <= 3; ++i)
+    {
+      const char *talker = flavour != GPS_ONLY && i == 3 ? "GL" : "GP";
+      snprintf(body, sizeof(body), "%sGSV,3,%d,11,%02d,41,087,43,%02d,55,176,40,%02d,13,314,31,%02d,22,045,38",
+        talker, i, 4 * i, 4 * i + 1, 4 * i + 2, 4 * i + 3);
+      append_sentence(out, body);
+    }
+    if (flavour == MIXED)
+    {
+      snprintf(body, sizeof(body), "GNVTG,31.66,T,,M,21.40,N,39.63,K,A");
+      append_sentence(out, body);
+      snprintf(body, sizeof(body), "GNGLL,%02d%07.4f,N,%03d%07.4f,E,%02u%02u%02u.00,A,A",
+        (int)lat, lat_min, (int)lon, lon_min, hh, mm, ss);
+      append_sentence(out, body);
+      snprintf(body, sizeof(body), "GNGSA,A,3,04,05,06,07,08,09,10,11,,,,,1.6,0.9,1.3");
+      append_sentence(out, body);
+      snprintf(body, sizeof(body), "GNZDA,%02u%02u%02u.00,24,04,2013,00,00", hh, mm, ss);
+      append_sentence(out, body);
+    }
+  }
+  return out;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct outcome
+{
+  long lat, lon;
+  unsigned long date, time, speed, course;
+};
+
+static outcome result(TinyGPS &gps)
+{
+  outcome o;
+  gps.get_position(&o.lat, &o.lon);
+  gps.get_datetime(&o.date, &o.time);
+  o.speed = gps.speed();
+  o.course = gps.course();
+  return o;
+}
+
+static bool same(const outcome &a, const outcome &b)
+{
+  return a.lat == b.lat && a.lon == b.lon && a.date == b.date && a.time == b.time
+    && a.speed == b.speed && a.course == b.course;
+}
+
+// best of five runs in MB/s, *o is the fix after the log
+static double run(const std::string &log, outcome *o, unsigned short *good)
+{
+  double best = 0;
+  for (int k = 0; k < 5; ++k)
+  {
+    TinyGPS gps;
+    double start = seconds();
+    for (size_t i = 0; i < log.size(); ++i)
+      gps.encode(log[i]);
+    double mbs = log.size() / (seconds() - start) / 1e6;
+    if (mbs > best)
+      best = mbs;
+    *o = result(gps);
+    unsigned long chars;
+    unsigned short failed;
+    gps.stats(&chars, good, &failed);
+  }
+  return best;
+}
+
+static void feed(TinyGPS &gps, const char *body)
+{
+  std::string s;
+  append_sentence(s, body);
+  for (size_t i = 0; i < s.size(); ++i)
+    gps.encode(s[i]);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned duration = argc > 1 ? atoi(argv[1]) : 10000;
+  static const char *names[] = { "$GP RMC, GGA, GSV", "$GN fixes, $GP/$GL GSV", "$GN with VTG, GLL, GSA, ZDA" };
+  int errors = 0;
+
+  outcome o[3];
+  printf("%u seconds of fixes\n", duration);
+  for (int f = GPS_ONLY; f <= MIXED; ++f)
+  {
+    std::string log = make_log(f, duration);
+    unsigned short good;
+    double mbs = run(log, &o[f], &good);
+    printf("  %-28s %6.1f MB/s  %6u sentences used  %s\n", names[f], mbs, good,
+      same(o[f], o[GPS_ONLY]) ? "same fix" : "fix differs");
+    errors += !same(o[f], o[GPS_ONLY]);
+  }
+
+  // VTG validity
+  TinyGPS gps;
+  outcome fresh = result(gps);
+  feed(gps, "GPVTG,,T,,M,,N,,K");
+  outcome empty = result(gps);
+  feed(gps, "GPRMC,101500.00,A,5231.2005,N,01324.2973,E,21.40,31.66,240413,,,A");
+  outcome before = result(gps);
+  feed(gps, "GPVTG,45.00,T,,M,21.40,N,39.63,K,N");
+  outcome no_fix = result(gps);
+  feed(gps, "GPVTG,45.00,T,,M,,N,,K");
+  outcome course_only = result(gps);
+  bool empty_ok = same(empty, fresh), no_fix_ok = same(no_fix, before);
+  bool course_ok = course_only.course == 4500 && course_only.speed == TinyGPS::GPS_INVALID_SPEED;
+  printf("VTG: empty %s, mode N %s, course only %s\n", empty_ok ? "ignored" : "committed",
+    no_fix_ok ? "ignored" : "committed", course_ok ? "commits an invalid speed" : "keeps a stale speed");
+  errors += !empty_ok + !no_fix_ok + !course_ok;
+  return errors != 0;
+}
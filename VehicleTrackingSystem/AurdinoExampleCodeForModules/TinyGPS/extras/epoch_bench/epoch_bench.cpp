@@ -0,0 +1,312 @@
+/*
+epoch_bench - get_epoch_ms(), epochs_ms() and days_from_civil() against
+timegm(), and timed against crack_datetime() plus mktime()
+
+Checks every valid date of the 1981 to 2080 window that crack_datetime()
+assumes, at midnight and at a few times of day, and every hundredth of a
+second of the day on a few dates, against timegm(). days_from_civil() is
+checked against timegm() over the window and against counting days one by
+one for 400 years either side of it. Dates and times that are out of range
+must come back as 0. Every date is also fed through an RMC sentence, and
+crack_datetime() must give what the divisions it used to do give.
+
+It then converts a day of logged 1 Hz fixes the old way, the divisions of
+crack_datetime() and mktime() with TZ at UTC, and with epochs_ms(), and
+compares get_epoch_ms() with crack_datetime() and mktime() on a TinyGPS.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. epoch_bench.cpp ../../TinyGPS.cpp -o epoch_bench
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201103L
+static_assert(TinyGPS::days_from_civil(1970, 1, 1) == 0, "epoch");
+static_assert(TinyGPS::days_from_civil(2000, 3, 1) == 11017, "leap century");
+static_assert(TinyGPS::days_from_civil(1969, 12, 31) == -1, "before the epoch");
+#endif
+
+static const byte month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static bool leap(int y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+static int days_in(int y, int m) { return m == 2 && leap(y) ? 29 : month_days[m - 1]; }
+
+static unsigned long long reference_ms(int y, int mon, int d, int hh, int mm, int ss, int cc)
+{
+  struct tm t = {};
+  t.tm_year = y - 1900;
+  t.tm_mon = mon - 1;
+  t.tm_mday = d;
+  t.tm_hour = hh;
+  t.tm_min = mm;
+  t.tm_sec = ss;
+  return timegm(&t) * 1000ULL + cc * 10;
+}
+
+static unsigned long pack(unsigned long a, unsigned long b, unsigned long c)
+{
+  return (a * 100 + b) * 100 + c;
+}
+
+static unsigned long failures;
+
+static void check(bool ok, const char *what, unsigned long date, unsigned long time)
+{
+  if (!ok && ++failures <= 10)
+    printf("  %s wrong for date %06lu time %08lu\n", what, date, time);
+}
+
+static unsigned long valid_dates()
+{
+  unsigned long n = 0;
+  static const unsigned long times[] = { 0, 12345678, 23595999 };
+  for (int y = 1981; y <= 2080; ++y)
+    for (int m = 1; m <= 12; ++m)
+      for (int d = 1; d <= days_in(y, m); ++d, ++n)
+      {
+        unsigned long date = pack(d, m, y % 100);
+        long days = TinyGPS::days_from_civil(y, m, d);
+        check(days * 86400000LL == (long long)reference_ms(y, m, d, 0, 0, 0, 0), "days_from_civil", date, 0);
+        for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+        {
+          unsigned long t = times[i];
+          unsigned long long ms;
+          TinyGPS::epochs_ms(&date, &t, 1, &ms);
+          check(ms == reference_ms(y, m, d, t / 1000000, t / 10000 % 100, t / 100 % 100, t % 100),
+            "epochs_ms", date, t);
+        }
+      }
+  return n;
+}
+
+static unsigned long whole_days()
+{
+  static const unsigned long dates[] = { 10181, 280281, 311299, 10100, 290200, 311280 };
+  static const int years[] = { 1981, 1981, 1999, 2000, 2000, 2080 };
+  std::vector<unsigned long> date(8640000), time(8640000);
+  std::vector<unsigned long long> ms(8640000);
+  for (size_t i = 0; i < sizeof(dates) / sizeof(dates[0]); ++i)
+  {
+    size_t n = 0;
+    for (int hh = 0; hh < 24; ++hh)
+      for (int mm = 0; mm < 60; ++mm)
+        for (int ss = 0; ss < 60; ++ss)
+          for (int cc = 0; cc < 100; ++cc, ++n)
+          {
+            date[n] = dates[i];
+            time[n] = pack(hh * 100 + mm, ss, cc);
+          }
+    TinyGPS::epochs_ms(&date[0], &time[0], n, &ms[0]);
+    unsigned long d = dates[i];
+    unsigned long long midnight = reference_ms(years[i], d / 100 % 100, d / 10000, 0, 0, 0, 0);
+    for (size_t k = 0; k < n; ++k)
+      check(ms[k] == midnight + k * 10, "epochs_ms", d, time[k]);
+  }
+  return 8640000UL * (sizeof(dates) / sizeof(dates[0]));
+}
+
+static void out_of_range()
+{
+  static const unsigned long dates[] = { TinyGPS::GPS_INVALID_DATE, 1, 10000, 320180, 11380, 999999, 4294967295UL };
+  static const unsigned long times[] = { TinyGPS::GPS_INVALID_TIME, 24000000, 12600000, 12006000, 99999999 };
+  for (size_t i = 0; i < sizeof(dates) / sizeof(dates[0]); ++i)
+  {
+    unsigned long t = 0;
+    unsigned long long ms;
+    TinyGPS::epochs_ms(&dates[i], &t, 1, &ms);
+    check(ms == 0, "out of range date", dates[i], t);
+  }
+  for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+  {
+    unsigned long d = 10181;
+    unsigned long long ms;
+    TinyGPS::epochs_ms(&d, &times[i], 1, &ms);
+    check(ms == 0, "out of range time", d, times[i]);
+  }
+  TinyGPS gps;
+  check(gps.get_epoch_ms() == 0, "get_epoch_ms before a fix", 0, 0);
+}
+
+// days_from_civil() beyond the window, one day at a time
+static void far_dates()
+{
+  long days = TinyGPS::days_from_civil(1580, 1, 1);
+  for (int y = 1580; y < 2480; ++y)
+    for (int m = 1; m <= 12; ++m)
+      for (int d = 1; d <= days_in(y, m); ++d, ++days)
+        check(TinyGPS::days_from_civil(y, m, d) == days, "days_from_civil", pack(d, m, y % 100), y);
+  check(TinyGPS::days_from_civil(1580, 1, 1) == -142445, "days_from_civil", 10180, 1580);
+}
+
+static void sentence(std::string &out, const char *body)
+{
+  byte parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// crack_datetime() as it was, with a division per field
+static void old_crack(unsigned long date, unsigned long time, int *year, byte *month, byte *day,
+  byte *hour, byte *minute, byte *second, byte *hundredths)
+{
+  *year = date % 100;
+  *year += *year > 80 ? 1900 : 2000;
+  *month = (date / 100) % 100;
+  *day = date / 10000;
+  *hour = time / 1000000;
+  *minute = (time / 10000) % 100;
+  *second = (time / 100) % 100;
+  *hundredths = time % 100;
+}
+
+static bool same_crack(TinyGPS &gps)
+{
+  unsigned long date, time;
+  gps.get_datetime(&date, &time);
+  int y1, y2;
+  byte a[6], b[6];
+  gps.crack_datetime(&y1, &a[0], &a[1], &a[2], &a[3], &a[4], &a[5]);
+  old_crack(date, time, &y2, &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]);
+  return y1 == y2 && !memcmp(a, b, sizeof(a));
+}
+
+static unsigned long cracked()
+{
+  TinyGPS gps;
+  unsigned long n = 0;
+  check(same_crack(gps), "crack_datetime", TinyGPS::GPS_INVALID_DATE, TinyGPS::GPS_INVALID_TIME);
+  for (int y = 1981; y <= 2080; ++y)
+    for (int m = 1; m <= 12; ++m)
+      for (int d = 1; d <= days_in(y, m); ++d, ++n)
+      {
+        char body[80];
+        snprintf(body, sizeof(body), "GPRMC,%02lu%02lu%02lu.%02lu,A,4807.038,N,01131.000,E,022.4,084.4,%02d%02d%02d,,",
+          n / 3600 % 24, n / 60 % 60, n % 60, n % 100, d, m, y % 100);
+        std::string s;
+        sentence(s, body);
+        gps.encode(s.data(), s.size());
+        check(same_crack(gps), "crack_datetime", pack(d, m, y % 100), n);
+      }
+  return n;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// what the device and server code did: crack the fields, then mktime() at UTC
+static unsigned long long old_epoch_ms(unsigned long date, unsigned long time)
+{
+  int year;
+  byte month, day, hour, minute, second, hundredths;
+  old_crack(date, time, &year, &month, &day, &hour, &minute, &second, &hundredths);
+  struct tm t = {};
+  t.tm_year = year - 1900;
+  t.tm_mon = month - 1;
+  t.tm_mday = day;
+  t.tm_hour = hour;
+  t.tm_min = minute;
+  t.tm_sec = second;
+  return mktime(&t) * 1000ULL + hundredths * 10;
+}
+
+static void timing()
+{
+  // a day of 1 Hz fixes on each of a few dates
+  const size_t n = 86400 * 4;
+  static const unsigned long dates[] = { 281023, 10124, 290224, 311279 };
+  std::vector<unsigned long> date(n), time(n);
+  std::vector<unsigned long long> ms(n), old(n);
+  for (size_t k = 0; k < n; ++k)
+  {
+    unsigned long s = k % 86400;
+    date[k] = dates[k / 86400];
+    time[k] = pack(s / 3600 * 100 + s / 60 % 60, s % 60, 0);
+  }
+
+  double best_old = 1e9, best_new = 1e9;
+  for (int r = 0; r < 5; ++r)
+  {
+    double start = seconds();
+    for (size_t k = 0; k < n; ++k)
+      old[k] = old_epoch_ms(date[k], time[k]);
+    double t = seconds() - start;
+    if (t < best_old) best_old = t;
+
+    start = seconds();
+    TinyGPS::epochs_ms(&date[0], &time[0], n, &ms[0]);
+    t = seconds() - start;
+    if (t < best_new) best_new = t;
+  }
+  unsigned long differ = 0;
+  for (size_t k = 0; k < n; ++k)
+    differ += old[k] != ms[k];
+  printf("%zu logged fixes:\n", n);
+  printf("  crack_datetime + mktime %8.1f ns/fix\n", best_old / n * 1e9);
+  printf("  epochs_ms               %8.1f ns/fix  %.0fx, %lu results differ\n",
+    best_new / n * 1e9, best_old / best_new, differ);
+  failures += differ;
+
+  // on a parser, where the fields first have to be read out of it
+  TinyGPS gps;
+  std::string s;
+  sentence(s, "GPRMC,235959.50,A,4807.038,N,01131.000,E,022.4,084.4,311279,,");
+  gps.encode(s.data(), s.size());
+  const long calls = 1000000;
+  unsigned long long sink = 0;
+  double start = seconds();
+  for (long i = 0; i < calls; ++i)
+  {
+    int year;
+    byte month, day, hour, minute, second, hundredths;
+    gps.crack_datetime(&year, &month, &day, &hour, &minute, &second, &hundredths);
+    struct tm t = {};
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    t.tm_sec = second;
+    sink += mktime(&t) * 1000ULL + hundredths * 10;
+  }
+  double crack_ns = (seconds() - start) / calls * 1e9;
+  start = seconds();
+  for (long i = 0; i < calls; ++i)
+    sink -= gps.get_epoch_ms();
+  double epoch_ns = (seconds() - start) / calls * 1e9;
+  printf("one TinyGPS:\n");
+  printf("  crack_datetime + mktime %8.1f ns/call\n", crack_ns);
+  printf("  get_epoch_ms            %8.1f ns/call  %.0fx, %s\n", epoch_ns, crack_ns / epoch_ns,
+    sink ? "results differ" : "same results");
+  failures += sink != 0;
+}
+
+int main()
+{
+  setenv("TZ", "UTC", 1);
+  tzset();
+
+  printf("%lu dates checked\n", valid_dates());
+  printf("%lu times of day checked\n", whole_days());
+  out_of_range();
+  far_dates();
+  printf("%lu dates cracked\n", cracked());
+  timing();
+  printf("%lu failures\n", failures);
+  return failures != 0;
+}
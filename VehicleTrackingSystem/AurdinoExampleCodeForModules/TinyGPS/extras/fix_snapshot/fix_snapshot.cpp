@@ -0,0 +1,245 @@
+/*
+fix_snapshot - concurrent readers of a TinyGPS that is being fed
+
+One writer thread feeds RMC sentences to TinyGPS in 64-byte chunks, as a
+gateway's serial thread would, while reader threads call get_fix(),
+get_position() and get_datetime() as fast as they can. Every sentence has
+its own time stamp, and the fields each time stamp must come with are
+worked out single-threaded beforehand, so any snapshot mixing two
+sentences is caught and counted as torn. It then reports the time each
+read takes with the writer idle and running, and the writer's throughput
+with and without readers.
+
+Build from this directory with
+
+  g++ -O2 -std=c++11 -pthread -I../host -I../.. fix_snapshot.cpp ../../TinyGPS.cpp -o fix_snapshot
+
+and run as
+
+  ./fix_snapshot [readers] [seconds]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <atomic>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// one sentence per centisecond for a little over half an hour
+#define SENTENCES 200000
+
+static std::string data;
+static std::vector<TinyGPSFix> expected;
+static std::atomic<bool> stop;
+static std::atomic<unsigned long long> written;
+
+static void sentence(std::string &out, const char *body)
+{
+  byte parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// every field changes from one sentence to the next
+static void generate()
+{
+  TinyGPS gps;
+  expected.resize(SENTENCES);
+  for (long k = 0; k < SENTENCES; ++k)
+  {
+    char body[96];
+    long lat = 4800 * 10000L + k, lon = 11300 * 10000L + 2 * k;
+    snprintf(body, sizeof(body), "GPRMC,%02ld%02ld%02ld.%02ld,A,%ld.%04ld,N,%ld.%04ld,E,%ld.%ld,%ld.%ld,%02ld0724,,",
+      k / 360000, k / 6000 % 60, k / 100 % 60, k % 100,
+      lat / 10000, lat % 10000, lon / 10000, lon % 10000,
+      k % 900 / 10, k % 10, k % 3600 / 10, k % 10, 1 + k % 28);
+    std::string one;
+    sentence(one, body);
+    gps.encode(one.data(), one.size());
+    gps.get_fix(&expected[k]);
+    data += one;
+  }
+}
+
+// a snapshot is whole if it is exactly what its time stamp was sent with
+static bool whole(const TinyGPSFix &f)
+{
+  if (f.time == TinyGPS::GPS_INVALID_TIME)
+    return f.date == TinyGPS::GPS_INVALID_DATE && f.latitude == TinyGPS::GPS_INVALID_ANGLE;
+  unsigned long t = f.time;
+  unsigned long k = ((t / 1000000 * 60 + t / 10000 % 100) * 60 + t / 100 % 100) * 100 + t % 100;
+  if (k >= SENTENCES)
+    return false;
+  const TinyGPSFix &e = expected[k];
+  return f.date == e.date && f.latitude == e.latitude && f.longitude == e.longitude &&
+    f.speed == e.speed && f.course == e.course;
+}
+
+static bool whole_position(long lat, long lon)
+{
+  if (lat == TinyGPS::GPS_INVALID_ANGLE)
+    return lon == TinyGPS::GPS_INVALID_ANGLE;
+  // latitude moves by 1e-4 minutes, 5/3 of a millionth of a degree, a sentence
+  long k = ((lat - 48000000L) * 6 + 5) / 10;
+  return k >= 0 && k < SENTENCES && expected[k].latitude == lat && expected[k].longitude == lon;
+}
+
+static bool whole_datetime(unsigned long date, unsigned long time)
+{
+  if (time == TinyGPS::GPS_INVALID_TIME)
+    return date == TinyGPS::GPS_INVALID_DATE;
+  unsigned long k = ((time / 1000000 * 60 + time / 10000 % 100) * 60 + time / 100 % 100) * 100 + time % 100;
+  return k < SENTENCES && expected[k].date == date;
+}
+
+static void writer(TinyGPS *gps)
+{
+  while (!stop.load(std::memory_order_relaxed))
+  {
+    for (size_t i = 0; i < data.size() && !stop.load(std::memory_order_relaxed); i += 64)
+    {
+      size_t n = data.size() - i < 64 ? data.size() - i : 64;
+      gps->encode(data.data() + i, n);
+      written.fetch_add(n, std::memory_order_relaxed);
+    }
+  }
+}
+
+struct tally
+{
+  unsigned long long reads, torn;
+};
+
+static void reader(TinyGPS *gps, tally *t)
+{
+  tally mine = {0, 0};
+  while (!stop.load(std::memory_order_relaxed))
+  {
+    TinyGPSFix f;
+    gps->get_fix(&f);
+    mine.torn += !whole(f);
+
+    long lat, lon;
+    gps->get_position(&lat, &lon);
+    mine.torn += !whole_position(lat, lon);
+
+    unsigned long date, time;
+    gps->get_datetime(&date, &time);
+    mine.torn += !whole_datetime(date, time);
+    mine.reads += 3;
+  }
+  *t = mine;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// runs the writer and readers together for the given time,
+// false if any reader saw a torn snapshot
+static bool stress(int readers, double duration)
+{
+  TinyGPS gps;
+  std::vector<tally> tallies(readers);
+  std::vector<std::thread> threads;
+  stop = false;
+  written = 0;
+
+  double start = seconds();
+  std::thread w(writer, &gps);
+  for (int i = 0; i < readers; ++i)
+    threads.push_back(std::thread(reader, &gps, &tallies[i]));
+  while (seconds() - start < duration)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stop = true;
+  w.join();
+  for (int i = 0; i < readers; ++i)
+    threads[i].join();
+  double elapsed = seconds() - start;
+
+  unsigned long long reads = 0, torn = 0;
+  for (int i = 0; i < readers; ++i)
+  {
+    reads += tallies[i].reads;
+    torn += tallies[i].torn;
+  }
+  printf("  %d readers: writer %.1f MB/s, %llu reads, %llu torn\n",
+    readers, written / elapsed / 1e6, reads, torn);
+  return torn == 0;
+}
+
+// time per call on an idle parser, and while a writer keeps committing
+static void latency(bool busy)
+{
+  TinyGPS gps;
+  gps.encode(data.data(), data.size() / 2);
+  stop = false;
+  std::thread w;
+  if (busy)
+    w = std::thread(writer, &gps);
+
+  const long n = 2000000;
+  TinyGPSFix f;
+  long lat, lon;
+  unsigned long date, time;
+  unsigned long long sink = 0;
+
+  double start = seconds();
+  for (long i = 0; i < n; ++i)
+  {
+    gps.get_fix(&f);
+    sink += f.time;
+  }
+  double fix_ns = (seconds() - start) / n * 1e9;
+  start = seconds();
+  for (long i = 0; i < n; ++i)
+  {
+    gps.get_position(&lat, &lon);
+    sink += lat;
+  }
+  double position_ns = (seconds() - start) / n * 1e9;
+  start = seconds();
+  for (long i = 0; i < n; ++i)
+  {
+    gps.get_datetime(&date, &time);
+    sink += time;
+  }
+  double datetime_ns = (seconds() - start) / n * 1e9;
+
+  stop = true;
+  if (busy)
+    w.join();
+  printf("  writer %-5s get_fix %6.1f ns  get_position %6.1f ns  get_datetime %6.1f ns%s\n",
+    busy ? "busy" : "idle", fix_ns, position_ns, datetime_ns, sink ? "" : " ");
+}
+
+int main(int argc, char **argv)
+{
+  int readers = argc > 1 ? atoi(argv[1]) : 3;
+  double duration = argc > 2 ? atof(argv[2]) : 2.0;
+
+  generate();
+  printf("%d sentences, %zu bytes, %u hardware threads\n",
+    SENTENCES, data.size(), std::thread::hardware_concurrency());
+
+  printf("stress:\n");
+  stress(0, duration / 2);
+  bool ok = stress(readers, duration);
+
+  printf("read latency:\n");
+  latency(false);
+  latency(true);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+/*
+fixed_geo_bench - distance_between_fixed() and course_to_fixed() against
+the float versions and a double precision great circle
+
+Draws random pairs of points between 80 degrees south and north, in
+bands of separation from a metre to a few hundred kilometres, as the
+millionths of a degree get_position() gives. For each band it reports
+the worst distance error, as a fraction of the distance and in metres,
+and the worst course error of the integer and float versions against
+the double reference, then the time per call of each on this host in
+nanoseconds and, on x86, time stamp counter cycles. Courses are only
+compared over 10 m, below which a millionth of a degree is already
+more than a tenth of a degree of course.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. fixed_geo_bench.cpp ../../TinyGPS.cpp -o fixed_geo_bench
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <stdio.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#define PAIRS 200000
+
+static unsigned long random_state = 2463534242UL;
+
+static unsigned long random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state & 0xFFFFFFFFUL;
+}
+
+static double uniform(double lo, double hi)
+{
+  return lo + (hi - lo) * (random_next() % 10000000) / 10000000.0;
+}
+
+struct pair
+{
+  long lat1, lon1, lat2, lon2;
+};
+
+// great circle distance and initial course on the sphere of distance_between()
+static void reference(const pair &p, double *distance, double *course)
+{
+  double a = p.lat1 * 1e-6 * M_PI / 180, b = p.lat2 * 1e-6 * M_PI / 180;
+  double dlon = (p.lon2 - p.lon1) * 1e-6 * M_PI / 180;
+  double h = sin((b - a) / 2) * sin((b - a) / 2) + cos(a) * cos(b) * sin(dlon / 2) * sin(dlon / 2);
+  *distance = 2 * 6372795.0 * asin(sqrt(h));
+  double c = atan2(sin(dlon) * cos(b), cos(a) * sin(b) - sin(a) * cos(b) * cos(dlon)) * 180 / M_PI;
+  *course = c < 0 ? c + 360 : c;
+}
+
+static double course_error(double a, double b)
+{
+  double d = fabs(a - b);
+  return d > 180 ? 360 - d : d;
+}
+
+// pairs about range metres apart in a random direction
+static std::vector<pair> make_pairs(double range)
+{
+  std::vector<pair> pairs(PAIRS);
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    double lat = uniform(-79, 79), lon = uniform(-180, 180);
+    double d = range * uniform(0.5, 1.0) / 6372795.0 * 180 / M_PI;
+    double heading = uniform(0, 2 * M_PI);
+    double lat2 = lat + d * cos(heading), lon2 = lon + d * sin(heading) / cos(lat * M_PI / 180);
+    if (lon2 > 180) lon2 -= 360;
+    if (lon2 < -180) lon2 += 360;
+    pair p = { lround(lat * 1e6), lround(lon * 1e6), lround(lat2 * 1e6), lround(lon2 * 1e6) };
+    pairs[i] = p;
+  }
+  return pairs;
+}
+
+struct errors
+{
+  double relative, metres, course;
+};
+
+static void accuracy(double range)
+{
+  std::vector<pair> pairs = make_pairs(range);
+  errors fixed = {0, 0, 0}, flt = {0, 0, 0};
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    const pair &p = pairs[i];
+    double distance, course;
+    reference(p, &distance, &course);
+    float lat1 = p.lat1 / 1e6, lon1 = p.lon1 / 1e6, lat2 = p.lat2 / 1e6, lon2 = p.lon2 / 1e6;
+
+    double e = fabs(TinyGPS::distance_between_fixed(p.lat1, p.lon1, p.lat2, p.lon2) - distance);
+    if (e > fixed.metres) fixed.metres = e;
+    if (distance > 100 && e / distance > fixed.relative) fixed.relative = e / distance;
+    e = fabs(TinyGPS::distance_between(lat1, lon1, lat2, lon2) - distance);
+    if (e > flt.metres) flt.metres = e;
+    if (distance > 100 && e / distance > flt.relative) flt.relative = e / distance;
+
+    if (distance < 10)
+      continue;
+    e = course_error(TinyGPS::course_to_fixed(p.lat1, p.lon1, p.lat2, p.lon2) / 100.0, course);
+    if (e > fixed.course) fixed.course = e;
+    e = course_error(TinyGPS::course_to(lat1, lon1, lat2, lon2), course);
+    if (e > flt.course) flt.course = e;
+  }
+  printf("%9.0f m  fixed %8.4f%% %8.2f m %7.3f deg   float %8.4f%% %8.2f m %7.3f deg\n", range,
+    fixed.relative * 100, fixed.metres, fixed.course, flt.relative * 100, flt.metres, flt.course);
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long ticks()
+{
+#ifdef HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+template <class F>
+static void time_calls(const char *name, const std::vector<pair> &pairs, F f)
+{
+  double best = 1e9;
+  unsigned long long best_ticks = 0;
+  volatile double sink = 0;
+  for (int r = 0; r < 5; ++r)
+  {
+    double start = seconds();
+    unsigned long long t0 = ticks();
+    double sum = 0;
+    for (size_t i = 0; i < pairs.size(); ++i)
+      sum += f(pairs[i]);
+    unsigned long long t1 = ticks();
+    double elapsed = seconds() - start;
+    sink = sink + sum;
+    if (elapsed < best)
+    {
+      best = elapsed;
+      best_ticks = t1 - t0;
+    }
+  }
+  printf("  %-24s %8.1f ns %8.0f cycles\n", name, best / pairs.size() * 1e9,
+    (double)best_ticks / pairs.size());
+}
+
+static double fixed_distance(const pair &p) { return TinyGPS::distance_between_fixed(p.lat1, p.lon1, p.lat2, p.lon2); }
+static double fixed_course(const pair &p) { return TinyGPS::course_to_fixed(p.lat1, p.lon1, p.lat2, p.lon2); }
+static double float_distance(const pair &p)
+  { return TinyGPS::distance_between(p.lat1 / 1e6f, p.lon1 / 1e6f, p.lat2 / 1e6f, p.lon2 / 1e6f); }
+static double float_course(const pair &p)
+  { return TinyGPS::course_to(p.lat1 / 1e6f, p.lon1 / 1e6f, p.lat2 / 1e6f, p.lon2 / 1e6f); }
+
+int main()
+{
+  printf("worst errors against a double great circle; %% over 100 m\n");
+  static const double ranges[] = { 2, 20, 200, 2000, 10000, 30000, 55000, 200000 };
+  for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i)
+    accuracy(ranges[i]);
+
+  printf("time per call, pairs up to 2 km apart:\n");
+  std::vector<pair> pairs = make_pairs(2000);
+  time_calls("distance_between_fixed", pairs, fixed_distance);
+  time_calls("distance_between", pairs, float_distance);
+  time_calls("course_to_fixed", pairs, fixed_course);
+  time_calls("course_to", pairs, float_course);
+  return 0;
+}
@@ -0,0 +1,227 @@
+/*
+fleet_bench - TinyGPSFleet against one TinyGPS object per stream
+
+Generates an RMC and a GGA sentence per second for each of N vehicles,
+with valid checksums and a moving position, cuts each vehicle's stream
+into chunks and interleaves the chunks vehicle by vehicle as a server
+receiving from N sockets would. The same chunks are then decoded by a
+TinyGPSFleet and by N separate TinyGPS objects, at several N. It reports
+the throughput of both, the heap each uses per stream, and checks that
+both commit the same fixes and count the same valid sentences.
+
+A first pass with random chunk sizes and a random order of streams
+checks the equivalence on a harder interleaving before timing.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. fleet_bench.cpp ../../TinyGPS.cpp ../../TinyGPSFleet.cpp -o fleet_bench
+
+and run as
+
+  ./fleet_bench [megabytes per run] [chunk size]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSFleet.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static unsigned long random_state = 2463534242UL;
+
+static unsigned long random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state & 0xFFFFFFFFUL;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t heap_in_use()
+{
+#ifdef __GLIBC__
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static void append_sentence(std::string &out, const char *body)
+{
+  unsigned char parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// "seconds" seconds of one vehicle
+static std::string vehicle_stream(unsigned vehicle, unsigned seconds)
+{
+  double lat = 30 + (random_next() % 30000) / 1000.0, lon = -10 + (random_next() % 40000) / 1000.0;
+  double knots = 5 + random_next() % 50, course = random_next() % 360;
+  std::string out;
+  char body[120];
+  for (unsigned t = 0; t < seconds; ++t)
+  {
+    unsigned s = (vehicle * 7 + t) % 86400;
+    lat += knots * 0.514 * cos(course * M_PI / 180) / 111195.0;
+    lon += knots * 0.514 * sin(course * M_PI / 180) / 111195.0 / cos(lat * M_PI / 180);
+    double lat_min = (lat - (int)lat) * 60, lon_min = (lon - (int)lon) * 60;
+    snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.00,A,%02d%07.4f,N,%03d%07.4f,%c,%.2f,%.2f,240413,,,A",
+      s / 3600, s / 60 % 60, s % 60, (int)lat, lat_min, abs((int)lon), fabs(lon_min), lon < 0 ? 'W' : 'E',
+      knots, course);
+    append_sentence(out, body);
+    snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,%02d%07.4f,N,%03d%07.4f,%c,1,%02lu,0.9,%.1f,M,47.0,M,,",
+      s / 3600, s / 60 % 60, s % 60, (int)lat, lat_min, abs((int)lon), fabs(lon_min), lon < 0 ? 'W' : 'E',
+      5 + random_next() % 8, 30 + (random_next() % 1000) / 10.0);
+    append_sentence(out, body);
+    knots += (random_next() % 5) - 2.0;
+    if (knots < 1) knots = 1;
+    course = fmod(course + (random_next() % 11) - 5.0 + 360, 360);
+  }
+  return out;
+}
+
+struct chunk
+{
+  unsigned short stream;
+  const char *data;
+  unsigned short len;
+};
+
+// round robin over the streams, "size" characters at a time, or random
+// sizes up to "size" and a random stream order if "shuffle"
+static std::vector<chunk> interleave(const std::vector<std::string> &streams, unsigned size, bool shuffle)
+{
+  std::vector<chunk> chunks;
+  std::vector<size_t> offset(streams.size(), 0);
+  std::vector<unsigned short> live;
+  for (unsigned short i = 0; i < streams.size(); ++i)
+    live.push_back(i);
+  while (!live.empty())
+  {
+    for (size_t k = 0; k < live.size(); )
+    {
+      size_t j = shuffle ? random_next() % live.size() : k;
+      unsigned short s = live[j];
+      size_t n = shuffle ? 1 + random_next() % size : size;
+      if (n > streams[s].size() - offset[s]) n = streams[s].size() - offset[s];
+      chunk c = { s, streams[s].data() + offset[s], (unsigned short)n };
+      chunks.push_back(c);
+      offset[s] += n;
+      if (offset[s] == streams[s].size())
+      {
+        live[j] = live.back();
+        live.pop_back();
+        if (!shuffle) continue;
+      }
+      ++k;
+    }
+  }
+  return chunks;
+}
+
+static bool same_fix(const TinyGPSFix &a, const TinyGPSFix &b)
+{
+  return a.time == b.time && a.date == b.date && a.latitude == b.latitude && a.longitude == b.longitude
+    && a.altitude == b.altitude && a.speed == b.speed && a.course == b.course && a.hdop == b.hdop
+    && a.satellites == b.satellites;
+}
+
+struct result
+{
+  double fleet_mbs, separate_mbs;
+  double fleet_bytes, separate_bytes;
+  unsigned long mismatches;
+};
+
+static result run(const std::vector<std::string> &streams, const std::vector<chunk> &chunks, size_t total)
+{
+  unsigned short n = streams.size();
+  result r;
+
+  size_t heap = heap_in_use();
+  TinyGPSFleet *fleet = new TinyGPSFleet(n);
+  r.fleet_bytes = (double)(heap_in_use() - heap) / n;
+  heap = heap_in_use();
+  std::vector<TinyGPS> *separate = new std::vector<TinyGPS>(n);
+  r.separate_bytes = (double)(heap_in_use() - heap) / n;
+
+  unsigned long fleet_valid = 0, separate_valid = 0;
+  double start = seconds();
+  for (size_t i = 0; i < chunks.size(); ++i)
+    fleet_valid += fleet->encode(chunks[i].stream, chunks[i].data, chunks[i].len);
+  r.fleet_mbs = total / (seconds() - start) / 1e6;
+
+  start = seconds();
+  for (size_t i = 0; i < chunks.size(); ++i)
+    separate_valid += (*separate)[chunks[i].stream].encode(chunks[i].data, chunks[i].len);
+  r.separate_mbs = total / (seconds() - start) / 1e6;
+
+  r.mismatches = fleet_valid != separate_valid;
+  for (unsigned short s = 0; s < n; ++s)
+  {
+    TinyGPSFix f;
+    (*separate)[s].get_fix(&f);
+    r.mismatches += !same_fix(fleet->fix(s), f);
+  }
+  delete fleet;
+  delete separate;
+  return r;
+}
+
+int main(int argc, char **argv)
+{
+  double megabytes = argc > 1 ? atof(argv[1]) : 64;
+  unsigned size = argc > 2 ? atoi(argv[2]) : 64;
+  static const unsigned counts[] = { 1, 16, 256, 4096, 60000 };
+  unsigned long errors = 0;
+
+  // equivalence on random chunk sizes and order first
+  {
+    std::vector<std::string> streams;
+    for (unsigned i = 0; i < 64; ++i)
+      streams.push_back(vehicle_stream(i, 120));
+    std::vector<chunk> chunks = interleave(streams, 2 * size, true);
+    result r = run(streams, chunks, 1);
+    printf("random interleaving of 64 streams: %lu mismatches\n", r.mismatches);
+    errors += r.mismatches;
+  }
+
+  printf("%.0f MB per run in %u character chunks, sizeof(TinyGPS) = %u\n", megabytes, size, (unsigned)sizeof(TinyGPS));
+  printf("  streams   fleet MB/s  separate MB/s   fleet bytes/stream  separate bytes/stream\n");
+  for (unsigned k = 0; k < sizeof(counts) / sizeof(counts[0]); ++k)
+  {
+    unsigned n = counts[k];
+    unsigned per_stream = (unsigned)(megabytes * 1e6 / n / 145) + 1;
+    std::vector<std::string> streams;
+    size_t total = 0;
+    for (unsigned i = 0; i < n; ++i)
+    {
+      streams.push_back(vehicle_stream(i, per_stream));
+      total += streams.back().size();
+    }
+    std::vector<chunk> chunks = interleave(streams, size, false);
+    result r = run(streams, chunks, total);
+    printf("  %7u %12.1f %14.1f %20.1f %22.1f%s\n", n, r.fleet_mbs, r.separate_mbs, r.fleet_bytes,
+      r.separate_bytes, r.mismatches ? "  fixes differ" : "");
+    errors += r.mismatches;
+  }
+  return errors != 0;
+}
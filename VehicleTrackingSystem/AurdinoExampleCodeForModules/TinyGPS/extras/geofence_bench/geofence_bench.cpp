@@ -0,0 +1,211 @@
+/*
+geofence_bench - host benchmark of TinyGPSGeofence
+
+Scatters circle and polygon fences (depots and customer sites, 50 m to
+500 m across) over a 30 km square, drives a vehicle through them at
+1 Hz, and reports the time per fix as the number of fences grows. The
+same drive is checked against a plain float implementation that tests
+every fence with distance_between() and a point-in-polygon loop; the
+two disagree only on fixes within a unit or so of a fence's edge.
+It also checks that a fix handed to update() again, as a loop polling
+the same TinyGPS does between sentences, counts once towards debounce.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. geofence_bench.cpp ../../TinyGPS.cpp -o geofence_bench
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSGeofence.h"
+#include <stdio.h>
+#include <vector>
+
+#define ORIGIN_LAT 12971599L
+#define ORIGIN_LON 77594566L
+
+struct site
+{
+  bool circle;
+  long lat, lon;              // centre
+  unsigned long radius;       // metres
+  long plat[6], plon[6];      // polygon
+};
+
+static unsigned long random_state = 12345;
+
+static long random_between(long lo, long hi)
+{
+  random_state = random_state * 1103515245UL + 12345UL;
+  return lo + (long)((random_state >> 8) % (unsigned long)(hi - lo + 1));
+}
+
+static void make_sites(std::vector<site> &sites, unsigned count)
+{
+  sites.clear();
+  for (unsigned i = 0; i < count; ++i)
+  {
+    site s;
+    s.circle = i % 2 == 0;
+    s.lat = ORIGIN_LAT + random_between(-135000, 135000);
+    s.lon = ORIGIN_LON + random_between(-135000, 135000);
+    s.radius = random_between(25, 250);
+    for (int k = 0; k < 6; ++k)
+    {
+      double a = k * PI / 3 + random_between(-30, 30) / 100.0;
+      double r = random_between(200, 2200);   // millionths of a degree
+      s.plat[k] = s.lat + (long)(r * sin(a));
+      s.plon[k] = s.lon + (long)(r * cos(a));
+    }
+    sites.push_back(s);
+  }
+}
+
+// a vehicle that drives from one site to another, pausing at each
+static void make_drive(const std::vector<site> &sites, std::vector<long> &lat, std::vector<long> &lon, unsigned fixes)
+{
+  double y = ORIGIN_LAT, x = ORIGIN_LON;
+  size_t target = 0;
+
+  lat.clear();
+  lon.clear();
+  while (lat.size() < fixes)
+  {
+    const site &s = sites[target];
+    double dy = s.lat - y, dx = s.lon - x;
+    double d = sqrt(dx * dx + dy * dy);
+    if (d < 150)
+    {
+      for (int k = 0; k < 20 && lat.size() < fixes; ++k)
+      {
+        lat.push_back((long)y + random_between(-20, 20));
+        lon.push_back((long)x + random_between(-20, 20));
+      }
+      target = random_between(0, sites.size() - 1);
+      continue;
+    }
+    double step = d < 130 ? d : 130;   // about 15 m/s
+    y += dy / d * step;
+    x += dx / d * step;
+    lat.push_back((long)y);
+    lon.push_back((long)x);
+  }
+}
+
+static bool float_inside(const site &s, long lat, long lon)
+{
+  float flat = lat / 1000000.0, flon = lon / 1000000.0;
+  if (s.circle)
+    return TinyGPS::distance_between(flat, flon, s.lat / 1000000.0, s.lon / 1000000.0) <= s.radius;
+
+  bool in = false;
+  for (int i = 0, j = 5; i < 6; j = i++)
+  {
+    float yi = s.plat[i] / 1000000.0, yj = s.plat[j] / 1000000.0;
+    float xi = s.plon[i] / 1000000.0, xj = s.plon[j] / 1000000.0;
+    if ((yi > flat) != (yj > flat) && flon < (xj - xi) * (flat - yi) / (yj - yi) + xi)
+      in = !in;
+  }
+  return in;
+}
+
+static unsigned long transitions;
+
+static void count_transition(unsigned short, bool)
+{
+  ++transitions;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <unsigned short FENCES, byte GRID>
+static void run(unsigned count)
+{
+  typedef TinyGPSGeofence<FENCES, FENCES * 4, FENCES * 4, GRID, 8> geofence;
+  std::vector<site> sites;
+  std::vector<long> lat, lon;
+  make_sites(sites, count);
+  make_drive(sites, lat, lon, 20000);
+
+  static geofence fences(ORIGIN_LAT, ORIGIN_LON, count_transition, 0, 1);
+  for (unsigned i = 0; i < count; ++i)
+  {
+    int id = sites[i].circle
+      ? fences.add_circle(sites[i].lat, sites[i].lon, sites[i].radius)
+      : fences.add_polygon(sites[i].plat, sites[i].plon, 6);
+    if (id != (int)i)
+      printf("fence %u not added\n", i);
+  }
+  if (!fences.build())
+    printf("grid entries overflow\n");
+
+  // agreement with the float version, fix by fix, with no hysteresis
+  unsigned long disagreements = 0, inside = 0;
+  for (size_t k = 0; k < lat.size(); ++k)
+  {
+    fences.update(lat[k], lon[k]);
+    for (unsigned i = 0; i < count; ++i)
+    {
+      bool expected = float_inside(sites[i], lat[k], lon[k]);
+      inside += expected;
+      disagreements += fences.inside(i) != expected;
+    }
+  }
+
+  transitions = 0;
+  double start = seconds();
+  for (size_t k = 0; k < lat.size(); ++k)
+    fences.update(lat[k], lon[k]);
+  double indexed = (seconds() - start) / lat.size();
+
+  volatile unsigned long sink = 0;
+  start = seconds();
+  for (size_t k = 0; k < lat.size(); ++k)
+    for (unsigned i = 0; i < count; ++i)
+      sink += float_inside(sites[i], lat[k], lon[k]);
+  double brute = (seconds() - start) / lat.size();
+
+  printf("%6u %4u %10.0f %12.0f %10lu %8lu/%lu\n",
+    count, GRID, indexed * 1e9, brute * 1e9, transitions, disagreements, inside);
+}
+
+int main()
+{
+  printf("fences grid  ns/fix  float ns/fix transitions disagree/inside\n");
+  run<16, 4>(10);
+  run<64, 8>(50);
+  run<128, 8>(100);
+  run<256, 8>(200);
+  run<256, 16>(200);
+  run<512, 16>(500);
+  run<1024, 16>(1000);
+  run<1024, 32>(1000);
+
+  // the same fix five times must not pass a debounce of two
+  static TinyGPSGeofence<4, 4, 16, 4> depot(ORIGIN_LAT, ORIGIN_LON, count_transition, 10, 2);
+  depot.add_circle(ORIGIN_LAT, ORIGIN_LON, 100);
+  depot.build();
+  TinyGPSFix fix;
+  fix.latitude = ORIGIN_LAT;
+  fix.longitude = ORIGIN_LON;
+  fix.position_fix = 1000;
+  transitions = 0;
+  for (int i = 0; i < 5; ++i)
+    depot.update(fix);
+  unsigned long repeated = transitions;
+  fix.position_fix = 2000;
+  depot.update(fix);
+  bool debounced = repeated == 0 && transitions == 1;
+  printf("\nrepeated fix: %lu transitions, next fix: %lu (%s)\n", repeated, transitions - repeated,
+    debounced ? "ok" : "wrong");
+
+  printf("\nsizeof(TinyGPSGeofence<200, 800, 400>) on this host: %u bytes\n",
+    (unsigned)sizeof(TinyGPSGeofence<200, 800, 400>));
+  return !debounced;
+}
@@ -0,0 +1,42 @@
+/*
+Host stand-in for the parts of the Arduino core TinyGPS uses, so the
+library and the tools in extras/ can be compiled with a desktop compiler:
+
+  g++ -O2 -I<path to TinyGPS>/extras/host -I<path to TinyGPS> ...
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#ifndef WProgram_h
+#define WProgram_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef unsigned char byte;
+
+#define PI 3.1415926535897932384626433832795
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const unsigned char *)(p))
+#define pgm_read_word(p) (*(const unsigned short *)(p))
+
+inline unsigned long millis()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)ts.tv_sec * 1000UL + ts.tv_nsec / 1000000L;
+}
+
+#endif
@@ -0,0 +1,402 @@
+/*
+nmea_ingest - parses NMEA archives on every core and merges the fixes
+
+Each file is one vehicle's stream. Files are memory-mapped and cut into
+chunks of about a megabyte, every cut moved forward to the next '$', so
+no sentence is split between chunks: TinyGPS drops a partial sentence
+when it sees '$', exactly as it would have on the unsplit stream. Worker
+threads take chunks from their own deque and steal from the back of the
+others' when theirs runs dry, and parse each chunk with a fresh TinyGPS
+a line at a time, keeping the fix after each line that committed a
+sentence.
+
+A fresh parser has not seen what came before its chunk, so a field the
+chunk has not committed yet still holds its invalid value. The merge
+walks each stream's chunks in file order and fills such fields from the
+last fix of the chunk before, which gives the fixes a single parser
+reading the whole file would have given. Fix times come from a replay
+clock of the bytes up to the end of the line at the given baud rate,
+which also does not depend on where the chunks were cut.
+
+The run is repeated with 1, 2, 4 ... up to the given number of threads,
+and the merged fixes are checked against a sequential pass.
+
+Build from this directory on Linux with
+
+  g++ -O2 -std=c++11 -pthread -I../host -I../.. nmea_ingest.cpp ../../TinyGPS.cpp -o nmea_ingest
+
+and run as
+
+  ./nmea_ingest [-j threads] [-c chunk_bytes] [-b baud] [-o fixes.csv] vehicle.nmea ...
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <atomic>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static unsigned long baud = 4800;
+
+// bytes of the stream up to the end of the line being encoded, per thread
+static thread_local unsigned long long replayed;
+
+static unsigned long replay_clock()
+{
+  // 10 bits per character on the wire
+  return (unsigned long)(replayed * 10000ULL / baud);
+}
+
+struct stream
+{
+  const char *name;
+  const char *data;
+  size_t len;
+};
+
+struct chunk
+{
+  unsigned stream;
+  size_t begin, end;
+  std::vector<TinyGPSFix> fixes;
+  unsigned long long sentences, failed;
+};
+
+static std::vector<stream> streams;
+static std::vector<chunk> chunks;
+
+// cuts every stream at the first '$' at or after each multiple of size
+static void split(size_t size)
+{
+  chunks.clear();
+  for (unsigned s = 0; s < streams.size(); ++s)
+  {
+    const stream &st = streams[s];
+    size_t begin = 0;
+    while (begin < st.len)
+    {
+      size_t end = begin + size;
+      if (end >= st.len)
+        end = st.len;
+      else
+      {
+        const char *p = (const char *)memchr(st.data + end, '$', st.len - end);
+        end = p ? p - st.data : st.len;
+      }
+      chunk c;
+      c.stream = s;
+      c.begin = begin;
+      c.end = end;
+      c.sentences = c.failed = 0;
+      chunks.push_back(c);
+      begin = end;
+    }
+  }
+}
+
+// parses bytes [begin, end) of a stream a line at a time with a fresh parser
+static void parse(const stream &st, size_t begin, size_t end, std::vector<TinyGPSFix> *fixes,
+  unsigned long long *sentences, unsigned long long *failed)
+{
+  TinyGPS gps;
+  unsigned short last_failed = 0;
+  const char *p = st.data + begin, *stop = st.data + end;
+  while (p < stop)
+  {
+    const char *nl = (const char *)memchr(p, '\n', stop - p);
+    const char *line_end = nl ? nl + 1 : stop;
+    replayed = line_end - st.data;
+    unsigned valid = gps.encode(p, line_end - p);
+    if (valid)
+    {
+      TinyGPSFix f;
+      gps.get_fix(&f);
+      fixes->push_back(f);
+      *sentences += valid;
+    }
+    unsigned long chars;
+    unsigned short good, failed_cs;
+    gps.stats(&chars, &good, &failed_cs);
+    *failed += (unsigned short)(failed_cs - last_failed);
+    last_failed = failed_cs;
+    p = line_end;
+  }
+}
+
+//
+// work-stealing scheduler
+//
+
+struct worker_queue
+{
+  std::mutex lock;
+  std::deque<size_t> tasks;
+};
+
+static std::vector<worker_queue> queues;
+static std::atomic<unsigned long> steals;
+
+static bool take(unsigned self, size_t *task)
+{
+  {
+    std::lock_guard<std::mutex> guard(queues[self].lock);
+    if (!queues[self].tasks.empty())
+    {
+      *task = queues[self].tasks.front();
+      queues[self].tasks.pop_front();
+      return true;
+    }
+  }
+  // steal from the far end of the others, where their last chunks are
+  for (unsigned i = 1; i < queues.size(); ++i)
+  {
+    worker_queue &victim = queues[(self + i) % queues.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tasks.empty())
+    {
+      *task = victim.tasks.back();
+      victim.tasks.pop_back();
+      ++steals;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void worker(unsigned self)
+{
+  size_t task;
+  while (take(self, &task))
+  {
+    chunk &c = chunks[task];
+    c.fixes.clear();
+    c.sentences = c.failed = 0;
+    parse(streams[c.stream], c.begin, c.end, &c.fixes, &c.sentences, &c.failed);
+  }
+}
+
+static void run(unsigned threads)
+{
+  std::vector<worker_queue> fresh(threads);
+  queues.swap(fresh);
+  steals = 0;
+  // contiguous runs of chunks per thread, so stealing evens out the rest
+  for (size_t i = 0; i < chunks.size(); ++i)
+    queues[i * threads / chunks.size()].tasks.push_back(i);
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t)
+    pool.push_back(std::thread(worker, t));
+  worker(0);
+  for (size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+}
+
+//
+// merge
+//
+
+static void fill(unsigned long *field, unsigned long from, unsigned long invalid)
+{
+  if (*field == invalid)
+    *field = from;
+}
+
+static void fill(long *field, long from, long invalid)
+{
+  if (*field == invalid)
+    *field = from;
+}
+
+// fields the chunk has not committed yet take the carried values
+static void fill(TinyGPSFix *f, const TinyGPSFix &carry)
+{
+  fill(&f->time, carry.time, TinyGPS::GPS_INVALID_TIME);
+  fill(&f->date, carry.date, TinyGPS::GPS_INVALID_DATE);
+  fill(&f->latitude, carry.latitude, TinyGPS::GPS_INVALID_ANGLE);
+  fill(&f->longitude, carry.longitude, TinyGPS::GPS_INVALID_ANGLE);
+  fill(&f->altitude, carry.altitude, TinyGPS::GPS_INVALID_ALTITUDE);
+  fill(&f->speed, carry.speed, TinyGPS::GPS_INVALID_SPEED);
+  fill(&f->course, carry.course, TinyGPS::GPS_INVALID_ANGLE);
+  fill(&f->hdop, carry.hdop, TinyGPS::GPS_INVALID_HDOP);
+  if (f->satellites == TinyGPS::GPS_INVALID_SATELLITES)
+    f->satellites = carry.satellites;
+  fill(&f->time_fix, carry.time_fix, TinyGPS::GPS_INVALID_FIX_TIME);
+  fill(&f->position_fix, carry.position_fix, TinyGPS::GPS_INVALID_FIX_TIME);
+}
+
+// chunks are in stream order and file order within a stream
+static void merge()
+{
+  TinyGPSFix carry;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    if (i == 0 || chunks[i].stream != chunks[i - 1].stream)
+    {
+      TinyGPS fresh;
+      fresh.get_fix(&carry);
+    }
+    std::vector<TinyGPSFix> &fixes = chunks[i].fixes;
+    for (size_t j = 0; j < fixes.size(); ++j)
+      fill(&fixes[j], carry);
+    if (!fixes.empty())
+      carry = fixes.back();
+  }
+}
+
+static bool same(const TinyGPSFix &a, const TinyGPSFix &b)
+{
+  return a.time == b.time && a.date == b.date && a.latitude == b.latitude &&
+    a.longitude == b.longitude && a.altitude == b.altitude && a.speed == b.speed &&
+    a.course == b.course && a.hdop == b.hdop && a.satellites == b.satellites &&
+    a.time_fix == b.time_fix && a.position_fix == b.position_fix;
+}
+
+// compares the merged fixes of each stream with a sequential pass
+static unsigned long long verify()
+{
+  unsigned long long mismatches = 0;
+  size_t c = 0;
+  for (unsigned s = 0; s < streams.size(); ++s)
+  {
+    std::vector<TinyGPSFix> expected;
+    unsigned long long sentences = 0, failed = 0;
+    parse(streams[s], 0, streams[s].len, &expected, &sentences, &failed);
+
+    size_t k = 0;
+    for (; c < chunks.size() && chunks[c].stream == s; ++c)
+      for (size_t j = 0; j < chunks[c].fixes.size(); ++j, ++k)
+        mismatches += k >= expected.size() || !same(chunks[c].fixes[j], expected[k]);
+    if (k != expected.size())
+      mismatches += k > expected.size() ? 0 : expected.size() - k;
+  }
+  return mismatches;
+}
+
+static void write_csv(const char *path)
+{
+  FILE *out = fopen(path, "w");
+  if (!out)
+  {
+    perror(path);
+    return;
+  }
+  fprintf(out, "stream,date,time,latitude,longitude,altitude,speed,course,hdop,satellites,time_fix,position_fix\n");
+  for (size_t c = 0; c < chunks.size(); ++c)
+    for (size_t j = 0; j < chunks[c].fixes.size(); ++j)
+    {
+      const TinyGPSFix &f = chunks[c].fixes[j];
+      fprintf(out, "%s,%lu,%lu,%ld,%ld,%ld,%lu,%lu,%lu,%u,%lu,%lu\n", streams[chunks[c].stream].name,
+        f.date, f.time, f.latitude, f.longitude, f.altitude, f.speed, f.course, f.hdop,
+        f.satellites, f.time_fix, f.position_fix);
+    }
+  fclose(out);
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned max_threads = std::thread::hardware_concurrency();
+  size_t chunk_size = 1 << 20;
+  const char *csv = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:c:b:o:")) != -1)
+  {
+    if (opt == 'j')
+      max_threads = strtoul(optarg, 0, 0);
+    else if (opt == 'c')
+      chunk_size = strtoul(optarg, 0, 0);
+    else if (opt == 'b')
+      baud = strtoul(optarg, 0, 0);
+    else if (opt == 'o')
+      csv = optarg;
+    else
+      break;
+  }
+  if (optind == argc || !max_threads || !chunk_size || !baud)
+  {
+    fprintf(stderr, "usage: %s [-j threads] [-c chunk_bytes] [-b baud] [-o fixes.csv] vehicle.nmea ...\n", argv[0]);
+    return 2;
+  }
+
+  size_t total = 0;
+  for (int i = optind; i < argc; ++i)
+  {
+    int fd = open(argv[i], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+      perror(argv[i]);
+      return 1;
+    }
+    stream s = { argv[i], 0, (size_t)st.st_size };
+    if (s.len)
+    {
+      s.data = (const char *)mmap(0, s.len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (s.data == MAP_FAILED)
+      {
+        perror(argv[i]);
+        return 1;
+      }
+    }
+    close(fd);
+    streams.push_back(s);
+    total += s.len;
+  }
+
+  TinyGPS::set_clock(replay_clock);
+  split(chunk_size);
+  printf("%zu streams, %zu bytes, %zu chunks, %u hardware threads\n",
+    streams.size(), total, chunks.size(), std::thread::hardware_concurrency());
+  printf("threads    seconds      MB/s  speedup  steals\n");
+
+  double one = 0;
+  for (unsigned threads = 1; ; threads *= 2)
+  {
+    if (threads > max_threads)
+      threads = max_threads;
+    double start = seconds();
+    run(threads);
+    merge();
+    double elapsed = seconds() - start;
+    if (threads == 1)
+      one = elapsed;
+    printf("%7u %10.3f %9.1f %8.2f %7lu\n", threads, elapsed, total / elapsed / 1e6,
+      one / elapsed, steals.load());
+    if (threads == max_threads)
+      break;
+  }
+
+  unsigned long long sentences = 0, failed = 0, fixes = 0;
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    sentences += chunks[c].sentences;
+    failed += chunks[c].failed;
+    fixes += chunks[c].fixes.size();
+  }
+  printf("%llu sentences, %llu failed checksums, %llu fixes\n", sentences, failed, fixes);
+
+  unsigned long long mismatches = verify();
+  printf("%llu fixes differ from a sequential pass\n", mismatches);
+
+  if (csv)
+    write_csv(csv);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+/*
+nmea_replay - replays NMEA capture files through TinyGPS as fast as it can
+
+Memory-maps each file and feeds it to TinyGPS one character at a time
+with encode(char), then again in chunks with encode(buf, len), and
+reports throughput, sentences, checksum failures and committed fixes
+for each. TinyGPS runs on a replay clock that advances with the bytes
+fed at the capture's baud rate, so fix ages come out as they would on
+the device and the same on every run. Fixes are counted as new position
+time stamps after each call, so in chunks at most one per chunk.
+
+Build from this directory on Linux with
+
+  g++ -O2 -I../host -I../.. nmea_replay.cpp ../../TinyGPS.cpp -o nmea_replay
+
+and run as
+
+  ./nmea_replay [-b baud] [-c chunk_bytes] capture.nmea ...
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// bytes fed so far, and what that means in milliseconds at the baud rate
+static unsigned long long replayed;
+static unsigned long baud = 4800;
+
+static unsigned long replay_clock()
+{
+  // 10 bits per character on the wire
+  return (unsigned long)(replayed * 10000ULL / baud);
+}
+
+struct result
+{
+  unsigned long long sentences, failed, fixes;
+  double seconds;
+};
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// the stats counters are 16 bits: fold them into 64-bit totals often enough
+struct failure_counter
+{
+  unsigned short last;
+  failure_counter() : last(0) {}
+  unsigned long long take(TinyGPS &gps)
+  {
+    unsigned long chars;
+    unsigned short good, failed;
+    gps.stats(&chars, &good, &failed);
+    unsigned short delta = failed - last;
+    last = failed;
+    return delta;
+  }
+};
+
+// a committed position has a new time stamp on the replay clock
+static bool new_fix(TinyGPS &gps, unsigned long *last)
+{
+  long lat, lon;
+  unsigned long age;
+  gps.get_position(&lat, &lon, &age);
+  if (age == TinyGPS::GPS_INVALID_AGE || replay_clock() - age == *last)
+    return false;
+  *last = replay_clock() - age;
+  return true;
+}
+
+static result per_char(const char *data, size_t len)
+{
+  TinyGPS gps;
+  failure_counter failures;
+  result r = {0, 0, 0, 0};
+  unsigned long last_fix = TinyGPS::GPS_INVALID_FIX_TIME;
+
+  replayed = 0;
+  double start = seconds();
+  for (size_t i = 0; i < len; ++i)
+  {
+    ++replayed;
+    if (gps.encode(data[i]))
+    {
+      ++r.sentences;
+      r.fixes += new_fix(gps, &last_fix);
+    }
+    if ((i & 0xFFFF) == 0xFFFF)
+      r.failed += failures.take(gps);
+  }
+  r.seconds = seconds() - start;
+  r.failed += failures.take(gps);
+  return r;
+}
+
+static result bulk(const char *data, size_t len, size_t chunk)
+{
+  TinyGPS gps;
+  failure_counter failures;
+  result r = {0, 0, 0, 0};
+  unsigned long last_fix = TinyGPS::GPS_INVALID_FIX_TIME;
+  size_t since_take = 0;
+
+  replayed = 0;
+  double start = seconds();
+  for (size_t i = 0; i < len; i += chunk)
+  {
+    size_t n = len - i < chunk ? len - i : chunk;
+    replayed += n;
+    unsigned valid = gps.encode(data + i, n);
+    if (valid)
+    {
+      r.sentences += valid;
+      r.fixes += new_fix(gps, &last_fix);
+    }
+    if ((since_take += n) >= 0x10000)
+    {
+      r.failed += failures.take(gps);
+      since_take = 0;
+    }
+  }
+  r.seconds = seconds() - start;
+  r.failed += failures.take(gps);
+  return r;
+}
+
+static void report(const char *mode, size_t len, const result &r)
+{
+  unsigned long long all = r.sentences + r.failed;
+  printf("  %-18s %9.1f MB/s %11.0f sentences/s %12llu sentences %7.3f%% failed %12llu fixes\n",
+    mode, len / r.seconds / 1e6, r.sentences / r.seconds, r.sentences,
+    all ? 100.0 * r.failed / all : 0.0, r.fixes);
+}
+
+int main(int argc, char **argv)
+{
+  size_t chunk = 64;
+  int status = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:c:")) != -1)
+  {
+    if (opt == 'b')
+      baud = strtoul(optarg, 0, 0);
+    else if (opt == 'c')
+      chunk = strtoul(optarg, 0, 0);
+    else
+      break;
+  }
+  if (optind == argc || !baud || !chunk)
+  {
+    fprintf(stderr, "usage: %s [-b baud] [-c chunk_bytes] capture.nmea ...\n", argv[0]);
+    return 2;
+  }
+
+  TinyGPS::set_clock(replay_clock);
+
+  for (int i = optind; i < argc; ++i)
+  {
+    int fd = open(argv[i], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+      perror(argv[i]);
+      if (fd >= 0) close(fd);
+      status = 1;
+      continue;
+    }
+
+    size_t len = st.st_size;
+    const char *data = len ? (const char *)mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0) : 0;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+      perror(argv[i]);
+      status = 1;
+      continue;
+    }
+    if (len)
+      madvise((void *)data, len, MADV_SEQUENTIAL);
+
+    printf("%s: %zu bytes, %.0f s of data at %lu baud\n", argv[i], len, len * 10.0 / baud, baud);
+    report("encode(char)", len, per_char(data, len));
+    char mode[48];
+    snprintf(mode, sizeof(mode), "encode(buf, %zu)", chunk);
+    report(mode, len, bulk(data, len, chunk));
+
+    if (len)
+      munmap((void *)data, len);
+  }
+  return status;
+}
@@ -0,0 +1,183 @@
+/*
+ring_stress - a producer thread against TinyGPSRing::drain()
+
+A producer thread puts a log of GGA sentences into a TinyGPSRing while
+the main thread drains it into a TinyGPS, both as fast as they can.
+Every sentence carries its sequence number twice, as its time and as
+its altitude, so a fix assembled from bytes of different sentences, or
+from a sentence older than the last one, shows up after any drain.
+
+Two runs:
+
+  lossless  the producer retries put(c) while the ring is full; every
+            character must arrive once and in order: as many valid
+            sentences as were sent, no checksum failures, the fixes in
+            sequence and the character count equal to the bytes sent.
+            The refused put() calls are still counted as overflows
+  lossy     the producer never waits and mixes in put(buf, len), on a
+            smaller ring, and the consumer pauses now and then; the
+            characters encode() saw plus overflows() must equal the
+            bytes sent, stats() must report the same dropped count, and
+            the fixes that got through must be in sequence. A drop can
+            splice two sentences into one that passes the XOR checksum
+            by chance; those are counted, not failed
+
+Build from this directory with
+
+  g++ -O2 -pthread -I../host -I../.. ring_stress.cpp ../../TinyGPS.cpp -o ring_stress
+
+(add -fsanitize=thread to have the accesses checked as well) and run as
+
+  ./ring_stress [sentences]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSRing.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string>
+
+static std::string make_log(unsigned sentences)
+{
+  std::string out;
+  char body[100];
+  for (unsigned seq = 1; seq <= sentences; ++seq)
+  {
+    unsigned s = seq % 86400;
+    snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,5231.2005,N,01324.2973,E,1,09,0.9,%u.00,M,47.0,M,,",
+      s / 3600, s / 60 % 60, s % 60, seq);
+    unsigned char parity = 0;
+    for (const char *p = body; *p; ++p)
+      parity ^= *p;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+    out += '$';
+    out += body;
+    out += tail;
+  }
+  return out;
+}
+
+template <unsigned N>
+struct producer
+{
+  TinyGPSRing<N> *ring;
+  const std::string *log;
+  bool lossless;
+  volatile bool done;
+
+  static void *run(void *arg)
+  {
+    producer &p = *(producer *)arg;
+    const char *buf = p.log->data();
+    size_t len = p.log->size(), sent = 0;
+    unsigned long step = 0;
+    while (sent < len)
+    {
+      // put(buf, len) counts what does not fit as dropped, so only the
+      // lossy run mixes in blocks of up to 97 characters
+      size_t n = p.lossless || ++step % 3 ? 1 : 1 + step % 97;
+      if (n > len - sent) n = len - sent;
+      if (n > 1)
+      {
+        p.ring->put(buf + sent, n);
+        sent += n;
+      }
+      else if (p.ring->put(buf[sent]) || !p.lossless)
+        ++sent;
+      else
+        sched_yield();
+      // let the consumer in on a single core too
+      if (!p.lossless && step % 512 == 0)
+        sched_yield();
+    }
+    __atomic_store_n(&p.done, true, __ATOMIC_RELEASE);
+    return 0;
+  }
+};
+
+// seq of the fix, 0 if it is not one of ours or its fields disagree
+static unsigned long fix_sequence(TinyGPS &gps)
+{
+  TinyGPSFix f;
+  gps.get_fix(&f);
+  if (f.time == TinyGPS::GPS_INVALID_TIME)
+    return 0;
+  unsigned long seq = f.altitude / 100;
+  unsigned long s = seq % 86400;
+  unsigned long expected = ((s / 3600) * 10000 + (s / 60 % 60) * 100 + s % 60) * 100;
+  return f.time == expected && f.altitude == (long)seq * 100 ? seq : 0;
+}
+
+template <unsigned N>
+static int run(const char *name, const std::string &log, unsigned sentences, bool lossless)
+{
+  static TinyGPSRing<N> ring;
+  TinyGPS gps;
+  producer<N> p;
+  p.ring = &ring;
+  p.log = &log;
+  p.lossless = lossless;
+  p.done = false;
+
+  pthread_t thread;
+  pthread_create(&thread, 0, producer<N>::run, &p);
+  unsigned long last = 0, drains = 0, out_of_sequence = 0, spliced = 0, valid = 0;
+  for (;;)
+  {
+    bool done = __atomic_load_n(&p.done, __ATOMIC_ACQUIRE);
+    if (!done && ring.available() == 0)
+      sched_yield();
+    unsigned n = ring.drain(gps);
+    ++drains;
+    valid += n;
+    if (n)
+    {
+      unsigned long seq = fix_sequence(gps);
+      if (seq == 0 && !lossless)
+        ++spliced;
+      else if (lossless ? seq != last + n : seq <= last)
+        ++out_of_sequence;
+      if (seq)
+        last = seq;
+    }
+    if (done && ring.available() == 0)
+      break;
+    if (!lossless && drains % 64 == 0)
+      for (volatile int spin = 0; spin < 20000; ++spin)
+        ;
+  }
+  pthread_join(thread, 0);
+  ring.drain(gps);
+
+  unsigned long chars, dropped;
+  unsigned short good, failed;
+  gps.stats(&chars, &good, &failed, &dropped);
+  unsigned long overflows = ring.overflows();
+  bool ok = out_of_sequence == 0 && dropped == overflows;
+  if (lossless)
+    ok = ok && chars == log.size() && good == sentences && valid == sentences && failed == 0 && last == sentences;
+  else
+    ok = ok && chars + overflows == log.size() && spliced <= failed / 16 + 4UL;
+
+  printf("%-8s ring of %4u: %lu of %zu characters received, %lu overflowed, %lu reported dropped\n",
+    name, N, chars, log.size(), overflows, dropped);
+  printf("%-8s %lu drains, %u of %u sentences valid, %u failed checksum, %lu spliced, %lu out of sequence: %s\n",
+    "", drains, good, sentences, failed, spliced, out_of_sequence, ok ? "ok" : "FAILED");
+  return !ok;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned sentences = argc > 1 ? atoi(argv[1]) : 60000;
+  if (sentences > 65535)
+    sentences = 65535; // stats() counts sentences in an unsigned short
+  std::string log = make_log(sentences);
+
+  int errors = run<1024>("lossless", log, sentences, true);
+  errors += run<128>("lossy", log, sentences, false);
+  return errors != 0;
+}
@@ -0,0 +1,174 @@
+/*
+simplify_eval - host evaluation of TinyGPSSimplifier
+
+Simplifies recorded tracks at a range of tolerances and reports how
+many fixes are kept, the largest and mean distance of a dropped fix from
+the simplified track, and the time per fix. Tracks are read from NMEA
+log files, one fix per distinct time stamp; with no files it simulates
+an hour of mixed town and highway driving at 1 Hz.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. simplify_eval.cpp ../../TinyGPS.cpp -o simplify_eval
+
+and run as
+
+  ./simplify_eval [nmea_file ...]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSSimplifier.h"
+#include <stdio.h>
+#include <vector>
+
+struct fix
+{
+  float lat, lon;
+};
+
+static void read_track(const char *path, std::vector<fix> &track)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+  {
+    printf("cannot open %s\n", path);
+    return;
+  }
+
+  TinyGPS gps;
+  char buf[4096];
+  unsigned long last_time = TinyGPS::GPS_INVALID_TIME;
+  size_t n;
+
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (!gps.encode(buf[i]))
+        continue;
+      fix p;
+      unsigned long date, time, age;
+      gps.f_get_position(&p.lat, &p.lon, &age);
+      gps.get_datetime(&date, &time);
+      if (age != TinyGPS::GPS_INVALID_AGE && time != last_time)
+      {
+        track.push_back(p);
+        last_time = time;
+      }
+    }
+  fclose(f);
+}
+
+static unsigned long random_state = 12345;
+
+static double noise()
+{
+  random_state = random_state * 1103515245UL + 12345UL;
+  return ((random_state >> 8) % 2001) / 1000.0 - 1;
+}
+
+// town streets with frequent turns and stops, then a long highway
+static void simulate_track(std::vector<fix> &track)
+{
+  double lat = 12.971599, lon = 77.594566, course = 0.3, speed = 0;
+
+  for (int i = 0; i < 3600; ++i)
+  {
+    bool highway = i >= 1200;
+    double target = highway ? 25 : (i % 180 < 20 ? 0 : 11);
+    speed += (target - speed) * 0.15;
+    if (!highway && i % 60 == 0)
+      course += noise() * 1.6;
+    else if (highway)
+      course += noise() * 0.004 + 0.0008;
+
+    lat += speed * cos(course) / 111320.0;
+    lon += speed * sin(course) / (111320.0 * cos(lat * DEG_TO_RAD));
+
+    fix p;
+    p.lat = (float)(lat + noise() * 1.5 / 111320.0);
+    p.lon = (float)(lon + noise() * 1.5 / 111320.0);
+    track.push_back(p);
+  }
+}
+
+// metres from p to the segment a-b, on a local flat projection
+static double segment_distance(const fix &p, const fix &a, const fix &b)
+{
+  double k = 111320.0 * cos(a.lat * DEG_TO_RAD);
+  double px = ((double)p.lon - a.lon) * k, py = ((double)p.lat - a.lat) * 110574.0;
+  double bx = ((double)b.lon - a.lon) * k, by = ((double)b.lat - a.lat) * 110574.0;
+  double len2 = bx * bx + by * by;
+  double t = len2 > 0 ? (px * bx + py * by) / len2 : 0;
+  if (t < 0) t = 0;
+  if (t > 1) t = 1;
+  return sqrt(sq(px - t * bx) + sq(py - t * by));
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <byte W>
+static void evaluate(const std::vector<fix> &track, float tolerance)
+{
+  std::vector<unsigned long> kept;
+  unsigned long id;
+  const int runs = 20;
+
+  double start = seconds();
+  for (int run = 0; run < runs; ++run)
+  {
+    TinyGPSSimplifier<W> simplifier(tolerance);
+    kept.clear();
+    for (unsigned long i = 0; i < track.size(); ++i)
+      if (simplifier.add(track[i].lat, track[i].lon, i, &id))
+        kept.push_back(id);
+    if (simplifier.flush(&id))
+      kept.push_back(id);
+  }
+  double elapsed = (seconds() - start) / runs;
+
+  double worst = 0, total = 0;
+  unsigned long dropped = 0;
+  for (size_t k = 0; k + 1 < kept.size(); ++k)
+    for (unsigned long i = kept[k] + 1; i < kept[k + 1]; ++i)
+    {
+      double error = segment_distance(track[i], track[kept[k]], track[kept[k + 1]]);
+      if (error > worst) worst = error;
+      total += error;
+      ++dropped;
+    }
+
+  printf("%8.1f %4u %8lu %9.1f:1 %9.2f %9.2f %10.0f\n",
+    tolerance, W, (unsigned long)kept.size(), (double)track.size() / kept.size(),
+    worst, dropped ? total / dropped : 0.0, elapsed * 1e9 / track.size());
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<fix> track;
+  for (int i = 1; i < argc; ++i)
+    read_track(argv[i], track);
+  if (argc == 1)
+    simulate_track(track);
+  if (track.size() < 2)
+  {
+    printf("no track\n");
+    return 1;
+  }
+
+  printf("%lu fixes\n", (unsigned long)track.size());
+  printf("tolerance    W     kept compression  max error mean error    ns/fix\n");
+  static const float tolerances[] = {2, 5, 10, 20, 50};
+  for (size_t i = 0; i < sizeof(tolerances) / sizeof(tolerances[0]); ++i)
+  {
+    evaluate<8>(track, tolerances[i]);
+    evaluate<32>(track, tolerances[i]);
+  }
+  return 0;
+}
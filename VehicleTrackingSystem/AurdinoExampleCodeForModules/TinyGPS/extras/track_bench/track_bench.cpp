@@ -0,0 +1,182 @@
+/*
+track_bench - distances_between() against distance_between() and course_to() per leg
+
+Builds a random-walk track of 1 Hz fixes, 2 to 40 m apart with a
+wandering heading, scattered between 60 degrees south and 60 north, and
+measures every leg three ways: the float and the double overloads of
+distances_between(), and distance_between() plus course_to() called on
+each pair of points as a sketch would. It reports legs per second for
+each, and checks every leg's distance and course and the cumulative
+distance: the float overload against the per-leg calls, which it must
+match, and the double overload against the same formulas evaluated in
+double, which it must match to a millimetre and a millionth of a
+degree. How far the float results are from the double ones is shown
+as well; on legs of a few metres float rounding of the coordinates
+dominates.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. track_bench.cpp ../../TinyGPS.cpp -o track_bench
+
+and run as
+
+  ./track_bench [points]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPS.h"
+#include <stdio.h>
+#include <vector>
+
+static unsigned long random_state = 2463534242UL;
+
+static unsigned long random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state & 0xFFFFFFFFUL;
+}
+
+static double uniform(double lo, double hi)
+{
+  return lo + (hi - lo) * (random_next() % 1000000) / 1000000.0;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// difference of two courses in degrees, across north
+static double course_error(double a, double b)
+{
+  double d = fabs(a - b);
+  return d > 180 ? 360 - d : d;
+}
+
+struct errors
+{
+  double distance, course, cumulative;
+};
+
+// distance_between() and course_to() in double
+static double reference_distance(double lat1, double long1, double lat2, double long2)
+{
+  double dlon = (long1 - long2) * M_PI / 180, a = lat1 * M_PI / 180, b = lat2 * M_PI / 180;
+  double delta = cos(a) * sin(b) - sin(a) * cos(b) * cos(dlon);
+  delta = sqrt(delta * delta + (cos(b) * sin(dlon)) * (cos(b) * sin(dlon)));
+  return atan2(delta, sin(a) * sin(b) + cos(a) * cos(b) * cos(dlon)) * 6372795;
+}
+
+static double reference_course(double lat1, double long1, double lat2, double long2)
+{
+  double dlon = (long2 - long1) * M_PI / 180, a = lat1 * M_PI / 180, b = lat2 * M_PI / 180;
+  double c = atan2(sin(dlon) * cos(b), cos(a) * sin(b) - sin(a) * cos(b) * cos(dlon));
+  return (c < 0 ? c + 2 * M_PI : c) * 180 / M_PI;
+}
+
+template <typename T, typename R>
+static errors compare(const std::vector<T> &distance, const std::vector<T> &course,
+  const std::vector<T> &cumulative, const std::vector<R> &d_ref, const std::vector<R> &c_ref)
+{
+  errors e = { 0, 0, 0 };
+  double total = 0;
+  for (size_t i = 0; i < d_ref.size(); ++i)
+  {
+    double d = fabs(distance[i] - d_ref[i]);
+    if (d > e.distance) e.distance = d;
+    // course is undefined for a leg with no length
+    if (d_ref[i] > 0.01)
+    {
+      double c = course_error(course[i], c_ref[i]);
+      if (c > e.course) e.course = c;
+    }
+    total += d_ref[i];
+    double s = fabs(cumulative[i] - total);
+    if (s > e.cumulative) e.cumulative = s;
+  }
+  return e;
+}
+
+int main(int argc, char **argv)
+{
+  size_t points = argc > 1 ? atol(argv[1]) : 1000000;
+  size_t legs = points - 1;
+
+  std::vector<double> lat(points), lon(points);
+  std::vector<float> flat(points), flon(points);
+  double phi = uniform(-60, 60), lambda = uniform(-180, 180), heading = uniform(0, 2 * M_PI);
+  for (size_t i = 0; i < points; ++i)
+  {
+    if (i % 100000 == 0)
+    {
+      phi = uniform(-60, 60);
+      lambda = uniform(-180, 180);
+    }
+    double step = uniform(2, 40);
+    heading += uniform(-0.3, 0.3);
+    phi += step * cos(heading) / 111195.0;
+    lambda += step * sin(heading) / (111195.0 * cos(phi * M_PI / 180));
+    // rounded to millionths of a degree as TinyGPS gives them
+    lat[i] = floor(phi * 1000000 + 0.5) / 1000000;
+    lon[i] = floor(lambda * 1000000 + 0.5) / 1000000;
+    flat[i] = lat[i];
+    flon[i] = lon[i];
+  }
+
+  std::vector<float> d_ref(legs), c_ref(legs);
+  double start = seconds();
+  for (size_t i = 0; i < legs; ++i)
+  {
+    d_ref[i] = TinyGPS::distance_between(flat[i], flon[i], flat[i + 1], flon[i + 1]);
+    c_ref[i] = TinyGPS::course_to(flat[i], flon[i], flat[i + 1], flon[i + 1]);
+  }
+  double scalar = legs / (seconds() - start);
+
+  std::vector<double> d_exact(legs), c_exact(legs);
+  for (size_t i = 0; i < legs; ++i)
+  {
+    d_exact[i] = reference_distance(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    c_exact[i] = reference_course(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+  }
+
+  std::vector<float> fd(legs), fc(legs), fs(legs);
+  start = seconds();
+  TinyGPS::distances_between(&flat[0], &flon[0], points, &fd[0], &fc[0], &fs[0]);
+  double batch_float = legs / (seconds() - start);
+
+  std::vector<double> dd(legs), dc(legs), ds(legs);
+  start = seconds();
+  TinyGPS::distances_between(&lat[0], &lon[0], points, &dd[0], &dc[0], &ds[0]);
+  double batch_double = legs / (seconds() - start);
+
+  start = seconds();
+  TinyGPS::distances_between(&flat[0], &flon[0], points, &fd[0], (float *)0, (float *)0);
+  double distance_only = legs / (seconds() - start);
+
+  size_t identical = 0;
+  for (size_t i = 0; i < legs; ++i)
+    identical += fd[i] == d_ref[i] && fc[i] == c_ref[i];
+  errors ef = compare(fd, fc, fs, d_ref, c_ref);
+  errors ed = compare(dd, dc, ds, d_exact, c_exact);
+  errors er = compare(d_ref, c_ref, fs, d_exact, c_exact);
+
+  printf("%zu legs\n", legs);
+  printf("                                  M legs/s  max difference: distance     course     cumulative\n");
+  printf("  distance_between + course_to  %8.2f\n", scalar / 1e6);
+  printf("  distances_between, float      %8.2f  from the calls %9.4f m %9.6f deg %9.1f m\n", batch_float / 1e6,
+    ef.distance, ef.course, ef.cumulative);
+  printf("  distances_between, double     %8.2f  from double    %9.4f m %9.6f deg %9.1f m\n", batch_double / 1e6,
+    ed.distance, ed.course, ed.cumulative);
+  printf("  distances_between, distance   %8.2f\n", distance_only / 1e6);
+  printf("%zu of %zu float legs identical to the per-leg calls, which are up to %.2f m and %.2f deg from double\n",
+    identical, legs, er.distance, er.course);
+
+  bool ok = identical == legs && ed.distance < 0.001 && ed.course < 0.000001 && ed.cumulative < 0.01;
+  return !ok;
+}
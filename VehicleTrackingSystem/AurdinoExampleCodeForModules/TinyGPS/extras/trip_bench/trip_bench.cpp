@@ -0,0 +1,207 @@
+/*
+trip_bench - TinyGPSTrip against summing distance_between() per fix
+
+Simulates a fleet reporting at 1 Hz for an hour: each vehicle drives for
+a few minutes at 5 to 30 m/s with a wandering heading, then stops for a
+few minutes with a couple of metres of position noise, and so on. The
+fixes are rounded to millionths of a degree and hundredths of a knot, as
+TinyGPS gives them, and interleaved vehicle by vehicle as a server
+ingest path would see them.
+
+The same moving fixes are summed three ways: TinyGPSTrip; the usual
+float code, distance_between() on f_get_position() style floats; and a
+double precision great circle sum as the reference. It reports the time
+per fix and each odometer's error against the reference, and checks
+that TinyGPSTrip's moving time and trip count come out as simulated.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. trip_bench.cpp ../../TinyGPS.cpp -o trip_bench
+
+and run as
+
+  ./trip_bench [vehicles] [seconds]
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSTrip.h"
+#include <stdio.h>
+#include <vector>
+
+static unsigned long random_state = 2463534242UL;
+
+static unsigned long random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state & 0xFFFFFFFFUL;
+}
+
+static double uniform(double lo, double hi)
+{
+  return lo + (hi - lo) * (random_next() % 1000000) / 1000000.0;
+}
+
+struct sample
+{
+  long lat, lon;
+  unsigned long speed;
+};
+
+struct vehicle
+{
+  double lat, lon, heading, speed;
+  long phase_left;
+  bool driving;
+  unsigned long trips, moving_seconds;
+};
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// one second of one vehicle
+static sample step(vehicle &v)
+{
+  if (--v.phase_left <= 0)
+  {
+    v.driving = !v.driving;
+    v.phase_left = v.driving ? 200 + random_next() % 700 : 150 + random_next() % 250;
+    if (v.driving)
+      ++v.trips;
+  }
+
+  double lat = v.lat, lon = v.lon;
+  if (v.driving)
+  {
+    v.speed += uniform(-1.5, 1.5);
+    if (v.speed < 5) v.speed = 5;
+    if (v.speed > 30) v.speed = 30;
+    v.heading += uniform(-0.1, 0.1);
+    v.lat += v.speed * cos(v.heading) / 111195.0;
+    v.lon += v.speed * sin(v.heading) / (111195.0 * cos(v.lat * M_PI / 180));
+    lat = v.lat;
+    lon = v.lon;
+    ++v.moving_seconds;
+  }
+  else
+  {
+    lat += uniform(-2, 2) / 111195.0;
+    lon += uniform(-2, 2) / 111195.0;
+  }
+
+  sample s;
+  s.lat = lround(lat * 1000000);
+  s.lon = lround(lon * 1000000);
+  s.speed = v.driving ? lround(v.speed * 194.384) : random_next() % 60;
+  return s;
+}
+
+// great circle on the same sphere as distance_between(), in double
+static double reference_distance(long lat1, long lon1, long lat2, long lon2)
+{
+  double a = lat1 * 1e-6 * M_PI / 180, b = lat2 * 1e-6 * M_PI / 180;
+  double dlon = (lon2 - lon1) * 1e-6 * M_PI / 180;
+  double h = sin((b - a) / 2) * sin((b - a) / 2) + cos(a) * cos(b) * sin(dlon / 2) * sin(dlon / 2);
+  return 2 * 6372795.0 * asin(sqrt(h));
+}
+
+int main(int argc, char **argv)
+{
+  unsigned vehicles = argc > 1 ? atoi(argv[1]) : 2000;
+  unsigned duration = argc > 2 ? atoi(argv[2]) : 3600;
+
+  // vehicles start scattered between 30 and 60 degrees north, stopped
+  std::vector<vehicle> fleet(vehicles);
+  for (unsigned i = 0; i < vehicles; ++i)
+  {
+    vehicle &v = fleet[i];
+    v.lat = uniform(30, 60);
+    v.lon = uniform(-10, 30);
+    v.heading = uniform(0, 2 * M_PI);
+    v.speed = 10;
+    v.driving = false;
+    v.phase_left = 1 + random_next() % 300;
+    v.trips = v.moving_seconds = 0;
+  }
+  std::vector<sample> samples((size_t)vehicles * duration);
+  for (unsigned t = 0; t < duration; ++t)
+    for (unsigned i = 0; i < vehicles; ++i)
+      samples[(size_t)t * vehicles + i] = step(fleet[i]);
+
+  const unsigned long start_speed = 300;
+  std::vector<TinyGPSTrip> trips(vehicles, TinyGPSTrip(start_speed, 120000));
+  unsigned long events = 0;
+  double start = seconds();
+  for (unsigned t = 0; t < duration; ++t)
+    for (unsigned i = 0; i < vehicles; ++i)
+    {
+      const sample &s = samples[(size_t)t * vehicles + i];
+      TinyGPSFix fix;
+      fix.latitude = s.lat;
+      fix.longitude = s.lon;
+      fix.speed = s.speed;
+      fix.position_fix = 1000UL * (t + 1);
+      events += trips[i].update(fix) == TinyGPSTrip::TRIP_START;
+    }
+  double trip_ns = (seconds() - start) / samples.size() * 1e9;
+
+  // what every consumer does now: floats from the fix, distance_between on each leg
+  std::vector<float> naive(vehicles, 0);
+  std::vector<float> prev_lat(vehicles), prev_lon(vehicles);
+  start = seconds();
+  for (unsigned t = 0; t < duration; ++t)
+    for (unsigned i = 0; i < vehicles; ++i)
+    {
+      const sample &s = samples[(size_t)t * vehicles + i];
+      float lat = s.lat / 1000000.0, lon = s.lon / 1000000.0;
+      if (t && s.speed >= start_speed)
+        naive[i] += TinyGPS::distance_between(prev_lat[i], prev_lon[i], lat, lon);
+      prev_lat[i] = lat;
+      prev_lon[i] = lon;
+    }
+  double naive_ns = (seconds() - start) / samples.size() * 1e9;
+
+  double trip_err = 0, naive_err = 0, trip_max = 0, naive_max = 0, total = 0;
+  unsigned long time_errors = 0, expected_trips = 0;
+  for (unsigned i = 0; i < vehicles; ++i)
+  {
+    double reference = 0;
+    unsigned long moving = 0;
+    for (unsigned t = 1; t < duration; ++t)
+    {
+      const sample &a = samples[(size_t)(t - 1) * vehicles + i], &b = samples[(size_t)t * vehicles + i];
+      if (b.speed >= start_speed)
+      {
+        reference += reference_distance(a.lat, a.lon, b.lat, b.lon);
+        moving += 1000;
+      }
+    }
+    time_errors += trips[i].moving_time() != moving;
+    expected_trips += fleet[i].trips;
+    if (reference < 1000)
+      continue;
+    double e1 = fabs(trips[i].odometer() - reference) / reference;
+    double e2 = fabs(naive[i] - reference) / reference;
+    trip_err += e1 * reference;
+    naive_err += e2 * reference;
+    total += reference;
+    if (e1 > trip_max) trip_max = e1;
+    if (e2 > naive_max) naive_max = e2;
+  }
+
+  printf("%u vehicles, %u s at 1 Hz, %zu fixes, %.0f km driven\n",
+    vehicles, duration, samples.size(), total / 1000);
+  printf("                     ns/fix  odometer error: mean      max\n");
+  printf("  TinyGPSTrip       %8.1f %21.4f%% %7.4f%%\n", trip_ns, trip_err / total * 100, trip_max * 100);
+  printf("  distance_between  %8.1f %21.4f%% %7.4f%%\n", naive_ns, naive_err / total * 100, naive_max * 100);
+  printf("  %.1f million fixes/s per core with TinyGPSTrip\n", 1000 / trip_ns);
+  printf("%lu trips started of %lu simulated, %lu moving times off\n", events, expected_trips, time_errors);
+  return time_errors != 0;
+}
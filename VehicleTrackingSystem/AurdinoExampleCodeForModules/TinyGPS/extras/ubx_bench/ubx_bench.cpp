@@ -0,0 +1,256 @@
+/*
+ubx_bench - NMEA RMC + GGA against UBX NAV-PVT for the same 10 Hz fixes
+
+Generates an hour of 10 Hz fixes from a receiver moving north-east at
+10 m/s, starting half an hour before midnight on New Year's Eve, and
+encodes each epoch twice: as the RMC and GGA sentences TinyGPS needs for
+a full fix, and as one NAV-PVT frame, which the receiver rounds to the
+whole second with a negative nano half of the time. Both streams are fed
+one character at a time, to TinyGPS and to TinyGPSUBX. It reports bytes
+and CPU time per fix, the share of a 9600 baud link each needs at 10 Hz,
+and checks that every fix decodes to the same values within one unit.
+Then it checks that a header with a length no frame it keeps can have
+is counted as failed and does not swallow the frames after it.
+
+Build from this directory with
+
+  g++ -O2 -I../host -I../.. ubx_bench.cpp ../../TinyGPS.cpp ../../TinyGPSUBX.cpp -o ubx_bench
+
+This file is part of TinyGPS and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TinyGPS.h).
+*/
+
+#include "TinyGPSUBX.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define EPOCHS 36000
+#define START_SECOND (23 * 3600L + 30 * 60)
+
+struct epoch
+{
+  long tenths;        // since midnight on 31 December 2023, may pass 24 h
+  long minutes;       // latitude in 1e-4 minutes; longitude follows it
+  long lon_minutes;
+  long altitude_dm;
+  unsigned knots_tenths;
+  unsigned course_tenths;
+};
+
+static epoch make_epoch(long i)
+{
+  epoch e;
+  e.tenths = START_SECOND * 10 + i;
+  e.minutes = 48 * 600000L + 70380 + i * 54 / 10;
+  e.lon_minutes = 11 * 600000L + 310000 + i * 73 / 10;
+  e.altitude_dm = 5454 + i % 170;
+  e.knots_tenths = 194;
+  e.course_tenths = 450;
+  return e;
+}
+
+static void sentence(std::string &out, const char *body)
+{
+  byte parity = 0;
+  for (const char *p = body; *p; ++p)
+    parity ^= *p;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+  out += '$';
+  out += body;
+  out += tail;
+}
+
+// day 0 is 31/12/23, day 1 is 01/01/24
+static void civil(long day, int *year, int *month, int *dom)
+{
+  *year = day ? 2024 : 2023;
+  *month = day ? 1 : 12;
+  *dom = day ? 1 : 31;
+}
+
+static void nmea(std::string &out, const epoch &e)
+{
+  char body[96];
+  long s = e.tenths / 10;
+  int year, month, day;
+  civil(s / 86400, &year, &month, &day);
+  long t = s % 86400;
+  char hms[16];
+  snprintf(hms, sizeof(hms), "%02ld%02ld%02ld.%02ld", t / 3600, t / 60 % 60, t % 60, e.tenths % 10 * 10);
+  char lat[16], lon[16];
+  snprintf(lat, sizeof(lat), "%02ld%02ld.%04ld", e.minutes / 600000, e.minutes / 10000 % 60, e.minutes % 10000);
+  snprintf(lon, sizeof(lon), "%03ld%02ld.%04ld", e.lon_minutes / 600000, e.lon_minutes / 10000 % 60, e.lon_minutes % 10000);
+
+  snprintf(body, sizeof(body), "GPRMC,%s,A,%s,N,%s,E,%03u.%u,%03u.%u,%02d%02d%02d,003.1,W",
+    hms, lat, lon, e.knots_tenths / 10, e.knots_tenths % 10,
+    e.course_tenths / 10, e.course_tenths % 10, day, month, year % 100);
+  sentence(out, body);
+  snprintf(body, sizeof(body), "GPGGA,%s,%s,N,%s,E,1,08,0.9,%ld.%ld,M,46.9,M,,",
+    hms, lat, lon, e.altitude_dm / 10, e.altitude_dm % 10);
+  sentence(out, body);
+}
+
+static void put(std::vector<byte> &p, size_t offset, unsigned long v, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    p[offset + i] = (byte)(v >> (8 * i));
+}
+
+static void ubx(std::string &out, const epoch &e)
+{
+  std::vector<byte> p(92, 0);
+  // the receiver rounds to the nearest second
+  long s = (e.tenths + 5) / 10;
+  long nano = (e.tenths - s * 10) * 100000000L;
+  int year, month, day;
+  civil(s / 86400, &year, &month, &day);
+  long t = s % 86400;
+
+  put(p, 4, year, 2);
+  p[6] = month;
+  p[7] = day;
+  p[8] = t / 3600;
+  p[9] = t / 60 % 60;
+  p[10] = t % 60;
+  p[11] = 0x07;
+  put(p, 16, (unsigned long)nano, 4);
+  p[20] = 3;
+  p[21] = 0x01;
+  p[23] = 8;
+  // 1e-4 minutes to 1e-7 degrees
+  put(p, 24, (unsigned long)((e.lon_minutes * 50 + 1) / 3), 4);
+  put(p, 28, (unsigned long)((e.minutes * 50 + 1) / 3), 4);
+  put(p, 36, (unsigned long)(e.altitude_dm * 100), 4);
+  put(p, 60, (unsigned long)(e.knots_tenths * 51444.444 / 1000 + 0.5), 4);
+  put(p, 64, (unsigned long)e.course_tenths * 10000, 4);
+  put(p, 76, 250, 2);
+
+  std::string frame;
+  frame += (char)0xB5;
+  frame += (char)0x62;
+  frame += (char)0x01;
+  frame += (char)0x07;
+  frame += (char)92;
+  frame += (char)0;
+  frame.append((const char *)&p[0], p.size());
+  byte a = 0, b = 0;
+  for (size_t i = 2; i < frame.size(); ++i)
+  {
+    a += (byte)frame[i];
+    b += a;
+  }
+  frame += (char)a;
+  frame += (char)b;
+  out += frame;
+}
+
+struct fix
+{
+  unsigned long date, time;
+  long lat, lon, altitude;
+  unsigned long speed, course;
+};
+
+static fix take(TinyGPS &gps)
+{
+  fix f;
+  gps.get_position(&f.lat, &f.lon);
+  gps.get_datetime(&f.date, &f.time);
+  f.altitude = gps.altitude();
+  f.speed = gps.speed();
+  f.course = gps.course();
+  return f;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// feeds each epoch's bytes in turn, keeping the fix after the epoch
+template <class Decoder>
+static double run(Decoder &decoder, const std::string &data, const std::vector<size_t> &ends,
+  TinyGPS &gps, std::vector<fix> *fixes)
+{
+  double start = seconds();
+  size_t i = 0;
+  for (size_t e = 0; e < ends.size(); ++e)
+  {
+    for (; i < ends[e]; ++i)
+      decoder.encode(data[i]);
+    if (fixes)
+      (*fixes)[e] = take(gps);
+  }
+  return seconds() - start;
+}
+
+static bool close_to(long a, long b)
+{
+  return a - b <= 1 && b - a <= 1;
+}
+
+int main()
+{
+  std::string nmea_data, ubx_data;
+  std::vector<size_t> nmea_ends, ubx_ends;
+  for (long i = 0; i < EPOCHS; ++i)
+  {
+    epoch e = make_epoch(i);
+    nmea(nmea_data, e);
+    nmea_ends.push_back(nmea_data.size());
+    ubx(ubx_data, e);
+    ubx_ends.push_back(ubx_data.size());
+  }
+
+  std::vector<fix> nmea_fixes(EPOCHS), ubx_fixes(EPOCHS);
+  double nmea_best = 1e9, ubx_best = 1e9;
+  for (int r = 0; r < 10; ++r)
+  {
+    TinyGPS a, b;
+    TinyGPSUBX decoder(b);
+    double t = run(a, nmea_data, nmea_ends, a, r ? 0 : &nmea_fixes);
+    if (t < nmea_best) nmea_best = t;
+    t = run(decoder, ubx_data, ubx_ends, b, r ? 0 : &ubx_fixes);
+    if (t < ubx_best) ubx_best = t;
+  }
+
+  unsigned long mismatches = 0;
+  for (size_t e = 0; e < EPOCHS; ++e)
+  {
+    const fix &n = nmea_fixes[e], &u = ubx_fixes[e];
+    if (n.date != u.date || !close_to(n.time, u.time) || !close_to(n.lat, u.lat) ||
+      !close_to(n.lon, u.lon) || !close_to(n.altitude, u.altitude) ||
+      !close_to(n.speed, u.speed) || !close_to(n.course, u.course))
+    {
+      if (++mismatches <= 5)
+        printf("epoch %zu: nmea %06lu %08lu %ld %ld %ld %lu %lu, ubx %06lu %08lu %ld %ld %ld %lu %lu\n",
+          e, n.date, n.time, n.lat, n.lon, n.altitude, n.speed, n.course,
+          u.date, u.time, u.lat, u.lon, u.altitude, u.speed, u.course);
+    }
+  }
+
+  double nmea_bytes = (double)nmea_data.size() / EPOCHS, ubx_bytes = (double)ubx_data.size() / EPOCHS;
+  printf("%d fixes at 10 Hz; a 9600 baud link carries 960 bytes/s\n", EPOCHS);
+  printf("              bytes/fix   link at 10 Hz   ns/fix\n");
+  printf("  RMC + GGA   %9.1f %14.0f%% %8.1f\n", nmea_bytes, nmea_bytes * 10 / 960 * 100, nmea_best / EPOCHS * 1e9);
+  printf("  NAV-PVT     %9.1f %14.0f%% %8.1f\n", ubx_bytes, ubx_bytes * 10 / 960 * 100, ubx_best / EPOCHS * 1e9);
+  printf("%lu fixes differ by more than one unit\n", mismatches);
+
+  // a stray sync pair with a 65535 byte length, then three frames
+  std::string bad("\xB5\x62\x01\x07\xFF\xFF", 6);
+  for (long i = 0; i < 3; ++i)
+    ubx(bad, make_epoch(i));
+  TinyGPS gps;
+  TinyGPSUBX decoder(gps);
+  unsigned decoded = decoder.encode(bad.data(), bad.size());
+  unsigned short frames, failed;
+  decoder.stats(&frames, &failed);
+  bool resynced = decoded == 3 && frames == 3 && failed == 1;
+  printf("oversized length: %u frames decoded after it, %u counted failed (%s)\n", decoded, failed,
+    resynced ? "ok" : "wrong");
+  return mismatches != 0 || !resynced;
+}
@@ -0,0 +1,209 @@
+/*
+LogStore - wear-levelled, crash-safe record log for EEPROM sized storage
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "LogStore.h"
+
+#if defined(__AVR__)
+#include <util/crc16.h>
+#endif
+
+#define _LOG_MARKER 0x80
+#define _LOG_LENGTH_MASK 0x7F
+#define _LOG_MIN_RECORD_SIZE (_LOG_RECORD_OVERHEAD + 1)
+#define _LOG_MAX_RECORD_SIZE (_LOG_RECORD_OVERHEAD + _LOG_LENGTH_MASK)
+
+// CRC-CCITT (0x8408), as _crc_ccitt_update() in avr-libc
+static unsigned short crc_update(unsigned short crc, byte data)
+{
+#if defined(__AVR__)
+  return _crc_ccitt_update(crc, data);
+#else
+  data ^= (byte)crc;
+  data ^= data << 4;
+  return ((((unsigned short)data << 8) | (crc >> 8)) ^ (byte)(data >> 4) ^ ((unsigned short)data << 3));
+#endif
+}
+
+LogStore::LogStore(TrackStorage &storage, byte record_size, unsigned long first, unsigned long length)
+  :  _storage(storage)
+  ,  _record_size(record_size)
+  ,  _first(first)
+  ,  _slots(0)
+  ,  _head(0)
+  ,  _head_slot(0)
+  ,  _tail(0)
+  ,  _count(0)
+{
+  if (_record_size < _LOG_MIN_RECORD_SIZE) _record_size = _LOG_MIN_RECORD_SIZE;
+  if (_record_size > _LOG_MAX_RECORD_SIZE) _record_size = _LOG_MAX_RECORD_SIZE;
+
+  unsigned long size = _storage.size();
+  if (first >= size)
+    return;
+  if (length == 0 || length > size - first)
+    length = size - first;
+
+  // sequence numbers are compared modulo 2^16
+  unsigned long slots = length / _record_size;
+  _slots = slots < 0x7FFF ? (unsigned short)slots : 0x7FFF;
+}
+
+void LogStore::begin()
+{
+  unsigned short seq, tail, newest = 0, newest_tail = 0, newest_slot = 0;
+  byte type;
+  bool found = false;
+
+  for (unsigned short slot = 0; slot < _slots; ++slot)
+  {
+    if (!read_record(_first + (unsigned long)slot * _record_size, &seq, &tail, &type, 0))
+      continue;
+    if (!found || (short)(seq - newest) > 0)
+    {
+      newest = seq;
+      newest_tail = tail;
+      newest_slot = slot;
+      found = true;
+    }
+  }
+
+  _count = 0;
+  if (!found)
+  {
+    _head = _tail = _head_slot = 0;
+    return;
+  }
+
+  _head = newest + 1;
+  _head_slot = newest_slot + 1 == _slots ? 0 : newest_slot + 1;
+  _tail = newest_tail;
+  if ((unsigned short)(_head - _tail) > _slots)
+    _tail = _head - _slots;
+
+  for (unsigned short s = _tail; s != _head; ++s)
+    if (read_record(slot_address(s), &seq, &tail, &type, 0) && seq == s && !(type & _LOG_MARKER))
+      ++_count;
+}
+
+bool LogStore::append(const void *payload, byte len)
+{
+  // the last free slot is kept for the marker of the next trim
+  if (len > payload_size() || (unsigned short)(_head - _tail) + 1 >= _slots)
+    return false;
+
+  write_record(_tail, len, (const byte *)payload, len);
+  ++_count;
+  return true;
+}
+
+bool LogStore::next(Cursor &cursor, void *payload, byte *len)
+{
+  unsigned short seq, tail;
+  byte type;
+
+  // trimmed from under the cursor
+  if ((unsigned short)(_head - cursor.seq) > (unsigned short)(_head - _tail))
+    cursor.seq = _tail;
+
+  while (cursor.seq != _head)
+  {
+    unsigned short expected = cursor.seq++;
+    if (read_record(slot_address(expected), &seq, &tail, &type, (byte *)payload)
+      && seq == expected && !(type & _LOG_MARKER))
+    {
+      if (len) *len = type & _LOG_LENGTH_MASK;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LogStore::trim(unsigned long records)
+{
+  unsigned short seq, tail, s = _tail;
+  byte type;
+
+  for (; s != _head && records; ++s)
+    if (read_record(slot_address(s), &seq, &tail, &type, 0) && seq == s && !(type & _LOG_MARKER))
+    {
+      --records;
+      --_count;
+    }
+
+  if (s == _tail)
+    return;
+
+  // with nothing left, the marker itself is not part of the log
+  if (s == _head)
+    s = _head + 1;
+  write_record(s, _LOG_MARKER, 0, 0);
+  _tail = s;
+}
+
+//
+// internal utilities
+//
+
+unsigned long LogStore::slot_address(unsigned short seq)
+{
+  unsigned short back = _head - seq;
+  unsigned short slot = _head_slot >= back ? _head_slot - back : _head_slot + _slots - back;
+  return _first + (unsigned long)slot * _record_size;
+}
+
+bool LogStore::read_record(unsigned long address, unsigned short *seq, unsigned short *tail, byte *type, byte *payload)
+{
+  unsigned short crc = 0xFFFF;
+  byte header[5];
+
+  for (byte i = 0; i < 5; ++i)
+    crc = crc_update(crc, header[i] = _storage.read(address + i));
+
+  byte len = header[4] & _LOG_LENGTH_MASK;
+  if (len > payload_size())
+    return false;
+
+  for (byte i = 0; i < len; ++i)
+  {
+    byte b = _storage.read(address + 5 + i);
+    if (payload) payload[i] = b;
+    crc = crc_update(crc, b);
+  }
+
+  if ((_storage.read(address + 5 + len) | (_storage.read(address + 6 + len) << 8)) != crc)
+    return false;
+
+  *seq = header[0] | (header[1] << 8);
+  *tail = header[2] | (header[3] << 8);
+  *type = header[4];
+  return true;
+}
+
+void LogStore::write_record(unsigned short tail, byte type, const byte *payload, byte len)
+{
+  unsigned long address = _first + (unsigned long)_head_slot * _record_size;
+  byte header[5] = {(byte)_head, (byte)(_head >> 8), (byte)tail, (byte)(tail >> 8), type};
+  unsigned short crc = 0xFFFF;
+
+  for (byte i = 0; i < 5; ++i)
+  {
+    _storage.write(address + i, header[i]);
+    crc = crc_update(crc, header[i]);
+  }
+  for (byte i = 0; i < len; ++i)
+  {
+    _storage.write(address + 5 + i, payload[i]);
+    crc = crc_update(crc, payload[i]);
+  }
+  _storage.write(address + 5 + len, (byte)crc);
+  _storage.write(address + 6 + len, (byte)(crc >> 8));
+
+  ++_head;
+  _head_slot = _head_slot + 1 == _slots ? 0 : _head_slot + 1;
+}
@@ -0,0 +1,80 @@
+/*
+LogStore - wear-levelled, crash-safe record log for EEPROM sized storage
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef LogStore_h
+#define LogStore_h
+
+#include "TrackStorage.h"
+
+#define _LOG_DEFAULT_RECORD_SIZE 24
+#define _LOG_RECORD_OVERHEAD 7
+
+// The storage is divided into fixed-size slots that are written in turn,
+// round and round, so every cell wears at the same rate. A slot holds
+//
+//   seq (2) | tail (2) | type and length (1) | payload | crc16 (2)
+//
+// where seq numbers the records as they are written and tail is the seq
+// of the oldest record not yet trimmed. At boot the newest record that
+// passes its CRC gives both ends of the log, so a record cut short by a
+// reset is simply not there and nothing else needs to be kept in sync.
+// Trimming writes one small marker record carrying the new tail.
+class LogStore
+{
+public:
+  // iteration state
+  struct Cursor
+  {
+    unsigned short seq;
+  };
+
+  // uses bytes [first, first + length) of storage, all of it if length is 0
+  LogStore(TrackStorage &storage, byte record_size = _LOG_DEFAULT_RECORD_SIZE,
+    unsigned long first = 0, unsigned long length = 0);
+
+  // scan the storage for the ends of the log; call once before use
+  void begin();
+
+  // largest payload a record can hold
+  byte payload_size() { return _record_size - _LOG_RECORD_OVERHEAD; }
+
+  // false if the log is full or the payload too long
+  bool append(const void *payload, byte len);
+
+  // records in the log, and how many it can hold
+  unsigned long count() { return _count; }
+  unsigned long capacity() { return _slots > 1 ? _slots - 1 : 0; }
+
+  // position a cursor on the oldest record
+  void seek(Cursor &cursor) { cursor.seq = _tail; }
+
+  // read the record under the cursor into payload (payload_size() bytes)
+  // and advance, false at the end of the log
+  bool next(Cursor &cursor, void *payload, byte *len);
+
+  // drop the oldest records, e.g. once they are uploaded
+  void trim(unsigned long records);
+
+private:
+  TrackStorage &_storage;
+  byte _record_size;
+  unsigned long _first;
+  unsigned short _slots;
+
+  unsigned short _head;       // seq of the next record
+  unsigned short _head_slot;  // where it goes
+  unsigned short _tail;       // seq of the oldest record
+  unsigned long _count;
+
+  unsigned long slot_address(unsigned short seq);
+  bool read_record(unsigned long address, unsigned short *seq, unsigned short *tail, byte *type, byte *payload);
+  void write_record(unsigned short tail, byte type, const byte *payload, byte len);
+};
+
+#endif
@@ -0,0 +1,291 @@
+/*
+TrackLog - delta-compressed track recorder for EEPROM sized storage
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TrackLog.h"
+
+// Frame layout
+//
+//   0xFF                 end of log (erased)
+//   0xFE lat lon speed timestamp
+//                        keyframe; zig-zag lat/lon, plain speed/timestamp
+//   HH SSSSSS [dt] [speed] lat lon
+//                        HH = seconds since the previous fix - 1, or 3 if
+//                        a varint dt follows; SSSSSS = zig-zag speed change
+//                        if below 61, or 61 if a varint follows; lat/lon
+//                        are the zig-zag change in per-fix movement
+#define _TRACK_DT_ESCAPE 3
+#define _TRACK_SPEED_ESCAPE 61
+
+static unsigned long zigzag(long n)
+{
+  return ((unsigned long)n << 1) ^ (0UL - (n < 0));
+}
+
+static long unzigzag(unsigned long n)
+{
+  return (long)((n >> 1) ^ (0UL - (n & 1)));
+}
+
+static byte put_varint(byte *p, unsigned long n)
+{
+  byte len = 0;
+  while (n >= 0x80)
+  {
+    p[len++] = (byte)n | 0x80;
+    n >>= 7;
+  }
+  p[len++] = (byte)n;
+  return len;
+}
+
+TrackLog::TrackLog(TrackStorage &storage, byte keyframe_interval)
+  :  _storage(storage)
+  ,  _keyframe_interval(keyframe_interval ? keyframe_interval : 1)
+  ,  _since_keyframe(0)
+  ,  _fixes(0)
+  ,  _keyframes(0)
+{
+  rewind(_end);
+}
+
+void TrackLog::begin()
+{
+  Cursor cursor;
+  bool keyframe;
+
+  rewind(cursor);
+  _fixes = _keyframes = 0;
+  _since_keyframe = 0;
+
+  while (decode_frame(cursor, &keyframe))
+  {
+    ++_fixes;
+    if (keyframe)
+    {
+      ++_keyframes;
+      _since_keyframe = 0;
+    }
+    else if (_since_keyframe < 0xFF)
+    {
+      ++_since_keyframe;
+    }
+  }
+  _end = cursor;
+}
+
+bool TrackLog::append(const TrackFix &fix)
+{
+  byte frame[_TRACK_MAX_FRAME];
+  byte len = encode_frame(fix, frame);
+  unsigned long address = _end.address;
+
+  if (address + len > _storage.size())
+    return false;
+
+  // body, then the new end marker, then the header that makes it visible
+  for (byte i = 1; i < len; ++i)
+    _storage.write(address + i, frame[i]);
+  if (address + len < _storage.size())
+    _storage.write(address + len, _TRACK_END);
+  _storage.write(address, frame[0]);
+
+  ++_fixes;
+  if (frame[0] == _TRACK_KEYFRAME)
+  {
+    ++_keyframes;
+    _since_keyframe = 0;
+    _end.dlat = _end.dlon = 0;
+  }
+  else
+  {
+    ++_since_keyframe;
+    _end.dlat = fix.latitude - _end.fix.latitude;
+    _end.dlon = fix.longitude - _end.fix.longitude;
+  }
+  _end.fix = fix;
+  _end.address = address + len;
+  return true;
+}
+
+bool TrackLog::seek(Cursor &cursor, unsigned long keyframe)
+{
+  bool is_keyframe;
+
+  rewind(cursor);
+  for (;;)
+  {
+    unsigned long address = cursor.address;
+    if (!decode_frame(cursor, &is_keyframe))
+      return false;
+    if (is_keyframe && keyframe-- == 0)
+    {
+      cursor.address = address;
+      return true;
+    }
+  }
+}
+
+bool TrackLog::next(Cursor &cursor, TrackFix *fix)
+{
+  bool keyframe;
+  if (!decode_frame(cursor, &keyframe))
+    return false;
+  if (fix) *fix = cursor.fix;
+  return true;
+}
+
+void TrackLog::truncate(unsigned long keyframe)
+{
+  Cursor cursor;
+  if (!seek(cursor, keyframe))
+    return;
+  _storage.write(cursor.address, _TRACK_END);
+  begin();
+}
+
+unsigned long TrackLog::timestamp(unsigned long date, unsigned long time)
+{
+  int year = date % 100;
+  unsigned month = (date / 100) % 100;
+  unsigned day = date / 10000;
+  year += year > 80 ? 1900 : 2000;
+
+  // days since 1970-01-01 in the proleptic Gregorian calendar
+  if (month <= 2) --year;
+  long era = year / 400;
+  unsigned yoe = (unsigned)(year - era * 400);
+  unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned long doe = yoe * 365UL + yoe / 4 - yoe / 100 + doy;
+  long days = era * 146097L + (long)doe - 719468L;
+
+  time /= 100;
+  return days * 86400UL + (time / 10000) * 3600UL + ((time / 100) % 100) * 60 + time % 100;
+}
+
+//
+// internal utilities
+//
+
+void TrackLog::rewind(Cursor &cursor)
+{
+  cursor.address = 0;
+  cursor.fix.latitude = cursor.fix.longitude = 0;
+  cursor.fix.speed = cursor.fix.timestamp = 0;
+  cursor.dlat = cursor.dlon = 0;
+}
+
+byte TrackLog::encode_frame(const TrackFix &fix, byte *frame)
+{
+  byte len = 1;
+
+  if (_fixes == 0 || _since_keyframe + 1 >= _keyframe_interval || fix.timestamp < _end.fix.timestamp)
+  {
+    frame[0] = _TRACK_KEYFRAME;
+    len += put_varint(frame + len, zigzag(fix.latitude));
+    len += put_varint(frame + len, zigzag(fix.longitude));
+    len += put_varint(frame + len, fix.speed);
+    len += put_varint(frame + len, fix.timestamp);
+    return len;
+  }
+
+  unsigned long dt = fix.timestamp - _end.fix.timestamp;
+  unsigned long dspeed = zigzag((long)(fix.speed - _end.fix.speed));
+  byte header;
+
+  if (dt >= 1 && dt <= _TRACK_DT_ESCAPE)
+    header = (byte)(dt - 1) << 6;
+  else
+  {
+    header = _TRACK_DT_ESCAPE << 6;
+    len += put_varint(frame + len, dt);
+  }
+
+  if (dspeed < _TRACK_SPEED_ESCAPE)
+    header |= (byte)dspeed;
+  else
+  {
+    header |= _TRACK_SPEED_ESCAPE;
+    len += put_varint(frame + len, dspeed);
+  }
+
+  frame[0] = header;
+  len += put_varint(frame + len, zigzag(fix.latitude - _end.fix.latitude - _end.dlat));
+  len += put_varint(frame + len, zigzag(fix.longitude - _end.fix.longitude - _end.dlon));
+  return len;
+}
+
+bool TrackLog::decode_frame(Cursor &cursor, bool *keyframe)
+{
+  unsigned long size = _storage.size();
+  unsigned long address = cursor.address;
+
+  if (address >= size)
+    return false;
+  byte header = _storage.read(address++);
+  if (header == _TRACK_END)
+    return false;
+
+  TrackFix fix = cursor.fix;
+  long dlat, dlon;
+
+  *keyframe = header == _TRACK_KEYFRAME;
+  if (*keyframe)
+  {
+    fix.latitude = unzigzag(read_varint(address));
+    fix.longitude = unzigzag(read_varint(address));
+    fix.speed = read_varint(address);
+    fix.timestamp = read_varint(address);
+    dlat = dlon = 0;
+  }
+  else
+  {
+    byte dt = header >> 6;
+    byte dspeed = header & 0x3F;
+    if (dspeed > _TRACK_SPEED_ESCAPE)
+      return false;
+
+    fix.timestamp += dt == _TRACK_DT_ESCAPE ? read_varint(address) : dt + 1UL;
+    fix.speed += dspeed == _TRACK_SPEED_ESCAPE ? unzigzag(read_varint(address)) : unzigzag(dspeed);
+    dlat = cursor.dlat + unzigzag(read_varint(address));
+    dlon = cursor.dlon + unzigzag(read_varint(address));
+    fix.latitude += dlat;
+    fix.longitude += dlon;
+  }
+
+  // a frame running off the end of storage was never completed
+  if (address > size)
+    return false;
+
+  cursor.address = address;
+  cursor.fix = fix;
+  cursor.dlat = dlat;
+  cursor.dlon = dlon;
+  return true;
+}
+
+unsigned long TrackLog::read_varint(unsigned long &address)
+{
+  unsigned long size = _storage.size();
+  unsigned long n = 0;
+
+  for (byte shift = 0; shift < 35; shift += 7)
+  {
+    // past the end: make the caller see an incomplete frame
+    if (address >= size)
+    {
+      address = size + 1;
+      return 0;
+    }
+    byte b = _storage.read(address++);
+    n |= (unsigned long)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      break;
+  }
+  return n;
+}
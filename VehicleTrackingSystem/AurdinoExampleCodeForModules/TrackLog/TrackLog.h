@@ -0,0 +1,85 @@
+/*
+TrackLog - delta-compressed track recorder for EEPROM sized storage
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef TrackLog_h
+#define TrackLog_h
+
+#include "TrackStorage.h"
+
+#define _TRACK_DEFAULT_KEYFRAME_INTERVAL 32
+#define _TRACK_MAX_FRAME 21  // longest frame in bytes
+
+// one logged fix, in the units TinyGPS reports them
+struct TrackFix
+{
+  long latitude, longitude;     // millionths of a degree
+  unsigned long speed;          // 100ths of a knot
+  unsigned long timestamp;      // seconds since 1970-01-01 00:00:00 UTC
+};
+
+// The log is a run of frames from address 0, ended by an erased (0xFF)
+// byte or by the end of storage. A keyframe stores a fix in full; the
+// fixes after it store the change in time and speed and the change in
+// per-fix movement of latitude and longitude, as zig-zag varints. At 1 Hz
+// a vehicle moves about the same distance every second, so most frames
+// are 3-4 bytes. A frame's first byte is written last, so a frame cut
+// short by a reset is never seen.
+class TrackLog
+{
+public:
+  // iteration state; any number of cursors may walk the log at once
+  struct Cursor
+  {
+    unsigned long address;
+    TrackFix fix;
+    long dlat, dlon;
+  };
+
+  TrackLog(TrackStorage &storage, byte keyframe_interval = _TRACK_DEFAULT_KEYFRAME_INTERVAL);
+
+  // scan the storage for the end of the log; call once before use
+  void begin();
+
+  // false if the storage is full
+  bool append(const TrackFix &fix);
+
+  // fixes and keyframes in the log, bytes it uses
+  unsigned long fixes() { return _fixes; }
+  unsigned long keyframes() { return _keyframes; }
+  unsigned long bytes_used() { return _end.address; }
+
+  // position a cursor on a keyframe, false if there is no such keyframe
+  bool seek(Cursor &cursor, unsigned long keyframe = 0);
+
+  // read the fix under the cursor and advance, false at the end of the log
+  bool next(Cursor &cursor, TrackFix *fix);
+
+  // drop a keyframe and everything logged after it
+  void truncate(unsigned long keyframe = 0);
+
+  // seconds since 1970 from TinyGPS ddmmyy date and hhmmsscc time
+  static unsigned long timestamp(unsigned long date, unsigned long time);
+
+private:
+  enum {_TRACK_KEYFRAME = 0xFE, _TRACK_END = 0xFF};
+
+  TrackStorage &_storage;
+  byte _keyframe_interval;
+  byte _since_keyframe;
+  unsigned long _fixes;
+  unsigned long _keyframes;
+  Cursor _end;
+
+  static void rewind(Cursor &cursor);
+  byte encode_frame(const TrackFix &fix, byte *frame);
+  bool decode_frame(Cursor &cursor, bool *keyframe);
+  unsigned long read_varint(unsigned long &address);
+};
+
+#endif
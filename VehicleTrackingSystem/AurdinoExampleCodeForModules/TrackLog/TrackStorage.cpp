@@ -0,0 +1,161 @@
+/*
+TrackStorage - byte-addressed non-volatile storage used by TrackLog
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TrackStorage.h"
+
+#if defined(ARDUINO)
+
+#include <EEPROM.h>
+
+unsigned long EEPROMTrackStorage::size()
+{
+  return E2END + 1UL;
+}
+
+byte EEPROMTrackStorage::read(unsigned long address)
+{
+  return EEPROM.read((int)address);
+}
+
+void EEPROMTrackStorage::write(unsigned long address, byte value)
+{
+  // an EEPROM cell survives about 100,000 erase/write cycles: don't waste them
+  if (EEPROM.read((int)address) != value)
+    EEPROM.write((int)address, value);
+}
+
+#else
+
+#include <stdlib.h>
+#include <string.h>
+
+FileTrackStorage::FileTrackStorage(const char *path, unsigned long size)
+  :  _file(fopen(path, "r+b"))
+  ,  _image((byte *)malloc(size))
+  ,  _size(size)
+{
+  if (!_image)
+  {
+    if (_file) fclose(_file);
+    _file = 0;
+    return;
+  }
+
+  memset(_image, 0xFF, _size);
+  if (_file)
+  {
+    size_t n = fread(_image, 1, _size, _file);
+    (void)n;
+  }
+  else
+  {
+    _file = fopen(path, "w+b");
+  }
+
+  if (_file)
+  {
+    fseek(_file, 0, SEEK_SET);
+    fwrite(_image, 1, _size, _file);
+    fflush(_file);
+  }
+}
+
+FileTrackStorage::~FileTrackStorage()
+{
+  if (_file) fclose(_file);
+  free(_image);
+}
+
+byte FileTrackStorage::read(unsigned long address)
+{
+  return address < _size ? _image[address] : 0xFF;
+}
+
+void FileTrackStorage::write(unsigned long address, byte value)
+{
+  if (address >= _size || _image[address] == value)
+    return;
+  _image[address] = value;
+  if (_file)
+  {
+    fseek(_file, (long)address, SEEK_SET);
+    fputc(value, _file);
+    fflush(_file);
+  }
+}
+
+SimulatedTrackStorage::SimulatedTrackStorage(unsigned long size)
+  :  _image((byte *)malloc(size))
+  ,  _wear((unsigned long *)calloc(size, sizeof(unsigned long)))
+  ,  _size(_image && _wear ? size : 0)
+  ,  _reads(0)
+  ,  _writes(0)
+  ,  _power_budget(~0UL)
+  ,  _noise(1)
+  ,  _powered(true)
+{
+  if (_image)
+    memset(_image, 0xFF, _size);
+}
+
+SimulatedTrackStorage::~SimulatedTrackStorage()
+{
+  free(_image);
+  free(_wear);
+}
+
+byte SimulatedTrackStorage::read(unsigned long address)
+{
+  ++_reads;
+  return address < _size ? _image[address] : 0xFF;
+}
+
+void SimulatedTrackStorage::write(unsigned long address, byte value)
+{
+  if (!_powered || address >= _size || _image[address] == value)
+    return;
+
+  if (_power_budget == 0)
+  {
+    // the cell was erased, then only some of its bits got programmed
+    _noise = _noise * 1103515245UL + 12345UL;
+    _image[address] = value | (byte)(_noise >> 16);
+    _powered = false;
+  }
+  else
+  {
+    --_power_budget;
+    _image[address] = value;
+  }
+  ++_wear[address];
+  ++_writes;
+}
+
+void SimulatedTrackStorage::cut_power_after(unsigned long writes)
+{
+  _power_budget = writes;
+  _powered = true;
+}
+
+unsigned long SimulatedTrackStorage::max_cell_writes()
+{
+  unsigned long most = 0;
+  for (unsigned long i = 0; i < _size; ++i)
+    if (_wear[i] > most)
+      most = _wear[i];
+  return most;
+}
+
+void SimulatedTrackStorage::reset_counters()
+{
+  _reads = _writes = 0;
+  memset(_wear, 0, _size * sizeof(unsigned long));
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+TrackStorage - byte-addressed non-volatile storage used by TrackLog
+
+EEPROMTrackStorage uses the on-chip EEPROM of the Arduino.
+FileTrackStorage is a stand-in for host builds that keeps the
+"EEPROM" contents in a file, so logs survive between runs.
+SimulatedTrackStorage keeps them in memory, counts reads and cell
+writes, and can lose power part way through a write.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef TrackStorage_h
+#define TrackStorage_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#elif defined(ARDUINO)
+#include "WProgram.h"
+#else
+#include <stddef.h>
+#include <stdio.h>
+typedef unsigned char byte;
+#endif
+
+class TrackStorage
+{
+public:
+  // number of bytes; erased cells read as 0xFF
+  virtual unsigned long size() = 0;
+  virtual byte read(unsigned long address) = 0;
+  // writes only if the cell holds a different value
+  virtual void write(unsigned long address, byte value) = 0;
+
+protected:
+  ~TrackStorage() {}
+};
+
+#if defined(ARDUINO)
+
+class EEPROMTrackStorage : public TrackStorage
+{
+public:
+  unsigned long size();
+  byte read(unsigned long address);
+  void write(unsigned long address, byte value);
+};
+
+#else
+
+class FileTrackStorage : public TrackStorage
+{
+public:
+  // opens (or creates, erased) a file of the given size
+  FileTrackStorage(const char *path, unsigned long size);
+  ~FileTrackStorage();
+
+  // false if the file could not be opened or created
+  bool ok() { return _file != 0; }
+
+  unsigned long size() { return _size; }
+  byte read(unsigned long address);
+  void write(unsigned long address, byte value);
+
+private:
+  FILE *_file;
+  byte *_image;
+  unsigned long _size;
+
+  // not copyable
+  FileTrackStorage(const FileTrackStorage &);
+  FileTrackStorage &operator=(const FileTrackStorage &);
+};
+
+class SimulatedTrackStorage : public TrackStorage
+{
+public:
+  // an erased part of the given size
+  SimulatedTrackStorage(unsigned long size);
+  ~SimulatedTrackStorage();
+
+  unsigned long size() { return _size; }
+  byte read(unsigned long address);
+  void write(unsigned long address, byte value);
+
+  // lose power after this many more cell writes; the write after them
+  // leaves its cell half programmed and everything after is lost
+  void cut_power_after(unsigned long writes);
+  void restore_power() { _power_budget = ~0UL; _powered = true; }
+  bool powered() { return _powered; }
+
+  // reads, cell writes, and writes to the most worn cell since the last reset
+  unsigned long reads() { return _reads; }
+  unsigned long writes() { return _writes; }
+  unsigned long cell_writes(unsigned long address) { return _wear[address]; }
+  unsigned long max_cell_writes();
+  void reset_counters();
+
+private:
+  byte *_image;
+  unsigned long *_wear;
+  unsigned long _size;
+  unsigned long _reads, _writes;
+  unsigned long _power_budget;
+  unsigned long _noise;
+  bool _powered;
+
+  // not copyable
+  SimulatedTrackStorage(const SimulatedTrackStorage &);
+  SimulatedTrackStorage &operator=(const SimulatedTrackStorage &);
+};
+
+#endif
+
+#endif
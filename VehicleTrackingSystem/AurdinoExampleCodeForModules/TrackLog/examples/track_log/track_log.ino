@@ -0,0 +1,84 @@
+#include <SoftwareSerial.h>
+#include <EEPROM.h>
+
+#include <TinyGPS.h>
+#include <TrackLog.h>
+
+/* This sample code records the track of a vehicle in EEPROM, once a
+   second, and prints how much of the EEPROM each fix takes. Send 'd'
+   on the serial monitor to dump the track, 'c' to clear it.
+   It assumes that you have a 4800-baud serial GPS device hooked up on
+   pins 4(rx) and 3(tx).
+*/
+
+TinyGPS gps;
+SoftwareSerial ss(4, 3);
+EEPROMTrackStorage eeprom;
+TrackLog track(eeprom);
+
+void setup()
+{
+  Serial.begin(115200);
+  ss.begin(4800);
+
+  track.begin();
+  Serial.print("Track log: "); Serial.print(track.fixes());
+  Serial.print(" fixes in "); Serial.print(track.bytes_used());
+  Serial.print(" of "); Serial.print(eeprom.size()); Serial.println(" bytes");
+}
+
+void loop()
+{
+  bool newData = false;
+
+  for (unsigned long start = millis(); millis() - start < 1000;)
+  {
+    while (ss.available())
+      if (gps.encode(ss.read()))
+        newData = true;
+  }
+
+  if (newData)
+  {
+    TrackFix fix;
+    unsigned long date, time, age;
+    gps.get_position(&fix.latitude, &fix.longitude, &age);
+    gps.get_datetime(&date, &time);
+    fix.speed = gps.speed();
+    if (age != TinyGPS::GPS_INVALID_AGE && date != TinyGPS::GPS_INVALID_DATE)
+    {
+      fix.timestamp = TrackLog::timestamp(date, time);
+      if (track.append(fix))
+      {
+        Serial.print("FIXES="); Serial.print(track.fixes());
+        Serial.print(" BYTES/FIX="); Serial.println((float)track.bytes_used() / track.fixes(), 2);
+      }
+      else
+      {
+        Serial.println("EEPROM full");
+      }
+    }
+  }
+
+  switch (Serial.read())
+  {
+  case 'd':
+    {
+      TrackLog::Cursor cursor;
+      TrackFix fix;
+      if (track.seek(cursor))
+        while (track.next(cursor, &fix))
+        {
+          Serial.print(fix.timestamp); Serial.print(',');
+          Serial.print(fix.latitude); Serial.print(',');
+          Serial.print(fix.longitude); Serial.print(',');
+          Serial.println(fix.speed);
+        }
+    }
+    break;
+  case 'c':
+    track.truncate();
+    Serial.println("Track cleared");
+    break;
+  }
+}
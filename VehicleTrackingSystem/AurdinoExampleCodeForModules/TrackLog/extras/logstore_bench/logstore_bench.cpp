@@ -0,0 +1,211 @@
+/*
+logstore_bench - host benchmark and power-loss test for LogStore
+
+Measures write amplification and wear against writing fixes to fixed
+addresses, times the boot scan, and cuts power at random points of a
+run of appends and trims to check that nothing acknowledged is lost.
+
+Build from this directory with
+
+  g++ -O2 -I../.. logstore_bench.cpp ../../LogStore.cpp ../../TrackStorage.cpp -o logstore_bench
+
+and run as
+
+  ./logstore_bench [eeprom_bytes] [record_size] [power_cuts]
+
+This file is part of TrackLog and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TrackLog.h).
+*/
+
+#include "LogStore.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static unsigned long random_state = 12345;
+
+static unsigned long random_below(unsigned long n)
+{
+  random_state = random_state * 1103515245UL + 12345UL;
+  return (random_state >> 8) % n;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a raw fix as Step 3 stores it: latitude, longitude, speed, timestamp;
+// the first four bytes double as the record's id in the power-loss test
+static void make_fix(unsigned long id, byte *fix)
+{
+  unsigned long fields[4] = {id, 12971599 + id * 13, 77594566 + id * 7, 1500 + id % 300};
+  for (byte i = 0; i < 16; ++i)
+    fix[i] = (byte)(fields[i / 4] >> (8 * (i % 4)));
+}
+
+static unsigned long fix_id(const byte *fix)
+{
+  return fix[0] | (fix[1] << 8) | ((unsigned long)fix[2] << 16) | ((unsigned long)fix[3] << 24);
+}
+
+static void wear(unsigned long size, byte record_size)
+{
+  const unsigned long fixes = 200000;
+  byte fix[16];
+
+  // every fix written over the last one
+  SimulatedTrackStorage fixed(size);
+  for (unsigned long id = 0; id < fixes; ++id)
+  {
+    make_fix(id, fix);
+    for (byte i = 0; i < 16; ++i)
+      fixed.write(i, fix[i]);
+  }
+
+  // appended to the log, uploading and trimming half of it when full
+  SimulatedTrackStorage eeprom(size);
+  LogStore log(eeprom, record_size);
+  log.begin();
+  unsigned long trims = 0;
+  for (unsigned long id = 0; id < fixes; ++id)
+  {
+    make_fix(id, fix);
+    if (!log.append(fix, 16))
+    {
+      log.trim(log.count() / 2);
+      ++trims;
+      log.append(fix, 16);
+    }
+  }
+
+  printf("%lu byte EEPROM, %u byte records (%lu slots), %lu fixes of 16 bytes\n",
+    size, record_size, log.capacity() + 1, fixes);
+  printf("  fixed addresses: %.2f cell writes/byte, most worn cell %lu writes\n",
+    (double)fixed.writes() / (fixes * 16), fixed.max_cell_writes());
+  printf("  log:             %.2f cell writes/byte, most worn cell %lu writes, %lu trims\n",
+    (double)eeprom.writes() / (fixes * 16), eeprom.max_cell_writes(), trims);
+  printf("  fixes before a cell reaches 100,000 writes: %.0f vs %.0f\n",
+    100000.0 * fixes / fixed.max_cell_writes(), 100000.0 * fixes / eeprom.max_cell_writes());
+
+  // boot scan of the full log
+  const int boots = 200;
+  eeprom.reset_counters();
+  double start = seconds();
+  for (int i = 0; i < boots; ++i)
+    log.begin();
+  double scan = (seconds() - start) / boots;
+  printf("  boot scan: %lu records, %lu reads, %.1f us on this host\n",
+    log.count(), eeprom.reads() / boots, scan * 1e6);
+}
+
+// one run of appends and trims until the power goes; returns false if
+// what the log holds after the reboot is not what was acknowledged
+static bool power_cut(unsigned long size, byte record_size, unsigned long seed, unsigned long cut)
+{
+  SimulatedTrackStorage eeprom(size);
+  LogStore log(eeprom, record_size);
+  byte fix[128];
+  byte len;
+
+  log.begin();
+  random_state = seed;
+
+  // ids [tail, head) are acknowledged; the operation the power
+  // went out in may or may not have moved them to new_tail, new_head
+  unsigned long tail = 0, head = 0, new_tail, new_head;
+  bool cutting = false;
+
+  for (;;)
+  {
+    if (!cutting && eeprom.writes() >= cut)
+    {
+      eeprom.cut_power_after(random_below(4));
+      cutting = true;
+    }
+
+    new_tail = tail;
+    new_head = head;
+    if (random_below(5) || log.count() == 0)
+    {
+      make_fix(head, fix);
+      if (log.append(fix, 16))
+        new_head = head + 1;
+      else
+      {
+        // full: upload everything
+        log.trim(log.count());
+        new_tail = head;
+      }
+    }
+    else
+    {
+      unsigned long records = 1 + random_below(log.count());
+      log.trim(records);
+      new_tail = tail + records;
+    }
+
+    if (!eeprom.powered())
+      break;
+    tail = new_tail;
+    head = new_head;
+  }
+
+  eeprom.restore_power();
+  LogStore rebooted(eeprom, record_size);
+  rebooted.begin();
+
+  LogStore::Cursor cursor;
+  rebooted.seek(cursor);
+  unsigned long first = 0, end = 0, read = 0;
+  while (rebooted.next(cursor, fix, &len))
+  {
+    unsigned long id = fix_id(fix);
+    byte want[16];
+    make_fix(id, want);
+    if (read == 0)
+      first = end = id;
+    if (id != end || len != 16 || memcmp(fix, want, 16))
+      return false;
+    ++end;
+    ++read;
+  }
+
+  if (read != rebooted.count())
+    return false;
+  if (read == 0)
+    return (tail > head ? tail : head) <= (new_tail < new_head ? new_tail : new_head);
+  return first >= tail && first <= new_tail && end >= head && end <= new_head;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long size = argc > 1 ? strtoul(argv[1], 0, 0) : 1024;
+  byte record_size = argc > 2 ? (byte)atoi(argv[2]) : _LOG_DEFAULT_RECORD_SIZE;
+  unsigned long cuts = argc > 3 ? strtoul(argv[3], 0, 0) : 20000;
+
+  if (record_size < 16 + _LOG_RECORD_OVERHEAD)
+  {
+    printf("records must be at least %d bytes to hold a fix\n", 16 + _LOG_RECORD_OVERHEAD);
+    return 1;
+  }
+
+  wear(size, record_size);
+
+  unsigned long failures = 0;
+  for (unsigned long i = 0; i < cuts; ++i)
+  {
+    random_state = i;
+    unsigned long cut = random_below(size * 20);
+    if (!power_cut(size, record_size, i * 7919 + 1, cut))
+    {
+      if (failures < 10)
+        printf("  power cut %lu (after %lu writes) lost or corrupted records\n", i, cut);
+      ++failures;
+    }
+  }
+  printf("  %lu power cuts, %lu with lost or corrupted records\n", cuts, failures);
+  return failures != 0;
+}
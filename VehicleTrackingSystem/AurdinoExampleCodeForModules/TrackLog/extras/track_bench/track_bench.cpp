@@ -0,0 +1,145 @@
+/*
+track_bench - host benchmark for TrackLog
+
+Records a simulated 1 Hz drive into a file-backed "EEPROM", reads it
+back, and reports bytes per fix and the cost of encoding and decoding.
+
+Build from this directory with
+
+  g++ -O2 -I../.. track_bench.cpp ../../TrackLog.cpp ../../TrackStorage.cpp -o track_bench
+
+and run as
+
+  ./track_bench [eeprom_file] [eeprom_bytes] [keyframe_interval]
+
+This file is part of TrackLog and is distributed under the same terms,
+the GNU Lesser General Public License version 2.1 or later (see TrackLog.h).
+*/
+
+#include "TrackLog.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// byte array storage, to time the codec without file I/O
+class RAMTrackStorage : public TrackStorage
+{
+public:
+  RAMTrackStorage(unsigned long size) : _image((byte *)malloc(size)), _size(size)
+    { memset(_image, 0xFF, size); }
+  ~RAMTrackStorage() { free(_image); }
+  unsigned long size() { return _size; }
+  byte read(unsigned long address) { return _image[address]; }
+  void write(unsigned long address, byte value) { _image[address] = value; }
+
+private:
+  byte *_image;
+  unsigned long _size;
+};
+
+static unsigned long random_state = 12345;
+
+static long noise(long range)
+{
+  random_state = random_state * 1103515245UL + 12345UL;
+  return (long)((random_state >> 8) % (2 * range + 1)) - range;
+}
+
+// a vehicle driving through town: speeds up, slows down, turns
+// now and then, and with GPS jitter of a metre or so on every fix
+static void drive(TrackFix *fixes, unsigned long count)
+{
+  double lat = 12.971599, lon = 77.594566;
+  double speed = 0, course = 0.5;
+  double target = 13.9;
+  unsigned long t = TrackLog::timestamp(10917UL, 9300000UL);
+
+  for (unsigned long i = 0; i < count; ++i)
+  {
+    if (i % 120 == 0) target = 5 + (noise(1000) + 1000) / 100.0;
+    if (i % 45 == 0) course += noise(100) / 100.0 * 1.5;
+    speed += (target - speed) * 0.1;
+
+    lat += speed * cos(course) / 111320.0;
+    lon += speed * sin(course) / (111320.0 * cos(lat * 0.0174532925));
+    if (i % 300 == 299) ++t;  // a missed second now and then
+    ++t;
+
+    fixes[i].latitude = (long)((lat + noise(10) * 1e-6) * 1e6);
+    fixes[i].longitude = (long)((lon + noise(10) * 1e-6) * 1e6);
+    fixes[i].speed = (unsigned long)(speed * 194.384 + noise(15) + 0.5);  // m/s to 100ths of a knot
+    fixes[i].timestamp = t;
+  }
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = argc > 1 ? argv[1] : "track_bench.eeprom";
+  unsigned long size = argc > 2 ? strtoul(argv[2], 0, 0) : 4096;
+  byte interval = argc > 3 ? (byte)atoi(argv[3]) : _TRACK_DEFAULT_KEYFRAME_INTERVAL;
+
+  const unsigned long count = 100000;
+  TrackFix *fixes = (TrackFix *)malloc(count * sizeof(TrackFix));
+  drive(fixes, count);
+
+  // fill the EEPROM
+  remove(path);
+  FileTrackStorage eeprom(path, size);
+  if (!eeprom.ok())
+  {
+    printf("cannot open %s\n", path);
+    return 1;
+  }
+  TrackLog log(eeprom, interval);
+  log.begin();
+  unsigned long logged = 0;
+  while (logged < count && log.append(fixes[logged]))
+    ++logged;
+
+  // what a reboot sees
+  TrackLog reopened(eeprom, interval);
+  reopened.begin();
+  TrackLog::Cursor cursor;
+  TrackFix fix;
+  unsigned long mismatches = 0, read_back = 0;
+  if (reopened.seek(cursor))
+    for (; reopened.next(cursor, &fix); ++read_back)
+      if (memcmp(&fix, &fixes[read_back], sizeof(fix)))
+        ++mismatches;
+
+  printf("%lu byte EEPROM, keyframe every %u fixes\n", size, interval);
+  printf("  %lu fixes (%.1f minutes at 1 Hz) in %lu bytes: %.2f bytes/fix, raw fields take 16\n",
+    logged, logged / 60.0, log.bytes_used(), (double)log.bytes_used() / logged);
+  printf("  after reboot: %lu fixes, %lu keyframes, %lu read back, %lu mismatches\n",
+    reopened.fixes(), reopened.keyframes(), read_back, mismatches);
+
+  // codec cost, without the file in the way
+  RAMTrackStorage ram(count * _TRACK_MAX_FRAME);
+  TrackLog timed(ram, interval);
+  timed.begin();
+  double start = seconds();
+  for (unsigned long i = 0; i < count; ++i)
+    timed.append(fixes[i]);
+  double encode = seconds() - start;
+
+  start = seconds();
+  unsigned long decoded = 0;
+  timed.seek(cursor);
+  while (timed.next(cursor, &fix))
+    ++decoded;
+  double decode = seconds() - start;
+
+  printf("  codec on %lu fixes: %.2f bytes/fix, encode %.1f ns/fix, decode %.1f ns/fix\n",
+    decoded, (double)timed.bytes_used() / count, encode * 1e9 / count, decode * 1e9 / decoded);
+
+  free(fixes);
+  return mismatches != 0 || read_back != logged;
+}